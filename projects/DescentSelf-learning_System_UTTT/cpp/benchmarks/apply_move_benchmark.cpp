@@ -0,0 +1,304 @@
+// apply_move_benchmark.cpp
+//
+// Замер скорости applyMove в режиме раскрытия Descent (копия доски + ход для каждого
+// допустимого хода) и проверка, что инкрементальный ключ Zobrist совпадает с пересчитанным с нуля.
+//
+// Сравнивается (медиана нескольких раундов, порядок вариантов чередуется):
+//  - applyMove базовой версии: копия тела BigBoard::applyMove до Zobrist — пересчёт FNV-1a по 11 словам;
+//  - то же тело с инкрементальным Zobrist вместо FNV-1a — только смена хеша;
+//  - текущий BigBoard::applyMove (Zobrist всех 8 симметрий и канонический ключ) — для справки.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <type_traits>
+#include <vector>
+
+#include "big_board/BigBoard.h"
+#include "boards/precalculated/precalculated_small_boards.h"
+
+namespace {
+    constexpr int GAMES = 2000;
+    constexpr int REPEATS = 4;
+    constexpr int ROUNDS = 11;
+
+    /**
+     * Доска базовой версии (до Zobrist и симметрий): то же состояние и тот же applyMove,
+     * что были в BigBoard. ZOBRIST — вместо пересчёта FNV-1a инкрементальный ключ Zobrist.
+     */
+    template<bool ZOBRIST>
+    class BaselineBoard {
+    public:
+        alignas(64) uint64_t boardsArray[bigBoardArrays::size];
+        uint64_t &hashKey;
+        uint64_t &bigState1;
+        uint64_t &bigState2;
+
+    private:
+        alignas(64) uint8_t movesArray[bigBoardArrays::movesSize + 1];
+
+        inline void updateHashKey() {
+            uint64_t hash = 0xcbf29ce484222325;
+            constexpr uint64_t prime = 0x100000001b3;
+
+            for (int i = 0; i < bigBoardArrays::size - 1; ++i) {
+                hash ^= boardsArray[i];
+                hash *= prime;
+            }
+
+            hashKey = hash;
+        }
+
+        inline uint64_t activeBoardKey() const {
+            return activeBoardKey(BigBoardGet::validBoards(bigState2) & move::mask::boardIndex);
+        }
+
+        inline uint64_t activeBoardKey(uint64_t singleBoardIndex) const {
+            bool single = BigBoardGet::validBoardsCount(bigState2) == 1;
+            return zobrist::keys.activeBoard[single ? singleBoardIndex : zobrist::ANY_BOARD];
+        }
+
+        inline void mergeBoardStateToGlobal(uint64_t board, int boardIndex) {
+            constexpr int ongoingShift = bigState1::pos::ONGOING - stateCode::bitPos::ONGOING;
+            constexpr int oWinsShift = bigState1::pos::O_part - stateCode::bitPos::O_WINS;
+            constexpr int xWinsShift = bigState1::pos::X_part - stateCode::bitPos::X_WINS;
+            constexpr uint64_t globalFieldFirstCellMask = 0b1000000001000000001;
+            uint64_t boardStateVal = boardGet::state(board);
+            uint64_t combinedShifted = ((boardStateVal & stateCode::ONGOING) << ongoingShift) |
+                                       ((boardStateVal & stateCode::O_WINS) << oWinsShift) |
+                                       ((boardStateVal & stateCode::X_WINS) << xWinsShift);
+            bigState1 &= ~(globalFieldFirstCellMask << boardIndex);
+            bigState1 |= (combinedShifted << boardIndex);
+        }
+
+        inline void updateBigState() {
+            constexpr uint64_t ongoingLayerMask = bigState1::mask::ONGOING << bigState1::pos::ONGOING;
+
+            uint64_t newBigBoardState = boardGet::state(getBoardInfo(bigState1));
+            if (newBigBoardState == stateCode::ONGOING) {
+                uint64_t anyIsNotOngoing = !(bigState1 & ongoingLayerMask);
+                newBigBoardState <<= anyIsNotOngoing;
+            }
+            bigState2 = (bigState2 & ~bigState2::mask::STATE) | newBigBoardState;
+        }
+
+        inline void updateBoardInfo(int boardIndex) {
+            uint64_t &board = boardsArray[boardIndex];
+            uint64_t oldBoardState = boardGet::state(board);
+            board = getBoardInfo(board);
+            uint64_t updatedBoardState = boardGet::state(board);
+            if (updatedBoardState != oldBoardState) {
+                mergeBoardStateToGlobal(board, boardIndex);
+                updateBigState();
+            }
+        }
+
+        inline void settingValidBoards(uint64_t lastMoveCellIndex) {
+            uint64_t gameState = BigBoardGet::state(bigState2);
+
+            if (gameState != stateCode::ONGOING) {
+                BigBoardSet::validBoardsCount(bigState2, 0);
+                BigBoardSet::validBoards(bigState2, 0);
+                return;
+            }
+
+            uint64_t ongoing = BigBoardGet::layerOngoing(bigState1);
+            bool targetBoardOngoing = (ongoing & (rights::_1_BIT << lastMoveCellIndex)) != 0;
+
+            if (targetBoardOngoing) {
+                BigBoardSet::validBoardsCount(bigState2, 1);
+                BigBoardSet::validBoards(bigState2, lastMoveCellIndex);
+            } else {
+                int count = 0;
+                uint64_t validBoards = 0;
+
+                for (uint64_t i = 0; i < 9; ++i) {
+                    uint64_t bit = (ongoing >> i) & rights::_1_BIT;
+                    validBoards |= (i << (count << 2)) * bit;
+                    count += bit;
+                }
+
+                BigBoardSet::validBoardsCount(bigState2, count);
+                BigBoardSet::validBoards(bigState2, validBoards);
+            }
+        }
+
+    public:
+        /// Та же позиция, что у board; ключ — своей версии
+        explicit BaselineBoard(const BigBoard &board)
+            : hashKey(boardsArray[bigBoardArrays::hashKeyPos]),
+              bigState1(boardsArray[bigBoardArrays::bigState1Pos]),
+              bigState2(boardsArray[bigBoardArrays::bigState2Pos]) {
+            std::memcpy(boardsArray, board.boardsArray, sizeof(boardsArray));
+            if constexpr (ZOBRIST) {
+                hashKey = board.computeHashKey();
+            } else {
+                updateHashKey();
+            }
+        }
+
+        inline BaselineBoard(const BaselineBoard &other)
+            : hashKey(boardsArray[bigBoardArrays::hashKeyPos]),
+              bigState1(boardsArray[bigBoardArrays::bigState1Pos]),
+              bigState2(boardsArray[bigBoardArrays::bigState2Pos]) {
+            std::memcpy(this->boardsArray, other.boardsArray, sizeof(this->boardsArray));
+        }
+
+        BaselineBoard &operator=(const BaselineBoard &) = delete;
+
+        inline void applyMove(uint8_t move) {
+            int moveBoardIndex = (move >> move::pos::boardIndex) & move::mask::boardIndex;
+            int moveCellIndex = (move >> move::pos::cellIndex) & move::mask::cellIndex;
+
+            uint64_t player = BigBoardGet::player(bigState2);
+            uint64_t &targetBoard = boardsArray[moveBoardIndex];
+            uint64_t cellMask = rights::_1_BIT << (moveCellIndex + player * board::pos::O_part);
+            targetBoard |= cellMask;
+
+            if constexpr (ZOBRIST) {
+                uint64_t oldActiveBoardKey = activeBoardKey(moveBoardIndex);
+                updateBoardInfo(moveBoardIndex);
+                settingValidBoards(moveCellIndex);
+
+                BigBoardDo::invertPlayer(bigState2);
+                hashKey ^= zobrist::keys.cells[moveBoardIndex][moveCellIndex][player] ^ zobrist::keys.playerO ^
+                        oldActiveBoardKey ^ activeBoardKey();
+            } else {
+                updateBoardInfo(moveBoardIndex);
+                settingValidBoards(moveCellIndex);
+
+                BigBoardDo::invertPlayer(bigState2);
+                updateHashKey();
+            }
+        }
+    };
+
+    using LegacyBoard = BaselineBoard<false>;
+    using ZobristBoard = BaselineBoard<true>;
+
+    /// Прежний хеш BigBoard: FNV-1a по всем словам состояния, кроме hashKey
+    inline uint64_t legacyFnvHash(const uint64_t *boardsArray) {
+        uint64_t hash = 0xcbf29ce484222325;
+        constexpr uint64_t prime = 0x100000001b3;
+        for (int i = 0; i < bigBoardArrays::size - 1; ++i) {
+            hash ^= boardsArray[i];
+            hash *= prime;
+        }
+        return hash;
+    }
+
+    /// Позиция раскрытия: доска в каждом варианте и её допустимые ходы
+    struct Position {
+        BigBoard *board;
+        LegacyBoard legacy;
+        ZobristBoard zobrist;
+        std::vector<uint8_t> moves;
+    };
+
+    /// Случайные партии: все позиции, в которых раскрываются дети
+    std::vector<Position> collectPositions() {
+        std::vector<Position> positions;
+        srand(12345);
+        for (int g = 0; g < GAMES; ++g) {
+            BigBoard board;
+            while (!board.isGameOver()) {
+                uint8_t *moves = board.getValidMoves();
+                positions.push_back({board.clone(), LegacyBoard(board), ZobristBoard(board),
+                                     std::vector<uint8_t>(moves + 1, moves + 1 + moves[0])});
+                board.applyMove(moves[1 + rand() % moves[0]]);
+            }
+        }
+        return positions;
+    }
+
+    /// Доска варианта в позиции
+    template<typename Board>
+    inline const Board &boardOf(const Position &position) {
+        if constexpr (std::is_same_v<Board, LegacyBoard>) {
+            return position.legacy;
+        } else if constexpr (std::is_same_v<Board, ZobristBoard>) {
+            return position.zobrist;
+        } else {
+            return *position.board;
+        }
+    }
+
+    template<typename Board>
+    double expandAll(const std::vector<Position> &positions, uint64_t &checksum) {
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int r = 0; r < REPEATS; ++r) {
+            for (const Position &position: positions) {
+                const Board &parent = boardOf<Board>(position);
+                for (uint8_t move: position.moves) {
+                    Board child(parent);
+                    child.applyMove(move);
+                    checksum += child.hashKey;
+                }
+            }
+        }
+        return std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+    }
+
+    inline double median(std::vector<double> values) {
+        std::sort(values.begin(), values.end());
+        return values[values.size() / 2];
+    }
+}
+
+int main() {
+    std::vector<Position> positions = collectPositions();
+
+    // Проверка: инкрементальный ключ == ключ, посчитанный с нуля;
+    // базовые доски после хода в том же состоянии, что и BigBoard, с ключом своей версии
+    long mismatches = 0;
+    long expansions = 0;
+    for (const Position &position: positions) {
+        for (uint8_t move: position.moves) {
+            BigBoard child(*position.board);
+            child.applyMove(move);
+            LegacyBoard legacy(position.legacy);
+            legacy.applyMove(move);
+            ZobristBoard zobrist(position.zobrist);
+            zobrist.applyMove(move);
+
+            const size_t stateBytes = bigBoardArrays::hashKeyPos * sizeof(uint64_t);
+            mismatches += child.hashKey != child.computeHashKey();
+            mismatches += std::memcmp(legacy.boardsArray, child.boardsArray, stateBytes) != 0 ||
+                    legacy.hashKey != legacyFnvHash(child.boardsArray);
+            mismatches += std::memcmp(zobrist.boardsArray, child.boardsArray, stateBytes) != 0 ||
+                    zobrist.hashKey != child.hashKey;
+            expansions++;
+        }
+    }
+
+    uint64_t checksum = 0;
+    std::vector<double> legacySec, zobristSec, currentSec;
+    for (int round = 0; round < ROUNDS; ++round) {
+        if (round % 2 == 0) {
+            legacySec.push_back(expandAll<LegacyBoard>(positions, checksum));
+            zobristSec.push_back(expandAll<ZobristBoard>(positions, checksum));
+            currentSec.push_back(expandAll<BigBoard>(positions, checksum));
+        } else {
+            currentSec.push_back(expandAll<BigBoard>(positions, checksum));
+            zobristSec.push_back(expandAll<ZobristBoard>(positions, checksum));
+            legacySec.push_back(expandAll<LegacyBoard>(positions, checksum));
+        }
+    }
+    const double applied = static_cast<double>(expansions) * REPEATS;
+    const double legacy = median(legacySec), zobrist = median(zobristSec), current = median(currentSec);
+
+    std::cout << "positions: " << positions.size() << ", moves: " << expansions << ", mismatches: " << mismatches
+            << std::endl;
+    std::cout << "baseline applyMove (FNV-1a) : " << applied / legacy / 1e6 << " M/s" << std::endl;
+    std::cout << "baseline + Zobrist          : " << applied / zobrist / 1e6 << " M/s" << std::endl;
+    std::cout << "BigBoard (8 symmetry keys)  : " << applied / current / 1e6 << " M/s" << std::endl;
+    std::cout << "Zobrist vs FNV-1a: " << legacy / zobrist << "x, BigBoard vs baseline: " << legacy / current
+            << "x (median of " << ROUNDS << " rounds, checksum " << checksum << ")" << std::endl;
+
+    for (Position &position: positions) {
+        delete position.board;
+    }
+    return mismatches == 0 ? 0 : 1;
+}
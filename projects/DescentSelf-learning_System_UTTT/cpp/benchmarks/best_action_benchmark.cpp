@@ -0,0 +1,204 @@
+// best_action_benchmark.cpp
+//
+// Замер выбора лучшего ребёнка узла (Descent::bestChildOf) и хода по Ordinal distribution
+// (OrdinalActionSelector) на наборах v'(s,a) с числом ходов из случайных партий.
+//
+// Сравнивается: прежний скалярный цикл с ветвлением по игроку  vs  valueKernels::bestIndex,
+//               std::sort всех ходов  vs  розыгрыш ранга + valueKernels::nthBestIndex.
+// Результаты обоих вариантов сверяются (при равных значениях индексы могут отличаться).
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include "big_board/BigBoard.h"
+#include "boards/precalculated/precalculated_small_boards.h"
+#include "selfplay/utils/value_kernels.h"
+
+namespace {
+    constexpr int GAMES = 2000;
+    constexpr int REPEATS = 200;
+    constexpr float VIRTUAL_LOSS = 0.1f;
+    constexpr float ORDINAL_RATIO = 0.7f;
+
+    struct Node {
+        int n;
+        bool isFirstPlayer;
+        float values[valueKernels::MAX_VALUES];
+        int32_t inFlight[valueKernels::MAX_VALUES];
+    };
+
+    /// Число ходов — из позиций случайных партий; значения кратны 1/64, чтобы встречались равенства
+    std::vector<Node> collectNodes() {
+        std::vector<Node> nodes;
+        srand(12345);
+        for (int g = 0; g < GAMES; ++g) {
+            BigBoard board;
+            while (!board.isGameOver()) {
+                uint8_t *moves = board.getValidMoves();
+                Node node{};
+                node.n = moves[0];
+                node.isFirstPlayer = board.getCurrentPlayer() == cell::X;
+                for (int i = 0; i < node.n; ++i) {
+                    node.values[i] = static_cast<float>(rand() % 129 - 64) / 64.0f;
+                    node.inFlight[i] = rand() % 8 == 0 ? rand() % 4 : 0;
+                }
+                nodes.push_back(node);
+                board.applyMove(moves[1 + rand() % moves[0]]);
+            }
+        }
+        return nodes;
+    }
+
+    /// Прежний Descent::bestActionOf: один цикл на игрока, штраф проверяется в цикле
+    int legacyBestIndex(const Node &node, bool applyPenalty) {
+        if (node.isFirstPlayer) {
+            float bestVal = -1e9f;
+            int best = 0;
+            for (int i = 0; i < node.n; ++i) {
+                float val = node.values[i];
+                if (applyPenalty) {
+                    val -= VIRTUAL_LOSS * node.inFlight[i];
+                }
+                if (val > bestVal) {
+                    bestVal = val;
+                    best = i;
+                }
+            }
+            return best;
+        } else {
+            float bestVal = 1e9f;
+            int best = 0;
+            for (int i = 0; i < node.n; ++i) {
+                float val = node.values[i];
+                if (applyPenalty) {
+                    val += VIRTUAL_LOSS * node.inFlight[i];
+                }
+                if (val < bestVal) {
+                    bestVal = val;
+                    best = i;
+                }
+            }
+            return best;
+        }
+    }
+
+    int kernelBestIndex(const Node &node, bool applyPenalty) {
+        if (applyPenalty) {
+            return node.isFirstPlayer
+                       ? valueKernels::bestIndex<true>(node.values, node.inFlight, VIRTUAL_LOSS, node.n)
+                       : valueKernels::bestIndex<false>(node.values, node.inFlight, VIRTUAL_LOSS, node.n);
+        }
+        return node.isFirstPlayer
+                   ? valueKernels::bestIndex<true>(node.values, node.n)
+                   : valueKernels::bestIndex<false>(node.values, node.n);
+    }
+
+    struct MoveVal {
+        uint8_t move;
+        float val;
+    };
+
+    /// Прежний OrdinalActionSelector: полная сортировка, затем проход от лучшего
+    float legacyOrdinal(const Node &node) {
+        MoveVal mv[valueKernels::MAX_VALUES];
+        for (int i = 0; i < node.n; ++i) {
+            mv[i] = {static_cast<uint8_t>(i), node.values[i]};
+        }
+        if (node.isFirstPlayer) {
+            std::sort(mv, mv + node.n, [](const MoveVal &a, const MoveVal &b) { return a.val > b.val; });
+        } else {
+            std::sort(mv, mv + node.n, [](const MoveVal &a, const MoveVal &b) { return a.val < b.val; });
+        }
+        int n = node.n;
+        for (int j = 0; j < n; j++) {
+            float p = ORDINAL_RATIO * (float(n - j - 1) / float(n - j)) + (1.0f / float(n - j));
+            if (float(rand()) / float(RAND_MAX) < p) {
+                return mv[j].val;
+            }
+        }
+        return mv[n - 1].val;
+    }
+
+    float kernelOrdinal(const Node &node) {
+        int n = node.n;
+        int rank = n - 1;
+        for (int j = 0; j < n; j++) {
+            float p = ORDINAL_RATIO * (float(n - j - 1) / float(n - j)) + (1.0f / float(n - j));
+            if (float(rand()) / float(RAND_MAX) < p) {
+                rank = j;
+                break;
+            }
+        }
+        uint8_t order[valueKernels::MAX_VALUES];
+        int i = node.isFirstPlayer
+                    ? valueKernels::nthBestIndex<true>(node.values, n, rank, order)
+                    : valueKernels::nthBestIndex<false>(node.values, n, rank, order);
+        return node.values[i];
+    }
+
+    template<typename Fn>
+    double measure(const std::vector<Node> &nodes, Fn &&fn, double &checksum) {
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int r = 0; r < REPEATS; ++r) {
+            for (const Node &node: nodes) {
+                checksum += fn(node);
+            }
+        }
+        return std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+    }
+
+    const char *kernelName() {
+#if defined(__AVX2__)
+        return "AVX2";
+#elif defined(__SSE2__)
+        return "SSE2";
+#else
+        return "scalar";
+#endif
+    }
+}
+
+int main() {
+    std::vector<Node> nodes = collectNodes();
+    const double calls = static_cast<double>(nodes.size()) * REPEATS;
+
+    // Проверка: значения выбранных детей совпадают
+    long mismatches = 0;
+    for (const Node &node: nodes) {
+        for (bool applyPenalty: {false, true}) {
+            int legacy = legacyBestIndex(node, applyPenalty);
+            int kernel = kernelBestIndex(node, applyPenalty);
+            mismatches += legacy != kernel; // первый из равных — индексы совпадают
+        }
+        srand(777);
+        float legacyValue = legacyOrdinal(node);
+        srand(777);
+        mismatches += legacyValue != kernelOrdinal(node);
+    }
+
+    double checksum = 0;
+    std::cout << "nodes: " << nodes.size() << ", kernel: " << kernelName() << ", mismatches: " << mismatches << std::endl;
+    for (bool applyPenalty: {false, true}) {
+        double legacySec = measure(nodes, [applyPenalty](const Node &node) {
+            return legacyBestIndex(node, applyPenalty);
+        }, checksum);
+        double kernelSec = measure(nodes, [applyPenalty](const Node &node) {
+            return kernelBestIndex(node, applyPenalty);
+        }, checksum);
+        std::cout << (applyPenalty ? "best action + virtual loss" : "best action               ")
+                << ": scalar " << calls / legacySec / 1e6 << " M/s, kernel " << calls / kernelSec / 1e6
+                << " M/s, speedup " << legacySec / kernelSec << "x" << std::endl;
+    }
+
+    srand(777);
+    double sortSec = measure(nodes, legacyOrdinal, checksum);
+    srand(777);
+    double rankSec = measure(nodes, kernelOrdinal, checksum);
+    std::cout << "ordinal selection         : std::sort " << calls / sortSec / 1e6 << " M/s, rank + nth "
+            << calls / rankSec / 1e6 << " M/s, speedup " << sortSec / rankSec << "x (checksum " << checksum << ")"
+            << std::endl;
+    return mismatches == 0 ? 0 : 1;
+}
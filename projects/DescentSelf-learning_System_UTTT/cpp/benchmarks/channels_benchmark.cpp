@@ -0,0 +1,159 @@
+// channels_benchmark.cpp
+//
+// Проверка и замер stateToChannels::convert: векторная запись каналов (expandCellPatterns)
+// против прежнего тройного цикла (один сдвиг и маска на байт) на позициях случайных партий.
+// Вывод обоих вариантов должен совпадать побайтно.
+// Упакованная запись (convertTo<true>, NN_INPUT_PACKED) проверяется распаковкой битов в том же порядке.
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include "big_board/BigBoard.h"
+#include "state_to_nn_representation/state_to_channels.h"
+
+namespace {
+    constexpr size_t POSITIONS = 200000;
+    constexpr int ROUNDS = 5;
+    constexpr size_t MAIN_SIZE = stateToChannels::MAIN_VALUES;
+    constexpr size_t MACRO_SIZE = stateToChannels::MACRO_VALUES;
+    constexpr size_t PACKED_MAIN_SIZE = stateToChannels::PACKED_MAIN_BYTES;
+    constexpr size_t PACKED_MACRO_SIZE = stateToChannels::PACKED_MACRO_BYTES;
+
+    using StateWords = uint64_t[stateToChannels::STATE_WORDS];
+
+    /// xorshift64: дешевле rand(), чтобы замер определялся самой конвертацией
+    struct Rng {
+        uint64_t state;
+
+        inline uint32_t below(uint32_t n) {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            return static_cast<uint32_t>(((state >> 32) * n) >> 32);
+        }
+    };
+
+    /// Прежняя запись: тройной цикл по (h, w, c)
+    void referenceConvert(const uint64_t *boardsArray, uint8_t *addressMainChannels, uint8_t *addressMacroChannels) {
+        using namespace stateToChannels;
+        uint64_t bigState1 = boardsArray[bigBoardArrays::bigState1Pos];
+        uint64_t bigState2 = boardsArray[bigBoardArrays::bigState2Pos];
+        uint64_t mainChannelsStates[main_channelsSize][9];
+        uint64_t macroWinsX;
+        uint64_t macroWinsO;
+        if (BigBoardGet::player(bigState2) == cell::X) {
+            fillChannelsStatesForPlayerX(mainChannelsStates, boardsArray, bigState1, bigState2);
+            macroWinsX = BigBoardGet::layerWinsX(bigState1);
+            macroWinsO = BigBoardGet::layerWinsO(bigState1);
+        } else {
+            fillChannelsStatesForPlayerO(mainChannelsStates, boardsArray, bigState1, bigState2);
+            macroWinsX = BigBoardGet::layerWinsO(bigState1);
+            macroWinsO = BigBoardGet::layerWinsX(bigState1);
+        }
+        for (int h = 0; h < 9; h++) {
+            const int baseBoardIndex = (h / 3) * 3;
+            const int baseCellIndex = (h % 3) * 3;
+            for (int w = 0; w < 9; w++) {
+                const int boardIndex = baseBoardIndex + (w / 3);
+                const int cellIndex = baseCellIndex + (w % 3);
+                for (int c = 0; c < main_channelsSize; c++) {
+                    *(addressMainChannels++) = static_cast<uint8_t>((mainChannelsStates[c][boardIndex] >> cellIndex) & 1ULL);
+                }
+            }
+        }
+        for (int boardIndex = 0; boardIndex < 9; ++boardIndex) {
+            *(addressMacroChannels++) = (macroWinsX >> boardIndex) & 1ULL;
+            *(addressMacroChannels++) = (macroWinsO >> boardIndex) & 1ULL;
+        }
+    }
+
+    /// Значение номер k упакованной записи: бит k % 8 байта k / 8
+    inline uint8_t packedValue(const uint8_t *packed, size_t k) {
+        return (packed[k / 8] >> (k % 8)) & 1;
+    }
+
+    template<class Convert>
+    double measure(const std::vector<uint64_t> &states, std::vector<uint8_t> &main, std::vector<uint8_t> &macro,
+                   size_t mainSize, size_t macroSize, Convert convert) {
+        double best = 1e30;
+        for (int r = 0; r < ROUNDS; ++r) {
+            auto start = std::chrono::high_resolution_clock::now();
+            for (size_t i = 0; i < POSITIONS; ++i) {
+                convert(&states[i * stateToChannels::STATE_WORDS], &main[i * mainSize], &macro[i * macroSize]);
+            }
+            double sec = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+            best = sec < best ? sec : best;
+        }
+        return best;
+    }
+}
+
+int main() {
+    // Слова состояний всех позиций случайных партий (включая начальную и конечную)
+    std::vector<uint64_t> states;
+    states.reserve(POSITIONS * stateToChannels::STATE_WORDS);
+    Rng rng{0x9E3779B97F4A7C15ULL};
+    size_t collected = 0;
+    while (collected < POSITIONS) {
+        BigBoard board;
+        while (collected < POSITIONS) {
+            states.insert(states.end(), board.boardsArray, board.boardsArray + stateToChannels::STATE_WORDS);
+            collected++;
+            if (board.isGameOver()) {
+                break;
+            }
+            uint8_t *moves = board.getValidMoves();
+            board.applyMove(moves[1 + rng.below(moves[0])]);
+        }
+    }
+
+    std::vector<uint8_t> refMain(POSITIONS * MAIN_SIZE), refMacro(POSITIONS * MACRO_SIZE);
+    std::vector<uint8_t> newMain(POSITIONS * MAIN_SIZE), newMacro(POSITIONS * MACRO_SIZE);
+    std::vector<uint8_t> packedMain(POSITIONS * PACKED_MAIN_SIZE), packedMacro(POSITIONS * PACKED_MACRO_SIZE);
+    double refSec = measure(states, refMain, refMacro, MAIN_SIZE, MACRO_SIZE, referenceConvert);
+    double newSec = measure(states, newMain, newMacro, MAIN_SIZE, MACRO_SIZE,
+                            [](const uint64_t *s, uint8_t *main, uint8_t *macro) {
+                                stateToChannels::convertTo<false>(s, main, macro);
+                            });
+    double packedSec = measure(states, packedMain, packedMacro, PACKED_MAIN_SIZE, PACKED_MACRO_SIZE,
+                               [](const uint64_t *s, uint8_t *main, uint8_t *macro) {
+                                   stateToChannels::convertTo<true>(s, main, macro);
+                               });
+
+    size_t mismatches = 0;
+    for (size_t i = 0; i < POSITIONS; ++i) {
+        mismatches += std::memcmp(&refMain[i * MAIN_SIZE], &newMain[i * MAIN_SIZE], MAIN_SIZE) != 0 ||
+                std::memcmp(&refMacro[i * MACRO_SIZE], &newMacro[i * MACRO_SIZE], MACRO_SIZE) != 0;
+    }
+    size_t packedMismatches = 0;
+    for (size_t i = 0; i < POSITIONS; ++i) {
+        bool equal = true;
+        for (size_t k = 0; k < PACKED_MAIN_SIZE * 8; ++k) {
+            uint8_t expected = k < MAIN_SIZE ? refMain[i * MAIN_SIZE + k] : 0; // хвост до 64 байт — нули
+            equal &= packedValue(&packedMain[i * PACKED_MAIN_SIZE], k) == expected;
+        }
+        for (size_t k = 0; k < PACKED_MACRO_SIZE * 8; ++k) {
+            uint8_t expected = k < MACRO_SIZE ? refMacro[i * MACRO_SIZE + k] : 0;
+            equal &= packedValue(&packedMacro[i * PACKED_MACRO_SIZE], k) == expected;
+        }
+        packedMismatches += !equal;
+    }
+
+#if defined(__AVX2__)
+    const char *variant = "AVX2";
+#elif defined(__SSSE3__)
+    const char *variant = "SSSE3";
+#else
+    const char *variant = "scalar";
+#endif
+    std::cout << "positions: " << POSITIONS << ", mismatches: " << mismatches << ", packed mismatches: "
+            << packedMismatches << std::endl;
+    std::cout << "per-byte loop: " << POSITIONS / refSec / 1e6 << " M states/s, " << variant << " expandCellPatterns: "
+            << POSITIONS / newSec / 1e6 << " M states/s (best of " << ROUNDS << ")" << std::endl;
+    std::cout << "packed bits: " << POSITIONS / packedSec / 1e6 << " M states/s, bytes per state: "
+            << MAIN_SIZE + MACRO_SIZE << " -> " << PACKED_MAIN_SIZE + PACKED_MACRO_SIZE << std::endl;
+    return mismatches == 0 && packedMismatches == 0 ? 0 : 1;
+}
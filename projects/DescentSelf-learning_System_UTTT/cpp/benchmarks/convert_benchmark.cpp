@@ -0,0 +1,90 @@
+// convert_benchmark.cpp
+//
+// Замер этапа SampleTrainer::trainSample без Python: BigBoard::unpack + stateToChannels::convert
+// для params::SAMPLE_SIZE упакованных позиций в WorkerPool с 1, 2, 4, ... потоками
+// (до std::thread::hardware_concurrency()). Хеш каналов должен совпадать при любом числе потоков.
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "big_board/BigBoard.h"
+#include "parameters.h"
+#include "state_to_nn_representation/state_to_channels.h"
+#include "structures/WorkerPool.h"
+
+namespace {
+    constexpr int ROUNDS = 10;
+    constexpr size_t MAIN_SIZE = stateToChannels::MAIN_BYTES;
+    constexpr size_t MACRO_SIZE = stateToChannels::MACRO_BYTES;
+
+    /// xorshift64: дешевле rand(), чтобы замер определялся самой доской
+    struct Rng {
+        uint64_t state;
+
+        inline uint32_t below(uint32_t n) {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            return static_cast<uint32_t>(((state >> 32) * n) >> 32);
+        }
+    };
+
+    /// Позиции случайных партий — как содержимое ReplayBuffer
+    std::vector<PackedBoard> collectPositions(size_t count) {
+        Rng rng{0x9E3779B97F4A7C15ULL};
+        std::vector<PackedBoard> packed;
+        packed.reserve(count);
+        while (packed.size() < count) {
+            BigBoard board;
+            while (packed.size() < count && !board.isGameOver()) {
+                packed.push_back(board.pack());
+                uint8_t *moves = board.getValidMoves();
+                board.applyMove(moves[1 + rng.below(moves[0])]);
+            }
+        }
+        return packed;
+    }
+
+    uint64_t hashChannels(const std::vector<uint8_t> &main, const std::vector<uint8_t> &macro) {
+        uint64_t hash = 1469598103934665603ULL;
+        for (uint8_t v: main) {
+            hash = (hash ^ v) * 1099511628211ULL;
+        }
+        for (uint8_t v: macro) {
+            hash = (hash ^ v) * 1099511628211ULL;
+        }
+        return hash;
+    }
+}
+
+int main() {
+    const size_t sampleSize = params::SAMPLE_SIZE;
+    std::vector<PackedBoard> packed = collectPositions(sampleSize);
+    std::vector<uint8_t> mainChannels(sampleSize * MAIN_SIZE);
+    std::vector<uint8_t> macroChannels(sampleSize * MACRO_SIZE);
+
+    int maxThreads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    std::cout << "sample: " << sampleSize << ", hardware threads: " << maxThreads << std::endl;
+    for (int threads = 1; threads <= maxThreads; threads *= 2) {
+        WorkerPool pool(threads);
+        double best = 1e30;
+        for (int r = 0; r < ROUNDS; ++r) {
+            auto start = std::chrono::high_resolution_clock::now();
+            pool.parallelFor(sampleSize, params::CONVERT_MIN_CHUNK, [&](size_t begin, size_t end) {
+                BigBoard board;
+                for (size_t i = begin; i < end; ++i) {
+                    board.unpack(packed[i]);
+                    stateToChannels::convert(&board, &mainChannels[i * MAIN_SIZE], &macroChannels[i * MACRO_SIZE]);
+                }
+            });
+            double sec = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+            best = sec < best ? sec : best;
+        }
+        std::cout << "threads " << threads << ": " << best * 1e3 << " ms (best of " << ROUNDS << "), hash "
+                << hashChannels(mainChannels, macroChannels) << std::endl;
+    }
+    return 0;
+}
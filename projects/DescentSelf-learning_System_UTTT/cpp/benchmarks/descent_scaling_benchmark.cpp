@@ -0,0 +1,61 @@
+// descent_scaling_benchmark.cpp
+//
+// Замер многопоточного Descent от одного корня: итераций в секунду при 1, 2, 4, 8 и 16 потоках
+// (params::DESCENT_THREADS задаётся в конструкторе Descent). Сеть оценки — ValueNet без Python:
+// потоки считают её одновременно (SharedMemory::evaluateConcurrently), без кеша оценок,
+// чтобы каждое раскрытие доходило до сети. Без аргументов веса случайные, размеров config.py;
+// первый аргумент — файл весов native_export.py, второй — секунд на замер (по умолчанию 2).
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include "big_board/BigBoard.h"
+#include "random_weights.h"
+#include "selfplay/Descent.h"
+#include "shared_memory/SharedMemory.h"
+#include "structures/Map_T.h"
+#include "structures/Set_S.h"
+
+namespace {
+    constexpr int MAX_THREADS = 16;
+}
+
+int main(int argc, char **argv) {
+    std::string path = argc > 1 ? argv[1] : "descent_scaling_random.weights.bin";
+    const float seconds = argc > 2 ? std::strtof(argv[2], nullptr) : 2.0f;
+    if (argc <= 1) {
+        benchmarkWeights::RandomWeights random(0x9E3779B97F4A7C15ULL);
+        if (!random.weights.save(path)) {
+            std::cerr << "cannot write " << path << std::endl;
+            return 1;
+        }
+    }
+
+    SharedMemory sharedMemory(MAX_THREADS * BatchEvaluator::MAX_SIZE);
+    if (!sharedMemory.useNativeWeights(path)) {
+        return 1;
+    }
+    std::cout << "weights: " << path << ", " << seconds << " s per run, hardware threads: "
+            << std::thread::hardware_concurrency() << std::endl;
+
+    double single = 0;
+    for (int threads = 1; threads <= MAX_THREADS; threads *= 2) {
+        Set_S S;
+        Map_T V;
+        Descent descent(S, V, sharedMemory, 0, threads);
+        BigBoard board;
+        auto start = std::chrono::high_resolution_clock::now();
+        const long iterations = descent.descent(&board, seconds);
+        const double elapsed = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+        const double rate = static_cast<double>(iterations) / elapsed;
+        if (threads == 1) {
+            single = rate;
+        }
+        std::cout << threads << " threads: " << rate << " iterations/s, speedup " << rate / single
+                << ", S.size " << S.size << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,111 @@
+// move_generation_benchmark.cpp
+//
+// Замер генерации ходов BigBoard::getValidMoves на позициях случайных партий
+// и сверка списка ходов с прежним разбором nibble-списков FREE_CELLS.
+//
+// Сравнивается: прежний поклеточный разбор  vs  блоки freeCellsByMask (первый вызов на позиции),
+//               а также повторный вызов на неизменной позиции (готовая таблица, без генерации).
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include "big_board/BigBoard.h"
+#include "boards/precalculated/precalculated_small_boards.h"
+
+namespace {
+    constexpr int GAMES = 2000;
+    constexpr int REPEATS = 50;
+
+    /// Прежний BigBoard::fillMovesArray: активные доски и их свободные клетки по одному nibble
+    int legacyFillMoves(const BigBoard &position, uint8_t *movesArray) {
+        uint64_t validBoardsCount = BigBoardGet::validBoardsCount(position.bigState2);
+        uint64_t validBoardsEncoded = BigBoardGet::validBoards(position.bigState2);
+
+        uint8_t *bytePos = movesArray + 1;
+        for (int i = 0; i < validBoardsCount; ++i) {
+            int boardIndex = (validBoardsEncoded >> (i << 2)) & move::mask::boardIndex;
+
+            uint64_t board = position.boardsArray[boardIndex];
+            int freeCount = boardGet::freeCount(board);
+            uint64_t freeCells = boardGet::freeCells(board);
+
+            for (int j = 0; j < freeCount; ++j) {
+                int cellIndex = (freeCells >> (j << 2)) & move::mask::cellIndex;
+                *(bytePos++) = (boardIndex << move::pos::boardIndex) | (cellIndex << move::pos::cellIndex);
+            }
+        }
+        int movesCount = (bytePos - (movesArray + 1));
+        movesArray[0] = movesCount;
+        return movesCount;
+    }
+
+    std::vector<BigBoard *> collectPositions() {
+        std::vector<BigBoard *> positions;
+        srand(12345);
+        for (int g = 0; g < GAMES; ++g) {
+            BigBoard board;
+            while (!board.isGameOver()) {
+                positions.push_back(board.clone());
+                uint8_t *moves = board.getValidMoves();
+                board.applyMove(moves[1 + rand() % moves[0]]);
+            }
+        }
+        return positions;
+    }
+
+    template<typename Fn>
+    double measure(const std::vector<BigBoard *> &positions, Fn &&fn, uint64_t &checksum) {
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int r = 0; r < REPEATS; ++r) {
+            for (BigBoard *position: positions) {
+                checksum += fn(*position);
+            }
+        }
+        return std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+    }
+}
+
+int main() {
+    std::vector<BigBoard *> positions = collectPositions();
+    const double calls = static_cast<double>(positions.size()) * REPEATS;
+
+    // Проверка: тот же список ходов в том же порядке
+    long mismatches = 0;
+    for (BigBoard *position: positions) {
+        uint8_t legacy[bigBoardArrays::movesBufferSize];
+        int count = legacyFillMoves(*position, legacy);
+        BigBoard copy(*position);
+        mismatches += std::memcmp(legacy, copy.getValidMoves(), count + 1) != 0;
+    }
+
+    uint64_t checksum = 0;
+    uint8_t buffer[bigBoardArrays::movesBufferSize];
+    // В обоих вариантах позиция сначала копируется: копия сбрасывает готовую таблицу ходов
+    double legacySec = measure(positions, [&buffer](const BigBoard &position) {
+        BigBoard copy(position);
+        legacyFillMoves(copy, buffer);
+        return buffer[buffer[0]];
+    }, checksum);
+    double tableSec = measure(positions, [](const BigBoard &position) {
+        BigBoard copy(position);
+        uint8_t *moves = copy.getValidMoves();
+        return moves[moves[0]];
+    }, checksum);
+    double cachedSec = measure(positions, [](const BigBoard &position) {
+        uint8_t *moves = const_cast<BigBoard &>(position).getValidMoves();
+        return moves[moves[0]];
+    }, checksum);
+
+    std::cout << "positions: " << positions.size() << ", mismatches: " << mismatches << std::endl;
+    std::cout << "copy + nibble decode   : " << calls / legacySec / 1e6 << " M/s" << std::endl;
+    std::cout << "copy + freeCellsByMask : " << calls / tableSec / 1e6 << " M/s, speedup " << legacySec / tableSec << "x" << std::endl;
+    std::cout << "repeated call          : " << calls / cachedSec / 1e6 << " M/s (checksum " << checksum << ")" << std::endl;
+
+    for (BigBoard *position: positions) {
+        delete position;
+    }
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,115 @@
+// packed_board_benchmark.cpp
+//
+// Замер BigBoard::pack / BigBoard::unpack на позициях из случайных партий и проверка,
+// что распакованная доска совпадает с исходной (слова досок, ключи всех симметрий, canonicalKey).
+// Печатает и объём ReplayBuffer на params::REPLAY_BUFFER_MAX_SIZE состояний: BigBoard* + доска
+// в куче против PackedBoard внутри StateValuePair.
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include "big_board/BigBoard.h"
+#include "parameters.h"
+
+namespace {
+    constexpr int POSITIONS = 300000;
+    constexpr int ROUNDS = 5;
+
+    /// xorshift64: дешевле rand(), чтобы замер определялся самой доской
+    struct Rng {
+        uint64_t state;
+
+        inline uint32_t below(uint32_t n) {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            return static_cast<uint32_t>(((state >> 32) * n) >> 32);
+        }
+    };
+
+    /// Все позиции случайных партий (включая начальную и конечную), пока не наберётся count
+    std::vector<PackedBoard> collectPositions(int count, std::vector<BigBoard *> &originals) {
+        Rng rng{0x9E3779B97F4A7C15ULL};
+        std::vector<PackedBoard> packed;
+        packed.reserve(count);
+        while (static_cast<int>(packed.size()) < count) {
+            BigBoard board;
+            while (static_cast<int>(packed.size()) < count) {
+                packed.push_back(board.pack());
+                originals.push_back(board.clone());
+                if (board.isGameOver()) {
+                    break;
+                }
+                uint8_t *moves = board.getValidMoves();
+                board.applyMove(moves[1 + rng.below(moves[0])]);
+            }
+        }
+        return packed;
+    }
+
+    bool sameBoard(const BigBoard &a, const BigBoard &b) {
+        return std::memcmp(a.boardsArray, b.boardsArray, sizeof(a.boardsArray)) == 0 &&
+               std::memcmp(a.symmetryKeys, b.symmetryKeys, sizeof(a.symmetryKeys)) == 0 &&
+               a.canonicalKey == b.canonicalKey && a.canonicalSymmetryMask == b.canonicalSymmetryMask;
+    }
+}
+
+int main() {
+    std::vector<BigBoard *> originals;
+    std::vector<PackedBoard> packed = collectPositions(POSITIONS, originals);
+
+    int mismatches = 0;
+    BigBoard board;
+    for (int i = 0; i < POSITIONS; ++i) {
+        board.unpack(packed[i]);
+        mismatches += !sameBoard(board, *originals[i]);
+    }
+
+    double bestPack = 1e30;
+    double bestUnpack = 1e30;
+    uint64_t checksum = 0;
+    for (int r = 0; r < ROUNDS; ++r) {
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < POSITIONS; ++i) {
+            packed[i] = originals[i]->pack();
+        }
+        auto middle = std::chrono::high_resolution_clock::now();
+        checksum = 0;
+        for (int i = 0; i < POSITIONS; ++i) {
+            board.unpack(packed[i]);
+            checksum += board.canonicalKey;
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        double packSec = std::chrono::duration<double>(middle - start).count();
+        double unpackSec = std::chrono::duration<double>(end - middle).count();
+        bestPack = packSec < bestPack ? packSec : bestPack;
+        bestUnpack = unpackSec < bestUnpack ? unpackSec : bestUnpack;
+    }
+
+    struct PointerPair {
+        BigBoard *board;
+        float value;
+    };
+    struct PackedPair {
+        PackedBoard board;
+        float value;
+    };
+    constexpr double MB = 1024.0 * 1024.0;
+    const size_t bufferSize = params::REPLAY_BUFFER_MAX_SIZE;
+    std::cout << "sizeof(BigBoard): " << sizeof(BigBoard) << " B, sizeof(PackedBoard): " << sizeof(PackedBoard)
+            << " B" << std::endl;
+    std::cout << "ReplayBuffer (" << bufferSize << " states): BigBoard* " << bufferSize * (sizeof(PointerPair) + sizeof(BigBoard)) / MB
+            << " MB (without malloc overhead), PackedBoard " << bufferSize * sizeof(PackedPair) / MB << " MB" << std::endl;
+    std::cout << "positions: " << POSITIONS << ", round-trip mismatches: " << mismatches << ", checksum " << checksum
+            << std::endl;
+    std::cout << "pack: " << bestPack / POSITIONS * 1e9 << " ns, unpack: " << bestUnpack / POSITIONS * 1e9
+            << " ns per position (best of " << ROUNDS << ")" << std::endl;
+
+    for (BigBoard *original: originals) {
+        delete original;
+    }
+    return mismatches == 0 ? 0 : 1;
+}
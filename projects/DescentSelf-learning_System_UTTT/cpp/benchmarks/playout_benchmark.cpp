@@ -0,0 +1,77 @@
+// playout_benchmark.cpp
+//
+// Замер случайных партий (getValidMoves + applyMove до конца игры) при текущей раскладке
+// boardsInfoArray. Собирается в двух целях: PlayoutBenchmark (2^18 слов по сырому коду X|O)
+// и PlayoutBenchmarkCompact (SMALL_BOARDS_COMPACT, 3^9 слов по троичному индексу).
+//
+// Партии детерминированы (фиксированный seed), поэтому обе сборки должны напечатать
+// одинаковые счётчики и checksum.
+
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+
+#include "big_board/BigBoard.h"
+#include "boards/precalculated/precalculated_small_boards.h"
+
+namespace {
+    constexpr int GAMES = 200000;
+    constexpr int ROUNDS = 5;
+
+    /// xorshift64: дешевле rand(), чтобы замер определялся самой доской
+    struct Rng {
+        uint64_t state;
+
+        inline uint32_t below(uint32_t n) {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            return static_cast<uint32_t>(((state >> 32) * n) >> 32);
+        }
+    };
+
+    struct PlayoutStats {
+        long moves = 0;
+        long results[4] = {}; ///< X_WINS, O_WINS, ONGOING (не бывает), DRAW по stateCode::bitPos
+        uint64_t checksum = 0;
+    };
+
+    double playout(PlayoutStats &stats) {
+        Rng rng{0x9E3779B97F4A7C15ULL};
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int g = 0; g < GAMES; ++g) {
+            BigBoard board;
+            while (!board.isGameOver()) {
+                uint8_t *moves = board.getValidMoves();
+                board.applyMove(moves[1 + rng.below(moves[0])]);
+                stats.moves++;
+            }
+            stats.results[std::countr_zero(static_cast<unsigned>(board.getGameState()))]++;
+            stats.checksum += board.hashKey;
+        }
+        return std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+    }
+}
+
+int main() {
+    PlayoutStats stats;
+    double bestSec = 1e30;
+    for (int r = 0; r < ROUNDS; ++r) {
+        stats = PlayoutStats{};
+        double sec = playout(stats);
+        bestSec = sec < bestSec ? sec : bestSec;
+    }
+
+#ifdef SMALL_BOARDS_COMPACT
+    const char *layout = "compact (3^9, ternary index)";
+#else
+    const char *layout = "full (2^18, raw X|O code)";
+#endif
+    std::cout << "boardsInfoArray: " << layout << ", " << TOTAL_BOARDS * sizeof(uint64_t) / 1024 << " KB" << std::endl;
+    std::cout << "games: " << GAMES << ", moves: " << stats.moves << ", X/O/draw: " << stats.results[0] << "/"
+            << stats.results[1] << "/" << stats.results[3] << ", checksum " << stats.checksum << std::endl;
+    std::cout << "playouts: " << GAMES / bestSec / 1e3 << " K games/s, " << stats.moves / bestSec / 1e6
+            << " M moves/s (best of " << ROUNDS << ")" << std::endl;
+    return 0;
+}
@@ -0,0 +1,145 @@
+// random_weights.h
+//
+// Случайные веса сети оценки для замеров без чекпоинта: размеры из python/descent/config.py,
+// имена тензоров — как у native_export.py (NetWeights::save -> ValueNet::load).
+
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "nn_inference/ValueNet.h"
+
+namespace benchmarkWeights {
+    // Размеры из python/descent/config.py
+    constexpr uint32_t LOCAL_FILTERS = 128;
+    constexpr int LOCAL_BLOCK_COUNT = 5;
+    constexpr uint32_t MACRO_FILTERS = 32;
+    constexpr int MACRO_RES_BLOCK_COUNT = 1;
+    constexpr uint32_t SE_REDUCTION = 16;
+    constexpr uint32_t ATTN_EMBED = 384;
+    constexpr uint32_t ATTN_HEADS = 3;
+    constexpr int ATTN_NUM_BLOCKS = 2;
+    constexpr uint32_t ATTN_MLP_RATIO = 2;
+    constexpr uint32_t DENSE_1_UNITS = 512;
+    constexpr uint32_t DENSE_2_UNITS = 256;
+
+    /// xorshift64: дешевле rand(), чтобы замер определялся самой сетью
+    struct Rng {
+        uint64_t state;
+
+        inline uint64_t next() {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            return state;
+        }
+
+        inline uint32_t below(uint32_t n) {
+            return static_cast<uint32_t>(((next() >> 32) * n) >> 32);
+        }
+
+        /// Равномерно в [-1, 1)
+        inline float uniform() {
+            return static_cast<float>(next() >> 40) / static_cast<float>(1 << 23) - 1.0f;
+        }
+    };
+
+    class RandomWeights {
+    public:
+        NetWeights weights;
+
+        /// kernel [..., fanIn-часть, out] с разбросом ~ he_normal и bias
+        void linear(const std::string &layer, std::vector<uint32_t> kernelShape, bool withBias = true) {
+            size_t size = 1;
+            for (uint32_t extent: kernelShape) {
+                size *= extent;
+            }
+            const uint32_t outputs = kernelShape.back();
+            const float range = std::sqrt(6.0f * outputs / static_cast<float>(size));
+            tensor(layer + "/kernel", kernelShape, range, 0.0f);
+            if (withBias) {
+                tensor(layer + "/bias", {outputs}, 0.1f, 0.0f);
+            }
+        }
+
+        void batchNorm(const std::string &layer, uint32_t channels) {
+            tensor(layer + "/gamma", {channels}, 0.2f, 1.0f);
+            tensor(layer + "/beta", {channels}, 0.1f, 0.0f);
+            tensor(layer + "/moving_mean", {channels}, 0.1f, 0.0f);
+            tensor(layer + "/moving_variance", {channels}, 0.4f, 1.0f);
+            tensor(layer + "/epsilon", {1}, 0.0f, 1e-3f);
+        }
+
+        void layerNorm(const std::string &layer, uint32_t features) {
+            tensor(layer + "/gamma", {features}, 0.2f, 1.0f);
+            tensor(layer + "/beta", {features}, 0.1f, 0.0f);
+            tensor(layer + "/epsilon", {1}, 0.0f, 1e-3f);
+        }
+
+        void resBlock(const std::string &prefix, int index, uint32_t filters) {
+            const std::string name = prefix + std::to_string(index);
+            linear(name + "_conv1", {3, 3, filters, filters});
+            batchNorm(name + "_bn1", filters);
+            linear(name + "_conv2", {3, 3, filters, filters});
+            batchNorm(name + "_bn2", filters);
+            linear(name + "_se_se_fc1", {filters, filters / SE_REDUCTION});
+            linear(name + "_se_se_fc2", {filters / SE_REDUCTION, filters});
+        }
+
+        void attnBlock(int index) {
+            const std::string name = "AttnBlock" + std::to_string(index);
+            const uint32_t keyDim = ATTN_EMBED / ATTN_HEADS;
+            for (const char *part: {"query", "key", "value"}) {
+                linear(name + "_MHA/" + part, {ATTN_EMBED, ATTN_HEADS, keyDim}, false);
+                tensor(name + "_MHA/" + part + "/bias", {ATTN_HEADS, keyDim}, 0.1f, 0.0f);
+            }
+            linear(name + "_MHA/attention_output", {ATTN_HEADS, keyDim, ATTN_EMBED});
+            layerNorm(name + "_LN1", ATTN_EMBED);
+            linear(name + "_MLP_dense1", {ATTN_EMBED, ATTN_EMBED * ATTN_MLP_RATIO});
+            linear(name + "_MLP_dense2", {ATTN_EMBED * ATTN_MLP_RATIO, ATTN_EMBED});
+            layerNorm(name + "_LN2", ATTN_EMBED);
+        }
+
+        explicit RandomWeights(uint64_t seed) : rng{seed} {
+            linear("loc_init_conv", {3, 3, 6, LOCAL_FILTERS});
+            batchNorm("loc_init_bn", LOCAL_FILTERS);
+            for (int i = 0; i < LOCAL_BLOCK_COUNT; ++i) {
+                resBlock("loc_res", i, LOCAL_FILTERS);
+            }
+            linear("loc_tokens_project", {9 * LOCAL_FILTERS, ATTN_EMBED});
+            for (int i = 0; i < ATTN_NUM_BLOCKS; ++i) {
+                attnBlock(i);
+            }
+            linear("mac_init_conv", {3, 3, 2, MACRO_FILTERS});
+            batchNorm("mac_init_bn", MACRO_FILTERS);
+            for (int i = 0; i < MACRO_RES_BLOCK_COUNT; ++i) {
+                resBlock("mac_res", i, MACRO_FILTERS);
+            }
+            linear("dense_1", {ATTN_EMBED + 9 * MACRO_FILTERS, DENSE_1_UNITS});
+            batchNorm("dense_1_bn", DENSE_1_UNITS);
+            linear("dense_2", {DENSE_1_UNITS, DENSE_2_UNITS});
+            batchNorm("dense_2_bn", DENSE_2_UNITS);
+            linear("output", {DENSE_2_UNITS, 1});
+        }
+
+    private:
+        Rng rng;
+
+        void tensor(const std::string &name, std::vector<uint32_t> shape, float range, float center) {
+            NetTensor tensor;
+            size_t size = 1;
+            for (uint32_t extent: shape) {
+                size *= extent;
+            }
+            tensor.shape = std::move(shape);
+            tensor.data.resize(size);
+            for (float &value: tensor.data) {
+                value = center + range * rng.uniform();
+            }
+            weights.add(name, std::move(tensor));
+        }
+    };
+}
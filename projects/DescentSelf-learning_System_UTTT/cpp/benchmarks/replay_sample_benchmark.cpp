@@ -0,0 +1,79 @@
+// replay_sample_benchmark.cpp
+//
+// Замер ReplayBuffer::getSample (частичный Фишер–Йейтс, O(SAMPLE_SIZE)) на заполненном буфере
+// против прежней выборки: заполнить indices всех ячеек, std::shuffle целиком, взять первые SAMPLE_SIZE.
+// Проверяет, что в выборке нет повторов, и печатает среднее номеров ячеек (≈ (N - 1) / 2).
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "structures/ReplayBuffer.h"
+
+namespace {
+    constexpr int ROUNDS = 20;
+
+    /// Прежняя выборка — для сравнения
+    double fullShuffleSample(const StateValuePair *bufferArray, size_t bufferSize, StateValuePair *sampleArray,
+                             size_t *indices, std::mt19937 &generator) {
+        auto start = std::chrono::high_resolution_clock::now();
+        for (size_t i = 0; i < bufferSize; ++i) {
+            indices[i] = i;
+        }
+        std::shuffle(indices, indices + bufferSize, generator);
+        for (size_t i = 0; i < params::SAMPLE_SIZE; ++i) {
+            sampleArray[i] = bufferArray[indices[i]];
+        }
+        return std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+    }
+}
+
+int main() {
+    ReplayBuffer replayBuffer;
+    const size_t bufferSize = params::REPLAY_BUFFER_MAX_SIZE;
+    // значение = номер ячейки, чтобы по выборке проверить повторы и равномерность
+    for (size_t i = 0; i < bufferSize; ++i) {
+        replayBuffer.add(PackedBoard{}, static_cast<float>(i));
+    }
+
+    double bestSample = 1e30;
+    int duplicates = 0;
+    double meanIndex = 0;
+    std::vector<uint8_t> seen(bufferSize);
+    for (int r = 0; r < ROUNDS; ++r) {
+        size_t sampleSize;
+        auto start = std::chrono::high_resolution_clock::now();
+        StateValuePair *sample = replayBuffer.getSample(sampleSize);
+        double sec = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+        bestSample = sec < bestSample ? sec : bestSample;
+
+        std::fill(seen.begin(), seen.end(), 0);
+        double sum = 0;
+        for (size_t i = 0; i < sampleSize; ++i) {
+            size_t index = static_cast<size_t>(sample[i].value);
+            duplicates += seen[index];
+            seen[index] = 1;
+            sum += sample[i].value;
+        }
+        meanIndex += sum / sampleSize / ROUNDS;
+    }
+
+    std::vector<StateValuePair> bufferArray(bufferSize);
+    std::vector<StateValuePair> sampleArray(params::SAMPLE_SIZE);
+    std::vector<size_t> indices(bufferSize);
+    std::mt19937 generator(params::SEED);
+    double bestShuffle = 1e30;
+    for (int r = 0; r < ROUNDS; ++r) {
+        double sec = fullShuffleSample(bufferArray.data(), bufferSize, sampleArray.data(), indices.data(), generator);
+        bestShuffle = sec < bestShuffle ? sec : bestShuffle;
+    }
+
+    std::cout << "buffer: " << bufferSize << ", sample: " << params::SAMPLE_SIZE << ", duplicates: " << duplicates
+            << ", mean index: " << meanIndex << " (expected " << (bufferSize - 1) / 2.0 << ")" << std::endl;
+    std::cout << "full shuffle: " << bestShuffle * 1e3 << " ms, partial Fisher-Yates: " << bestSample * 1e3
+            << " ms (best of " << ROUNDS << ")" << std::endl;
+    return duplicates == 0 ? 0 : 1;
+}
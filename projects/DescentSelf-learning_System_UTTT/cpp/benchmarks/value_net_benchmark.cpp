@@ -0,0 +1,115 @@
+// value_net_benchmark.cpp
+//
+// Замер ValueNet (прямой проход сети оценки на C++) на позициях случайных партий при разных размерах батча.
+// Без аргументов веса случайные, с размерами config.py и именами native_export.py (сохраняются в файл
+// и загружаются обратно); с аргументом — файл весов, выгруженный native_export.py из чекпоинта.
+// Затем int8: калибровка на первой половине позиций, расхождение с FP32 — на второй, и тот же замер.
+// В начале — холодный старт: разбор файла весов (load) против отображения blob-файла (mapBlob).
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "big_board/BigBoard.h"
+#include "nn_inference/ValueNet.h"
+#include "random_weights.h"
+#include "state_to_nn_representation/state_to_channels.h"
+
+namespace {
+    constexpr int POSITIONS = 256;
+    constexpr int ROUNDS = 3;
+
+    using benchmarkWeights::RandomWeights;
+    using benchmarkWeights::Rng;
+}
+
+int main(int argc, char **argv) {
+    std::string path = argc > 1 ? argv[1] : "value_net_random.weights.bin";
+    if (argc <= 1) {
+        RandomWeights random(0x9E3779B97F4A7C15ULL);
+        if (!random.weights.save(path)) {
+            std::cerr << "cannot write " << path << std::endl;
+            return 1;
+        }
+    }
+    ValueNet net;
+    auto start = std::chrono::high_resolution_clock::now();
+    if (!net.load(path)) {
+        return 1;
+    }
+    const double loadMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+    const std::string blobPath = path + ".vnet";
+    if (!net.saveBlob(blobPath)) {
+        std::cerr << "cannot write " << blobPath << std::endl;
+        return 1;
+    }
+    ValueNet mapped;
+    start = std::chrono::high_resolution_clock::now();
+    if (!mapped.mapBlob(blobPath)) {
+        return 1;
+    }
+    const double mapMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+    std::cout << "cold start: load " << loadMs << " ms, mapBlob " << mapMs << " ms" << std::endl;
+
+    // Каналы позиций случайных партий — как в буферах SharedMemory
+    std::vector<uint8_t> mainChannels(POSITIONS * stateToChannels::MAIN_BYTES);
+    std::vector<uint8_t> macroChannels(POSITIONS * stateToChannels::MACRO_BYTES);
+    Rng rng{12345};
+    int collected = 0;
+    while (collected < POSITIONS) {
+        BigBoard board;
+        while (collected < POSITIONS && !board.isGameOver()) {
+            stateToChannels::convert(&board, &mainChannels[collected * stateToChannels::MAIN_BYTES],
+                                     &macroChannels[collected * stateToChannels::MACRO_BYTES]);
+            collected++;
+            uint8_t *moves = board.getValidMoves();
+            board.applyMove(moves[1 + rng.below(moves[0])]);
+        }
+    }
+
+    std::vector<float> values(POSITIONS);
+    std::vector<float> mappedValues(POSITIONS);
+    net.evaluate(mainChannels.data(), macroChannels.data(), POSITIONS, values.data());
+    mapped.evaluate(mainChannels.data(), macroChannels.data(), POSITIONS, mappedValues.data());
+    if (values != mappedValues) {
+        std::cerr << "mapBlob: values differ from load" << std::endl;
+        return 1;
+    }
+    std::cout << "weights: " << path << ", positions: " << POSITIONS << std::endl;
+    auto measure = [&](const char *precision) {
+        for (int batch: {1, 16, 81, 256}) {
+            double best = 1e30;
+            for (int r = 0; r < ROUNDS; ++r) {
+                auto start = std::chrono::high_resolution_clock::now();
+                for (int first = 0; first < POSITIONS; first += batch) {
+                    const int count = std::min(batch, POSITIONS - first);
+                    net.evaluate(&mainChannels[first * stateToChannels::MAIN_BYTES],
+                                 &macroChannels[first * stateToChannels::MACRO_BYTES], count, &values[first]);
+                }
+                double sec = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+                best = sec < best ? sec : best;
+            }
+            double sum = 0;
+            for (float value: values) {
+                sum += value;
+            }
+            std::cout << precision << " batch " << batch << ": " << POSITIONS / best << " states/s, mean value "
+                    << sum / POSITIONS << " (best of " << ROUNDS << ")" << std::endl;
+        }
+    };
+    measure("fp32");
+
+    constexpr int CALIBRATION = POSITIONS / 2;
+    net.calibrate(mainChannels.data(), macroChannels.data(), CALIBRATION);
+    ValueNet::QuantError error = net.compareWithFloat(&mainChannels[CALIBRATION * stateToChannels::MAIN_BYTES],
+                                                      &macroChannels[CALIBRATION * stateToChannels::MACRO_BYTES],
+                                                      POSITIONS - CALIBRATION);
+    std::cout << "int8: activations 0.." << nnQuant::ACTIVATION_MAX << ", held-out " << POSITIONS - CALIBRATION
+            << " positions: mean |v_int8 - v_fp32| = " << error.meanAbs << ", max = " << error.maxAbs << std::endl;
+    net.setPrecision(ValueNet::Precision::INT8);
+    measure("int8");
+    return 0;
+}
@@ -4,6 +4,9 @@
 #include <cstring>
 #include "bits/constants/bit_constants.h"
 #include "big_board/big_board_get_set_do.h"
+#include "big_board/zobrist_keys.h"
+#include "big_board/board_symmetry.h"
+#include "big_board/PackedBoard.h"
 #include "boards/precalculated/precalculated_small_boards.h"
 
 class BigBoard {
@@ -13,19 +16,57 @@ public:
     uint64_t &bigState1;
     uint64_t &bigState2;
 
+    uint64_t symmetryKeys[symmetry::COUNT]; ///< Klucze Zobrist obrazów pozycji przy 8 symetriach (symmetryKeys[0] == hashKey)
+    uint64_t canonicalKey; ///< Najmniejszy z symmetryKeys - wspólny klucz pozycji symetrycznych
+    uint8_t canonicalSymmetryMask; ///< Bity symetrii, przy których osiągnięto canonicalKey (>1 bit - pozycja symetryczna)
+
+    /**
+     * @brief Minimalna różnica stanu zapisywana przez applyMove(move, undo): ruch zmienia tylko
+     *        słowo swojej małej planszy, bigState1, bigState2 i klucze - undoMove je przywraca.
+     */
+    struct MoveUndo {
+        uint64_t board; ///< Mała plansza ruchu przed ruchem
+        uint64_t bigState1;
+        uint64_t bigState2;
+        uint64_t symmetryKeys[symmetry::COUNT]; ///< Razem z hashKey (== symmetryKeys[0])
+        uint64_t canonicalKey;
+        uint8_t canonicalSymmetryMask;
+        uint8_t boardIndex;
+    };
+
 private:
-    alignas(64) uint8_t movesArray[bigBoardArrays::movesSize + 1];
+    alignas(64) uint8_t movesArray[bigBoardArrays::movesBufferSize];
+    bool movesValid; ///< movesArray odpowiada bieżącej pozycji (zerowane przy każdej zmianie planszy)
 
-    inline void updateHashKey() {
-        uint64_t hash = 0xcbf29ce484222325;
-        constexpr uint64_t prime = 0x100000001b3;
+    /**
+     * @brief Indeks klucza Zobrist aktywnej planszy: jedna wskazana plansza albo swobodny wybór (lub koniec gry).
+     */
+    inline uint64_t activeBoardIndex() const {
+        return activeBoardIndex(BigBoardGet::validBoards(bigState2) & move::mask::boardIndex);
+    }
 
-        for (int i = 0; i < bigBoardArrays::size - 1; ++i) {
-            hash ^= boardsArray[i];
-            hash *= prime;
-        }
+    /**
+     * @param singleBoardIndex Indeks planszy, jeśli wiadomo, że to ona byłaby jedyną aktywną.
+     */
+    inline uint64_t activeBoardIndex(uint64_t singleBoardIndex) const {
+        bool single = BigBoardGet::validBoardsCount(bigState2) == 1;
+        return single ? singleBoardIndex : zobrist::ANY_BOARD;
+    }
 
-        hashKey = hash;
+    /**
+     * @brief Wybiera najmniejszy z kluczy symetrycznych i zapamiętuje wszystkie symetrie, które go dają.
+     */
+    inline void updateCanonicalKey() {
+        canonicalKey = symmetryKeys[symmetry::IDENTITY];
+        canonicalSymmetryMask = 1 << symmetry::IDENTITY;
+        for (int g = 1; g < symmetry::COUNT; ++g) {
+            if (symmetryKeys[g] < canonicalKey) {
+                canonicalKey = symmetryKeys[g];
+                canonicalSymmetryMask = 1 << g;
+            } else if (symmetryKeys[g] == canonicalKey) {
+                canonicalSymmetryMask |= 1 << g;
+            }
+        }
     }
 
     /**
@@ -159,19 +200,22 @@ private:
         uint8_t *bytePos = movesArray + 1; // na pozycji 0 będzie liczba akcji
 
         for (int i = 0; i < validBoardsCount; ++i) {
-            int boardIndex = (validBoardsEncoded >> (i << 2)) & move::mask::boardIndex;
-
+            uint64_t boardIndex = (validBoardsEncoded >> (i << 2)) & move::mask::boardIndex;
             uint64_t board = boardsArray[boardIndex];
-            int freeCount = boardGet::freeCount(board);
-            uint64_t freeCells = boardGet::freeCells(board);
-
-            for (int j = 0; j < freeCount; ++j) {
-                int cellIndex = (freeCells >> (j << 2)) & move::mask::cellIndex;
-                uint8_t move = (boardIndex << move::pos::boardIndex) |
-                               (cellIndex << move::pos::cellIndex);
 
-                *(bytePos++) = move;
-            }
+            // Indeksy wolnych komórek z tablicy (16 bajtów naraz) + indeks planszy w każdym bajcie.
+            // Zapis wychodzi poza ostatni ruch planszy - stąd zapas w movesBufferSize.
+            const uint8_t *cells = freeCellsByMask[~boardGet::OXpartsMeged(board) & rights::_9_BITS];
+            const uint64_t boardBytes = (boardIndex << move::pos::boardIndex) * 0x0101010101010101ULL;
+            uint64_t low, high;
+            std::memcpy(&low, cells, sizeof(low));
+            std::memcpy(&high, cells + sizeof(low), sizeof(high));
+            low |= boardBytes;
+            high |= boardBytes;
+            std::memcpy(bytePos, &low, sizeof(low));
+            std::memcpy(bytePos + sizeof(low), &high, sizeof(high));
+
+            bytePos += boardGet::freeCount(board);
         }
         int movesCount = (bytePos - (movesArray + 1));
         movesArray[0] = movesCount;
@@ -203,6 +247,17 @@ public:
           bigState2(boardsArray[bigBoardArrays::bigState2Pos]),
           hashKey(boardsArray[bigBoardArrays::hashKeyPos]) {
         std::memcpy(this->boardsArray, other.boardsArray, sizeof(this->boardsArray));
+        movesValid = false; // movesArray nie jest kopiowana
+        std::memcpy(this->symmetryKeys, other.symmetryKeys, sizeof(this->symmetryKeys));
+        canonicalKey = other.canonicalKey;
+        canonicalSymmetryMask = other.canonicalSymmetryMask;
+    }
+
+    inline explicit BigBoard(const PackedBoard &packed)
+        : bigState1(boardsArray[bigBoardArrays::bigState1Pos]),
+          bigState2(boardsArray[bigBoardArrays::bigState2Pos]),
+          hashKey(boardsArray[bigBoardArrays::hashKeyPos]) {
+        unpack(packed);
     }
 
     BigBoard &operator=(const BigBoard &) = delete;
@@ -269,11 +324,106 @@ public:
      * Zeruje tablicę stanów małych plansz i aktualizuje ich informacje.
      */
     void stateInit() {
+        movesValid = false;
         std::memset(boardsArray, 0, sizeof(boardsArray));
         updateAllBoardsInfo();
         BigBoardSet::validBoardsCount(bigState2, 9);
         BigBoardSet::validBoards(bigState2, 0x876543210);
-        updateHashKey();
+        initKeys();
+    }
+
+    /**
+     * @brief Liczy od zera klucze Zobrist wszystkich symetrii, hashKey i canonicalKey.
+     *
+     * symmetryKeys[g] == computeHashKey(symmetry::tables.keys[g]).
+     */
+    void initKeys() {
+        // jedno przejście po zajętych komórkach dla wszystkich symetrii naraz (jak w applyMove)
+        uint64_t activeBoard = activeBoardIndex();
+        bool playerO = getCurrentPlayer() == cell::O;
+        for (int g = 0; g < symmetry::COUNT; ++g) {
+            const zobrist::Keys &keys = symmetry::tables.keys[g];
+            symmetryKeys[g] = keys.activeBoard[activeBoard] ^ (playerO ? keys.playerO : 0);
+        }
+        for (int boardIndex = 0; boardIndex < 9; ++boardIndex) {
+            uint64_t board = boardsArray[boardIndex];
+            for (int player = cell::X; player <= cell::O; ++player) {
+                uint64_t cells = player == cell::X ? boardGet::Xpart(board) : boardGet::Opart(board);
+                for (; cells != 0; cells &= cells - 1) {
+                    int cellIndex = __builtin_ctzll(cells);
+                    for (int g = 0; g < symmetry::COUNT; ++g) {
+                        symmetryKeys[g] ^= symmetry::tables.keys[g].cells[boardIndex][cellIndex][player];
+                    }
+                }
+            }
+        }
+        hashKey = symmetryKeys[symmetry::IDENTITY];
+        updateCanonicalKey();
+    }
+
+    /**
+     * @brief Pakuje pozycję do PackedBoard (18 bajtów) - do przechowywania w Set_S i ReplayBuffer.
+     */
+    inline PackedBoard pack() const {
+        PackedBoard packed;
+        for (int boardIndex = 0; boardIndex < 9; ++boardIndex) {
+            packed.boards[boardIndex] = packedBoard::encodeBoard(boardsArray[boardIndex]);
+        }
+        uint64_t activeBoard = activeBoardIndex();
+        for (int bit = 0; bit < packedBoard::ACTIVE_BOARD_BITS; ++bit) {
+            packed.boards[packedBoard::ACTIVE_BOARD_WORD + bit] |=
+                    ((activeBoard >> bit) & rights::_1_BIT) << packedBoard::FLAG_POS;
+        }
+        packed.boards[packedBoard::PLAYER_WORD] |= getCurrentPlayer() << packedBoard::FLAG_POS;
+        return packed;
+    }
+
+    /**
+     * @brief Odtwarza pełny stan z PackedBoard: informacje o planszach, aktywne plansze, gracza i klucze.
+     *
+     * Po unpack(board.pack()) plansza jest identyczna z board (łącznie z hashKey i canonicalKey).
+     */
+    void unpack(const PackedBoard &packed) {
+        movesValid = false;
+        uint64_t activeBoard = 0;
+        for (int bit = 0; bit < packedBoard::ACTIVE_BOARD_BITS; ++bit) {
+            activeBoard |= uint64_t(packed.boards[packedBoard::ACTIVE_BOARD_WORD + bit] >> packedBoard::FLAG_POS) << bit;
+        }
+        for (int boardIndex = 0; boardIndex < 9; ++boardIndex) {
+            boardsArray[boardIndex] = packedBoard::decodeBoard(packed.boards[boardIndex]);
+        }
+        bigState1 = 0;
+        bigState2 = uint64_t(packed.boards[packedBoard::PLAYER_WORD] >> packedBoard::FLAG_POS) << bigState2::pos::PLAYER;
+        updateAllBoardsInfo();
+        // ANY_BOARD nie wskazuje żadnej planszy w trakcie - settingValidBoards ustawi wszystkie plansze ONGOING
+        settingValidBoards(activeBoard);
+        initKeys();
+    }
+
+    /**
+     * @brief Oblicza klucz Zobrist od zera (przy inicjalizacji i do weryfikacji).
+     *
+     * W applyMove klucz jest aktualizowany przyrostowo i zawsze równa się wynikowi tej metody.
+     *
+     * @param keys Klucze Zobrist; symmetry::tables.keys[g] daje klucz obrazu pozycji przy symetrii g.
+     */
+    uint64_t computeHashKey(const zobrist::Keys &keys = zobrist::keys) const {
+        uint64_t hash = 0;
+        for (int boardIndex = 0; boardIndex < 9; ++boardIndex) {
+            uint64_t board = boardsArray[boardIndex];
+            for (int cellIndex = 0; cellIndex < 9; ++cellIndex) {
+                if ((board >> (board::pos::X_part + cellIndex)) & rights::_1_BIT) {
+                    hash ^= keys.cells[boardIndex][cellIndex][cell::X];
+                }
+                if ((board >> (board::pos::O_part + cellIndex)) & rights::_1_BIT) {
+                    hash ^= keys.cells[boardIndex][cellIndex][cell::O];
+                }
+            }
+        }
+        if (getCurrentPlayer() == cell::O) {
+            hash ^= keys.playerO;
+        }
+        return hash ^ keys.activeBoard[activeBoardIndex()];
     }
 
     /**
@@ -285,18 +435,100 @@ public:
      * @param move Zakodowany ruch: 4 bity na indeks komórki, 4 bita na indeks planszy.
      */
     inline void applyMove(uint8_t move) {
+        movesValid = false;
         int moveBoardIndex = (move >> move::pos::boardIndex) & move::mask::boardIndex;
         int moveCellIndex = (move >> move::pos::cellIndex) & move::mask::cellIndex;
 
+        uint64_t player = BigBoardGet::player(bigState2);
         uint64_t &targetBoard = boardsArray[moveBoardIndex];
-        uint64_t cellMask = rights::_1_BIT << (moveCellIndex + BigBoardGet::player(bigState2) * board::pos::O_part);
+        uint64_t cellMask = rights::_1_BIT << (moveCellIndex + player * board::pos::O_part);
         targetBoard |= cellMask; // apply the move
 
+        // jeśli przed ruchem aktywna była jedna plansza, to właśnie plansza tego ruchu
+        uint64_t oldActiveBoard = activeBoardIndex(moveBoardIndex);
         updateBoardInfo(moveBoardIndex);
         settingValidBoards(moveCellIndex);
 
         BigBoardDo::invertPlayer(bigState2);
-        updateHashKey();
+        // przyrostowa aktualizacja kluczy Zobrist wszystkich symetrii: figura, strona do ruchu, aktywna plansza
+        uint64_t newActiveBoard = activeBoardIndex();
+        for (int g = 0; g < symmetry::COUNT; ++g) {
+            const zobrist::Keys &keys = symmetry::tables.keys[g];
+            symmetryKeys[g] ^= keys.cells[moveBoardIndex][moveCellIndex][player] ^ keys.playerO ^
+                    keys.activeBoard[oldActiveBoard] ^ keys.activeBoard[newActiveBoard];
+        }
+        hashKey = symmetryKeys[symmetry::IDENTITY];
+        updateCanonicalKey();
+    }
+
+    /**
+     * @brief Ruch z zapisem różnicy stanu - do przeszukiwania bez kopiowania planszy.
+     *
+     *     BigBoard::MoveUndo undo;
+     *     board.applyMove(move, undo);
+     *     ...                      // potomek
+     *     board.undoMove(undo);    // plansza dokładnie taka, jak przed ruchem
+     */
+    inline void applyMove(uint8_t move, MoveUndo &undo) {
+        undo.boardIndex = (move >> move::pos::boardIndex) & move::mask::boardIndex;
+        undo.board = boardsArray[undo.boardIndex];
+        undo.bigState1 = bigState1;
+        undo.bigState2 = bigState2;
+        std::memcpy(undo.symmetryKeys, symmetryKeys, sizeof(symmetryKeys));
+        undo.canonicalKey = canonicalKey;
+        undo.canonicalSymmetryMask = canonicalSymmetryMask;
+        applyMove(move);
+    }
+
+    /**
+     * @brief Cofa ruch wykonany przez applyMove(move, undo). Ruchy cofa się w odwrotnej kolejności.
+     *
+     * Tablica getValidMoves() nie jest przywracana - wygeneruje się ponownie przy następnym wywołaniu.
+     */
+    inline void undoMove(const MoveUndo &undo) {
+        movesValid = false;
+        boardsArray[undo.boardIndex] = undo.board;
+        bigState1 = undo.bigState1;
+        bigState2 = undo.bigState2;
+        std::memcpy(symmetryKeys, undo.symmetryKeys, sizeof(symmetryKeys));
+        hashKey = symmetryKeys[symmetry::IDENTITY];
+        canonicalKey = undo.canonicalKey;
+        canonicalSymmetryMask = undo.canonicalSymmetryMask;
+    }
+
+    /**
+     * @brief Przekształca ruch w tej pozycji na ruch w jej kanonicznym obrazie (dla kluczy v'(s,a)).
+     *
+     * Jeśli pozycja jest symetryczna (kilka symetrii daje canonicalKey), bierzemy najmniejszy z obrazów ruchu,
+     * więc ruchy symetryczne względem siebie dostają ten sam klucz.
+     */
+    inline uint8_t canonicalMove(uint8_t move) const {
+        uint32_t mask = canonicalSymmetryMask;
+        uint8_t best = symmetry::transformMove(__builtin_ctz(mask), move);
+        mask &= mask - 1;
+        while (mask != 0) [[unlikely]] {
+            uint8_t transformed = symmetry::transformMove(__builtin_ctz(mask), move);
+            best = transformed < best ? transformed : best;
+            mask &= mask - 1;
+        }
+        return best;
+    }
+
+    /**
+     * @brief Odwrotność canonicalMove: ruch kanonicznego obrazu -> ruch w tej pozycji.
+     *
+     * W pozycji symetrycznej zwraca jeden z ruchów równoważnych (wszystkie mają ten sam canonicalMove).
+     */
+    inline uint8_t moveFromCanonical(uint8_t canonical) const {
+        return symmetry::inverseTransformMove(__builtin_ctz(canonicalSymmetryMask), canonical);
+    }
+
+    /**
+     * @return true, jeśli pozycja przechodzi w siebie przy jakiejś nietrywialnej symetrii
+     *         (wtedy część ruchów jest równoważna i wystarczy ocenić jeden z nich).
+     */
+    inline bool isSelfSymmetric() const {
+        return (canonicalSymmetryMask & (canonicalSymmetryMask - 1)) != 0;
     }
 
     /**
@@ -323,12 +555,16 @@ public:
      * - Na pozycji 0 znajduje się liczba dostępnych ruchów.
      * - Na kolejnych pozycjach znajdują się kody ruchów.
      *
-     * Dane pozostają ważne do następnej zmiany stanu planszy.
+     * Dane pozostają ważne do następnej zmiany stanu planszy; do tego czasu kolejne wywołania
+     * zwracają gotową tablicę bez ponownego generowania.
      *
      * @return Wskaźnik na tablicę z dostępnymi ruchami.
      */
     inline uint8_t *getValidMoves() {
-        fillMovesArray();
+        if (!movesValid) {
+            fillMovesArray();
+            movesValid = true;
+        }
         return movesArray;
     }
 };
@@ -0,0 +1,69 @@
+// PackedBoard.h
+#pragma once
+
+#include <cstdint>
+#include "bits/constants/bit_constants.h"
+#include "boards/precalculated/precalculated_small_boards.h"
+
+/**
+ * @brief Компактная запись позиции BigBoard для хранилищ на сотни тысяч состояний (Set_S, ReplayBuffer).
+ *
+ * boards[i] — номер расстановки малой доски i в троичной записи (< 3^9, младшие 15 бит).
+ * Старшие биты слов: boards[0..3] — активная доска (0-8 или zobrist::ANY_BOARD), boards[4] — игрок.
+ * Состояния досок, список активных досок и ключи Zobrist однозначно следуют из этих данных
+ * и восстанавливаются в BigBoard::unpack.
+ *
+ * Ровно 16 байт не получится: 3^81 > 2^128, поэтому 9 слов по 15 бит + 5 бит = 18 байт.
+ */
+struct PackedBoard {
+    uint16_t boards[9];
+};
+
+namespace packedBoard {
+    constexpr int TERNARY_CODES = 19683; // 3^9
+    constexpr uint16_t TERNARY_MASK = rights::_15_BITS;
+    constexpr int FLAG_POS = 15; ///< Старший бит слова — под активную доску и игрока
+    constexpr int ACTIVE_BOARD_WORD = 0; ///< Биты активной доски — в словах 0..3
+    constexpr int ACTIVE_BOARD_BITS = 4;
+    constexpr int PLAYER_WORD = 4;
+
+    /// Обратная к троичному номеру таблица: номер расстановки -> код X|O малой доски
+    struct TernaryCodes {
+        uint32_t code[TERNARY_CODES];
+    };
+
+    constexpr TernaryCodes generateTernaryCodes() {
+        TernaryCodes table{};
+        for (int ternary = 0; ternary < TERNARY_CODES; ++ternary) {
+            uint32_t code = 0;
+            int rest = ternary;
+            for (int cellIndex = 0; cellIndex < 9; ++cellIndex, rest /= 3) {
+                int digit = rest % 3; // 0 — пусто, 1 — X, 2 — O
+                if (digit == 1) {
+                    code |= 1u << (board::pos::X_part + cellIndex);
+                } else if (digit == 2) {
+                    code |= 1u << (board::pos::O_part + cellIndex);
+                }
+            }
+            table.code[ternary] = code;
+        }
+        return table;
+    }
+
+    alignas(64) inline constexpr TernaryCodes ternaryCodes = generateTernaryCodes();
+
+    /**
+     * @return троичный номер расстановки малой доски board (слово BigBoard::boardsArray)
+     */
+    inline uint16_t encodeBoard(uint64_t board) {
+        const uint16_t (&toTernary)[512] = smallBoards::maskTables.binaryToTernary;
+        return toTernary[boardGet::Xpart(board)] + 2 * toTernary[boardGet::Opart(board)];
+    }
+
+    /**
+     * @return код X|O малой доски по слову PackedBoard::boards (старший бит отбрасывается)
+     */
+    inline uint64_t decodeBoard(uint16_t word) {
+        return ternaryCodes.code[word & TERNARY_MASK];
+    }
+}
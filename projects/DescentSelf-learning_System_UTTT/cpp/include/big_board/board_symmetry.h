@@ -0,0 +1,90 @@
+// board_symmetry.h
+#pragma once
+
+#include <cstdint>
+#include "bits/constants/bit_constants.h"
+#include "big_board/zobrist_keys.h"
+
+/**
+ * @brief 8 симметрий доски (группа D4) для канонического хеширования позиций.
+ *
+ * Симметрия g = flip * 4 + k: поворот np.rot90 на k * 90°, затем (если flip) отражение
+ * по столбцам — тот же порядок, что и в trainer.augment_data. Большая доска 9×9
+ * поворачивается так, что одна и та же перестановка 3×3 действует и на индекс малой
+ * доски, и на индекс клетки внутри неё.
+ *
+ * Для каждой симметрии строится свой набор ключей Zobrist:
+ * keys[g].cells[b][c][p] = zobrist::keys.cells[g(b)][g(c)][p], т.е. хеш позиции,
+ * посчитанный ключами keys[g], равен обычному хешу её образа g(P).
+ */
+namespace symmetry {
+    constexpr int COUNT = 8;
+    constexpr int IDENTITY = 0;
+    constexpr int MOVES_TABLE_SIZE = 0x89; ///< Максимальный код хода (8 << 4 | 8) + 1
+
+    struct Tables {
+        uint8_t square[COUNT][9]; ///< Перестановка 3×3 (индекс доски или клетки)
+        uint8_t cells[COUNT][81]; ///< Глобальная клетка boardIndex * 9 + cellIndex
+        uint8_t moves[COUNT][MOVES_TABLE_SIZE]; ///< Код хода (boardIndex << 4 | cellIndex)
+        uint8_t inverseMoves[COUNT][MOVES_TABLE_SIZE]; ///< inverseMoves[g][moves[g][m]] == m
+        zobrist::Keys keys[COUNT]; ///< Ключи Zobrist образа позиции
+    };
+
+    /// Образ клетки (row, col) доски 3×3 при симметрии g
+    constexpr int transformSquare(int g, int index) {
+        int row = index / 3;
+        int col = index % 3;
+        for (int k = 0; k < g % 4; ++k) {
+            // np.rot90: new[i][j] = old[j][2 - i]  =>  (row, col) -> (2 - col, row)
+            int rotatedRow = 2 - col;
+            col = row;
+            row = rotatedRow;
+        }
+        if (g >= 4) {
+            col = 2 - col; // np.flip(axis=2)
+        }
+        return row * 3 + col;
+    }
+
+    constexpr Tables generateTables() {
+        Tables tables{};
+        for (int g = 0; g < COUNT; ++g) {
+            for (int i = 0; i < 9; ++i) {
+                tables.square[g][i] = transformSquare(g, i);
+            }
+            for (int b = 0; b < 9; ++b) {
+                for (int c = 0; c < 9; ++c) {
+                    int tb = tables.square[g][b];
+                    int tc = tables.square[g][c];
+                    tables.cells[g][b * 9 + c] = tb * 9 + tc;
+                    uint8_t original = (b << move::pos::boardIndex) | (c << move::pos::cellIndex);
+                    uint8_t transformed = (tb << move::pos::boardIndex) | (tc << move::pos::cellIndex);
+                    tables.moves[g][original] = transformed;
+                    tables.inverseMoves[g][transformed] = original;
+                    tables.keys[g].cells[b][c][cell::X] = zobrist::keys.cells[tb][tc][cell::X];
+                    tables.keys[g].cells[b][c][cell::O] = zobrist::keys.cells[tb][tc][cell::O];
+                }
+                tables.keys[g].activeBoard[b] = zobrist::keys.activeBoard[tables.square[g][b]];
+            }
+            tables.keys[g].activeBoard[zobrist::ANY_BOARD] = zobrist::keys.activeBoard[zobrist::ANY_BOARD];
+            tables.keys[g].playerO = zobrist::keys.playerO;
+        }
+        return tables;
+    }
+
+    inline constexpr Tables tables = generateTables();
+
+    /**
+     * @brief Переводит ход в систему координат канонического образа позиции.
+     */
+    inline uint8_t transformMove(int g, uint8_t move) {
+        return tables.moves[g][move];
+    }
+
+    /**
+     * @brief Обратное к transformMove: ход канонического образа -> ход исходной позиции.
+     */
+    inline uint8_t inverseTransformMove(int g, uint8_t move) {
+        return tables.inverseMoves[g][move];
+    }
+}
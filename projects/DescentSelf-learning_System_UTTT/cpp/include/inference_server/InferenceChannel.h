@@ -0,0 +1,241 @@
+// InferenceChannel.h
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include "state_to_nn_representation/channels_layout.h"
+
+#if defined(__linux__)
+#include <cerrno>
+#include <climits>
+#include <ctime>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define INFERENCE_SERVER_SUPPORTED 1
+#else
+#define INFERENCE_SERVER_SUPPORTED 0 // futex и POSIX shm: сервер и клиент собираются только под Linux
+#endif
+
+/**
+ * @brief Общая память процесса InferenceServer и его клиентов — self-play процессов Descent.
+ *
+ * Сегмент POSIX shm: Header, кольца клиентов (RING_SLOTS ячеек на клиента), область выборки обучения.
+ * Ячейка проходит FREE -> FILLING (клиент пишет каналы) -> SUBMITTED -> RUNNING (сервер взял её в батч)
+ * -> DONE (values записаны) -> FREE (клиент забрал оценки). Область обучения проходит те же состояния;
+ * её, как кольцо, занимает pid клиента (learnOwner), и от умершего владельца её освобождают клиент или сервер.
+ * Сигналы — futex прямо на словах состояния, без FUTEX_PRIVATE_FLAG (слова общие для процессов):
+ * клиент увеличивает doorbell и будит сервер, сервер будит ждущих на state ячейки.
+ */
+namespace inferenceChannel {
+    constexpr uint32_t MAGIC = 0x49545455; ///< "UTTI"
+    constexpr uint32_t VERSION = 2;
+    constexpr int MAX_CLIENTS = 16;
+    constexpr int RING_SLOTS = 16; ///< Запросов одного клиента в полёте: потоки Descent и части большого батча
+    constexpr int SLOT_STATES = 256; ///< Состояний в ячейке; больший батч клиент делит на несколько ячеек
+    constexpr uint64_t ALIVE_CHECK_NS = 100'000'000; ///< Ожидание дольше — проверка, жив ли другой процесс
+
+    enum SlotState : uint32_t {
+        FREE = 0,
+        FILLING = 1,
+        SUBMITTED = 2,
+        RUNNING = 3,
+        DONE = 4
+    };
+
+    struct alignas(64) Slot {
+        std::atomic<uint32_t> state;
+        uint32_t count;
+        uint32_t weightsVersion; ///< Версия весов, которыми посчитаны values
+        uint64_t submitNs; ///< steady_clock при отправке (CLOCK_MONOTONIC, общий для процессов)
+        uint8_t mainChannels[SLOT_STATES * stateToChannels::MAIN_BYTES];
+        uint8_t macroChannels[SLOT_STATES * stateToChannels::MACRO_BYTES];
+        float values[SLOT_STATES];
+    };
+
+    struct alignas(64) Header {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t mainBytes; ///< Формат входов (NN_INPUT_PACKED) у сервера и клиентов должен совпадать
+        uint32_t macroBytes;
+        uint32_t learnCapacity; ///< Состояний в области выборки обучения
+        int32_t serverPid;
+        std::atomic<uint32_t> serverRunning;
+        std::atomic<uint32_t> doorbell; ///< +1 на каждый запрос; сервер спит на смене значения
+        std::atomic<uint32_t> weightsVersion; ///< +1 после каждого обучения на сервере
+        std::atomic<uint32_t> learnState; ///< SlotState области обучения
+        uint32_t learnCount;
+        std::atomic<int32_t> learnOwner; ///< pid клиента, занявшего область обучения, 0 — область свободна
+        std::atomic<int32_t> clientPids[MAX_CLIENTS]; ///< pid владельца кольца, 0 — кольцо свободно
+    };
+
+    static_assert(std::atomic<uint32_t>::is_always_lock_free && sizeof(std::atomic<uint32_t>) == sizeof(uint32_t),
+                  "futex works on plain 32-bit words");
+
+    inline uint64_t nowNs() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    inline size_t slotsOffset() {
+        return sizeof(Header);
+    }
+
+    /// Область обучения: values [learnCapacity], затем каналы main и macro
+    inline size_t learnOffset() {
+        return slotsOffset() + sizeof(Slot) * MAX_CLIENTS * RING_SLOTS;
+    }
+
+    inline size_t segmentSize(uint32_t learnCapacity) {
+        return learnOffset() + static_cast<size_t>(learnCapacity) *
+               (sizeof(float) + stateToChannels::MAIN_BYTES + stateToChannels::MACRO_BYTES);
+    }
+
+#if INFERENCE_SERVER_SUPPORTED
+    /// Спит, пока word == expected, не дольше timeoutNs; ложные пробуждения допустимы — вызывающий проверяет условие
+    inline void futexWait(std::atomic<uint32_t> &word, uint32_t expected, uint64_t timeoutNs) {
+        timespec timeout{static_cast<time_t>(timeoutNs / 1'000'000'000), static_cast<long>(timeoutNs % 1'000'000'000)};
+        syscall(SYS_futex, reinterpret_cast<uint32_t *>(&word), FUTEX_WAIT, expected, &timeout, nullptr, 0);
+    }
+
+    inline void futexWakeAll(std::atomic<uint32_t> &word) {
+        syscall(SYS_futex, reinterpret_cast<uint32_t *>(&word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+    }
+
+    inline bool processAlive(int32_t pid) {
+        return pid > 0 && (kill(pid, 0) == 0 || errno == EPERM);
+    }
+
+    /**
+     * @brief Отображённый сегмент: create() — сервер (владелец, удаляет имя при закрытии), open() — клиент.
+     */
+    class Segment {
+    public:
+        Header *header = nullptr;
+        float *learnValues = nullptr;
+        uint8_t *learnMainChannels = nullptr;
+        uint8_t *learnMacroChannels = nullptr;
+
+        Segment() = default;
+
+        Segment(const Segment &) = delete;
+
+        Segment &operator=(const Segment &) = delete;
+
+        ~Segment() {
+            close();
+        }
+
+        inline Slot &slot(int client, int index) {
+            return slots[client * RING_SLOTS + index];
+        }
+
+        /// Новый сегмент name (прежний с тем же именем удаляется: его клиенты увидят остановку сервера)
+        bool create(const std::string &segmentName, uint32_t learnCapacity) {
+            close();
+            shm_unlink(segmentName.c_str());
+            const int fd = shm_open(segmentName.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+            if (fd < 0) {
+                std::cerr << "[InferenceChannel] shm_open " << segmentName << ": " << std::strerror(errno) << std::endl;
+                return false;
+            }
+            const size_t bytes = segmentSize(learnCapacity);
+            if (ftruncate(fd, static_cast<off_t>(bytes)) != 0 || !map(fd, bytes)) {
+                std::cerr << "[InferenceChannel] cannot size " << segmentName << ": " << std::strerror(errno) << std::endl;
+                ::close(fd);
+                shm_unlink(segmentName.c_str());
+                return false;
+            }
+            ::close(fd);
+            name = segmentName;
+            owner = true;
+
+            // ftruncate заполнил сегмент нулями: все ячейки FREE, кольца свободны
+            header->magic = MAGIC;
+            header->version = VERSION;
+            header->mainBytes = stateToChannels::MAIN_BYTES;
+            header->macroBytes = stateToChannels::MACRO_BYTES;
+            header->learnCapacity = learnCapacity;
+            header->serverPid = static_cast<int32_t>(getpid());
+            locate();
+            return true;
+        }
+
+        bool open(const std::string &segmentName) {
+            close();
+            const int fd = shm_open(segmentName.c_str(), O_RDWR, 0);
+            if (fd < 0) {
+                std::cerr << "[InferenceChannel] no inference server at " << segmentName << std::endl;
+                return false;
+            }
+            struct stat info{};
+            const bool ok = fstat(fd, &info) == 0 && static_cast<size_t>(info.st_size) >= sizeof(Header) &&
+                            map(fd, static_cast<size_t>(info.st_size));
+            ::close(fd);
+            if (!ok) {
+                std::cerr << "[InferenceChannel] cannot map " << segmentName << std::endl;
+                return false;
+            }
+            if (header->magic != MAGIC || header->version != VERSION ||
+                header->mainBytes != stateToChannels::MAIN_BYTES || header->macroBytes != stateToChannels::MACRO_BYTES ||
+                segmentSize(header->learnCapacity) > length) {
+                std::cerr << "[InferenceChannel] " << segmentName
+                        << " was created by an incompatible server (version or NN_INPUT_PACKED differ)" << std::endl;
+                close();
+                return false;
+            }
+            name = segmentName;
+            locate();
+            return true;
+        }
+
+        void close() {
+            if (header == nullptr) {
+                return;
+            }
+            munmap(header, length);
+            if (owner) {
+                shm_unlink(name.c_str());
+            }
+            header = nullptr;
+            slots = nullptr;
+            length = 0;
+            owner = false;
+        }
+
+    private:
+        Slot *slots = nullptr;
+        size_t length = 0;
+        std::string name;
+        bool owner = false;
+
+        bool map(int fd, size_t bytes) {
+            void *view = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            if (view == MAP_FAILED) {
+                return false;
+            }
+            header = static_cast<Header *>(view);
+            length = bytes;
+            return true;
+        }
+
+        void locate() {
+            unsigned char *base = reinterpret_cast<unsigned char *>(header);
+            slots = reinterpret_cast<Slot *>(base + slotsOffset());
+            learnValues = reinterpret_cast<float *>(base + learnOffset());
+            learnMainChannels = base + learnOffset() + static_cast<size_t>(header->learnCapacity) * sizeof(float);
+            learnMacroChannels = learnMainChannels + static_cast<size_t>(header->learnCapacity) * stateToChannels::MAIN_BYTES;
+        }
+    };
+#endif
+}
@@ -0,0 +1,298 @@
+// InferenceClient.h
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include "inference_server/InferenceChannel.h"
+
+/**
+ * @brief Клиент InferenceServer: сеть оценивается и обучается в процессе сервера, своей модели у клиента нет.
+ *
+ * connect() занимает одно из колец сегмента. evaluate() делит батч на ячейки по SLOT_STATES состояний,
+ * держит в полёте до RING_SLOTS ячеек и ждёт каждую на futex; сервер объединяет ячейки всех клиентов
+ * в общие батчи. evaluate() и learn() можно вызывать из нескольких потоков: ячейки захватываются CAS.
+ * Если сервер остановился или умер, вызов возвращает false и клиент считается отключённым
+ * (сегмент остаётся отображённым до disconnect(), чтобы не выдернуть его из-под других потоков).
+ */
+class InferenceClient {
+public:
+    InferenceClient() = default;
+
+    InferenceClient(const InferenceClient &) = delete;
+
+    InferenceClient &operator=(const InferenceClient &) = delete;
+
+    ~InferenceClient() {
+        disconnect();
+    }
+
+    inline bool isConnected() const {
+        return connected.load(std::memory_order_acquire);
+    }
+
+#if INFERENCE_SERVER_SUPPORTED
+    /**
+     * @param name Имя сегмента POSIX shm сервера ("/descent_inference")
+     * @return false — сервера нет, он несовместим или все MAX_CLIENTS колец заняты живыми клиентами
+     */
+    bool connect(const std::string &name) {
+        disconnect();
+        if (!segment.open(name)) {
+            return false;
+        }
+        inferenceChannel::Header &header = *segment.header;
+        if (!serverAlive()) {
+            std::cerr << "[InferenceClient] inference server at " << name << " is not running" << std::endl;
+            segment.close();
+            return false;
+        }
+        const int32_t pid = static_cast<int32_t>(getpid());
+        for (int i = 0; i < inferenceChannel::MAX_CLIENTS; ++i) {
+            int32_t owner = header.clientPids[i].load(std::memory_order_acquire);
+            if (owner != 0 && inferenceChannel::processAlive(owner)) {
+                continue;
+            }
+            // Кольцо свободно или его владелец умер
+            if (header.clientPids[i].compare_exchange_strong(owner, pid)) {
+                client = i;
+                if (!reclaimRing()) {
+                    disconnect();
+                    return false;
+                }
+                connected.store(true, std::memory_order_release);
+                std::cout << "[InferenceClient] connected to " << name << " as client " << i << std::endl;
+                return true;
+            }
+        }
+        std::cerr << "[InferenceClient] all " << inferenceChannel::MAX_CLIENTS << " client rings of " << name
+                << " are taken" << std::endl;
+        segment.close();
+        return false;
+    }
+
+    void disconnect() {
+        connected.store(false, std::memory_order_release);
+        if (client >= 0 && segment.header != nullptr) {
+            segment.header->clientPids[client].store(0, std::memory_order_release);
+        }
+        client = -1;
+        segment.close();
+    }
+
+    /**
+     * @brief values[i] — оценка состояния i (каналы в формате stateToChannels::convert).
+     * @param weightsVersion  Версия весов сервера для батча; если между его частями сервер обучился — старейшая,
+     *                        чтобы следующий вызов увидел новую версию и сбросил кеш оценок
+     * @return false — сервер недоступен: клиент отключён, values не записаны
+     */
+    bool evaluate(const uint8_t *mainChannels, const uint8_t *macroChannels, int count, float *values,
+                  uint32_t &weightsVersion) {
+        if (!isConnected()) {
+            return false;
+        }
+        constexpr int SLOT_STATES = inferenceChannel::SLOT_STATES;
+        const int chunks = (count + SLOT_STATES - 1) / SLOT_STATES;
+        int inFlight[inferenceChannel::RING_SLOTS]; // ячейки в порядке отправки (кольцевая очередь)
+        int head = 0;
+        int tail = 0;
+        int next = 0;
+        while (next < chunks || head != tail) {
+            if (next < chunks && tail - head < inferenceChannel::RING_SLOTS) {
+                const int index = tryAcquire();
+                if (index >= 0) {
+                    const int first = next * SLOT_STATES;
+                    submit(ring(index), mainChannels + static_cast<size_t>(first) * stateToChannels::MAIN_BYTES,
+                           macroChannels + static_cast<size_t>(first) * stateToChannels::MACRO_BYTES,
+                           std::min(SLOT_STATES, count - first));
+                    inFlight[tail % inferenceChannel::RING_SLOTS] = index;
+                    ++tail;
+                    ++next;
+                    continue;
+                }
+                if (head == tail) {
+                    // Все ячейки кольца заняты другими потоками процесса
+                    std::this_thread::yield();
+                    if (!serverAlive()) {
+                        return lost();
+                    }
+                    continue;
+                }
+            }
+            inferenceChannel::Slot &slot = ring(inFlight[head % inferenceChannel::RING_SLOTS]);
+            if (!waitDone(slot.state)) {
+                return lost();
+            }
+            const int first = head * SLOT_STATES;
+            std::memcpy(values + first, slot.values, slot.count * sizeof(float));
+            weightsVersion = head == 0 ? slot.weightsVersion : std::min(weightsVersion, slot.weightsVersion);
+            slot.state.store(inferenceChannel::FREE, std::memory_order_release);
+            ++head;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Обучение сети сервера на выборке (как SharedMemory::Learn); выборки клиентов обучают по очереди.
+     * @param weightsVersion  Версия весов после обучения
+     * @return false — сервер недоступен
+     */
+    bool learn(const uint8_t *mainChannels, const uint8_t *macroChannels, const float *values, int count,
+               uint32_t &weightsVersion) {
+        if (!isConnected()) {
+            return false;
+        }
+        inferenceChannel::Header &header = *segment.header;
+        const int32_t pid = static_cast<int32_t>(getpid());
+        while (true) {
+            int32_t owner = header.learnOwner.load(std::memory_order_acquire);
+            if (owner == 0 || !inferenceChannel::processAlive(owner)) {
+                // Область свободна или её владелец умер, не вернув её: состояние прежнего владельца сбрасывается
+                if (header.learnOwner.compare_exchange_strong(owner, pid)) {
+                    if (owner != 0 && !reclaimState(header.learnState)) {
+                        return lost();
+                    }
+                    break;
+                }
+                continue;
+            }
+            inferenceChannel::futexWait(header.learnState, header.learnState.load(std::memory_order_acquire),
+                                        inferenceChannel::ALIVE_CHECK_NS);
+            if (!serverAlive()) {
+                return lost();
+            }
+        }
+        header.learnState.store(inferenceChannel::FILLING, std::memory_order_relaxed);
+        const uint32_t states = std::min<uint32_t>(count, header.learnCapacity);
+        if (states < static_cast<uint32_t>(count)) {
+            std::cerr << "[InferenceClient] learn sample truncated to the server capacity " << states << std::endl;
+        }
+        std::memcpy(segment.learnValues, values, states * sizeof(float));
+        std::memcpy(segment.learnMainChannels, mainChannels, static_cast<size_t>(states) * stateToChannels::MAIN_BYTES);
+        std::memcpy(segment.learnMacroChannels, macroChannels, static_cast<size_t>(states) * stateToChannels::MACRO_BYTES);
+        header.learnCount = states;
+        header.learnState.store(inferenceChannel::SUBMITTED, std::memory_order_release);
+        ringDoorbell();
+        if (!waitDone(header.learnState)) {
+            return lost();
+        }
+        weightsVersion = header.weightsVersion.load(std::memory_order_acquire);
+        header.learnState.store(inferenceChannel::FREE, std::memory_order_release);
+        header.learnOwner.store(0, std::memory_order_release);
+        inferenceChannel::futexWakeAll(header.learnState);
+        return true;
+    }
+#else
+    bool connect(const std::string &name) {
+        std::cerr << "[InferenceClient] inference server is supported on Linux only, " << name << " ignored" << std::endl;
+        return false;
+    }
+
+    void disconnect() {
+    }
+
+    bool evaluate(const uint8_t *, const uint8_t *, int, float *, uint32_t &) {
+        return false;
+    }
+
+    bool learn(const uint8_t *, const uint8_t *, const float *, int, uint32_t &) {
+        return false;
+    }
+#endif
+
+private:
+    std::atomic<bool> connected{false};
+#if INFERENCE_SERVER_SUPPORTED
+    inferenceChannel::Segment segment;
+    int client = -1;
+
+    inline inferenceChannel::Slot &ring(int index) {
+        return segment.slot(client, index);
+    }
+
+    inline bool serverAlive() {
+        return segment.header->serverRunning.load(std::memory_order_acquire) != 0 &&
+               inferenceChannel::processAlive(segment.header->serverPid);
+    }
+
+    bool lost() {
+        if (connected.exchange(false)) {
+            std::cerr << "[InferenceClient] inference server stopped" << std::endl;
+        }
+        return false;
+    }
+
+    int tryAcquire() {
+        for (int i = 0; i < inferenceChannel::RING_SLOTS; ++i) {
+            uint32_t expected = inferenceChannel::FREE;
+            if (ring(i).state.compare_exchange_strong(expected, inferenceChannel::FILLING, std::memory_order_acquire)) {
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    void submit(inferenceChannel::Slot &slot, const uint8_t *mainChannels, const uint8_t *macroChannels, int count) {
+        std::memcpy(slot.mainChannels, mainChannels, static_cast<size_t>(count) * stateToChannels::MAIN_BYTES);
+        std::memcpy(slot.macroChannels, macroChannels, static_cast<size_t>(count) * stateToChannels::MACRO_BYTES);
+        slot.count = static_cast<uint32_t>(count);
+        slot.submitNs = inferenceChannel::nowNs();
+        slot.state.store(inferenceChannel::SUBMITTED, std::memory_order_release);
+        ringDoorbell();
+    }
+
+    void ringDoorbell() {
+        segment.header->doorbell.fetch_add(1, std::memory_order_release);
+        inferenceChannel::futexWakeAll(segment.header->doorbell);
+    }
+
+    /// Ждёт DONE на слове состояния; false — сервер умер или остановился раньше
+    bool waitDone(std::atomic<uint32_t> &state) {
+        while (true) {
+            const uint32_t current = state.load(std::memory_order_acquire);
+            if (current == inferenceChannel::DONE) {
+                return true;
+            }
+            inferenceChannel::futexWait(state, current, inferenceChannel::ALIVE_CHECK_NS);
+            if (state.load(std::memory_order_acquire) != inferenceChannel::DONE && !serverAlive()) {
+                return false;
+            }
+        }
+    }
+
+    /// Ячейки прежнего владельца кольца -> FREE
+    bool reclaimRing() {
+        for (int i = 0; i < inferenceChannel::RING_SLOTS; ++i) {
+            if (!reclaimState(ring(i).state)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /// Ячейка или область обучения умершего владельца -> FREE; взятая сервером (RUNNING) сначала дожидается DONE
+    bool reclaimState(std::atomic<uint32_t> &state) {
+        while (true) {
+            uint32_t current = state.load(std::memory_order_acquire);
+            if (current == inferenceChannel::FREE) {
+                return true;
+            }
+            if (current == inferenceChannel::RUNNING) {
+                inferenceChannel::futexWait(state, current, inferenceChannel::ALIVE_CHECK_NS);
+                if (!serverAlive()) {
+                    return false;
+                }
+                continue;
+            }
+            if (state.compare_exchange_strong(current, inferenceChannel::FREE)) {
+                return true;
+            }
+        }
+    }
+#endif
+};
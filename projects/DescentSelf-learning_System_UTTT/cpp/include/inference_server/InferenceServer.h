@@ -0,0 +1,300 @@
+// InferenceServer.h
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "inference_server/InferenceChannel.h"
+#include "shared_memory/SharedMemory.h"
+
+/**
+ * @brief Гистограмма по степеням двойки: корзина b — значения [2^(b-1), 2^b), корзина 0 — нули.
+ */
+class Log2Histogram {
+public:
+    void add(uint64_t value) {
+        ++buckets[std::min<int>(std::bit_width(value), BUCKETS - 1)];
+        ++count;
+        sum += value;
+    }
+
+    inline uint64_t samples() const {
+        return count;
+    }
+
+    void clear() {
+        buckets.fill(0);
+        count = 0;
+        sum = 0;
+    }
+
+    void print(std::ostream &out, const char *title, const char *unit) const {
+        out << "  " << title << " (" << unit << "), mean " << (count > 0 ? sum / count : 0) << ":\n";
+        const uint64_t peak = *std::max_element(buckets.begin(), buckets.end());
+        for (int b = 0; b < BUCKETS; ++b) {
+            if (buckets[b] == 0) {
+                continue;
+            }
+            const uint64_t low = b == 0 ? 0 : uint64_t{1} << (b - 1);
+            const uint64_t high = b == 0 ? 1 : uint64_t{1} << b;
+            out << "    [" << std::setw(7) << low << ", " << std::setw(7) << high << ") " << std::setw(8) << buckets[b]
+                    << ' ' << std::string(static_cast<size_t>(BAR * buckets[b] / peak), '#') << '\n';
+        }
+    }
+
+private:
+    static constexpr int BUCKETS = 33;
+    static constexpr uint64_t BAR = 40;
+    std::array<uint64_t, BUCKETS> buckets{};
+    uint64_t count = 0;
+    uint64_t sum = 0;
+};
+
+#if INFERENCE_SERVER_SUPPORTED
+/**
+ * @brief Одна модель на несколько self-play процессов: запросы клиентов (InferenceClient) из колец
+ *        общей памяти объединяются в батч и оцениваются одним вызовом SharedMemory::Evaluate().
+ *
+ * Батч отправляется, когда в нём maxBatch состояний или когда старейший запрос прождал deadlineUs:
+ * меньший дедлайн — меньше задержка клиента, больший — крупнее батчи и лучше загрузка сети.
+ * Выборки обучения клиентов обучают ту же модель (SharedMemory::Learn()) между батчами.
+ * Все вызовы SharedMemory — из потока run(), как в однопроцессном Descent.
+ */
+class InferenceServer {
+public:
+    /**
+     * @param maxBatch       Состояний в батче (не больше sampleLength буферов SharedMemory)
+     * @param deadlineUs     Ожидание наполнения батча после старейшего запроса
+     * @param reportSeconds  Период отчёта в std::cout (0 — без отчёта)
+     */
+    InferenceServer(SharedMemory &sharedMemory, int maxBatch, int deadlineUs, int reportSeconds)
+        : sharedMem(sharedMemory),
+          maxBatch(std::clamp<int>(maxBatch, inferenceChannel::SLOT_STATES, static_cast<int>(sharedMemory.sampleLength))),
+          deadlineNs(static_cast<uint64_t>(deadlineUs) * 1000),
+          reportNs(static_cast<uint64_t>(reportSeconds) * 1'000'000'000) {
+        batch.reserve(inferenceChannel::MAX_CLIENTS * inferenceChannel::RING_SLOTS);
+    }
+
+    /**
+     * @param learnCapacity  Наибольшая выборка обучения клиента (не больше sampleLength)
+     */
+    bool open(const std::string &name, uint32_t learnCapacity) {
+        learnCapacity = std::min<uint32_t>(learnCapacity, static_cast<uint32_t>(sharedMem.sampleLength));
+        if (!segment.create(name, learnCapacity)) {
+            return false;
+        }
+        segment.header->serverRunning.store(1, std::memory_order_release);
+        std::cout << "[InferenceServer] serving " << name << ": batch up to " << maxBatch << " states, deadline "
+                << deadlineNs / 1000 << " us, learn sample up to " << learnCapacity << " states" << std::endl;
+        return true;
+    }
+
+    /// Обслуживает клиентов до requestStop()
+    void run() {
+        inferenceChannel::Header &header = *segment.header;
+        lastReportNs = inferenceChannel::nowNs();
+        lastOwnerCheckNs = lastReportNs;
+        while (!stopRequested().load(std::memory_order_relaxed)) {
+            if (header.learnState.load(std::memory_order_acquire) == inferenceChannel::SUBMITTED) {
+                serveLearn();
+            }
+            if (inferenceChannel::nowNs() - lastOwnerCheckNs >= inferenceChannel::ALIVE_CHECK_NS) {
+                lastOwnerCheckNs = inferenceChannel::nowNs();
+                reclaimLearn();
+            }
+            uint32_t seen = header.doorbell.load(std::memory_order_acquire);
+            collect();
+            if (batch.empty()) {
+                inferenceChannel::futexWait(header.doorbell, seen, inferenceChannel::ALIVE_CHECK_NS);
+            } else {
+                // Ждём запросы других клиентов, пока батч не полон и дедлайн старейшего не наступил
+                while (batchStates < maxBatch) {
+                    const uint64_t now = inferenceChannel::nowNs();
+                    if (now >= oldestSubmitNs + deadlineNs) {
+                        break;
+                    }
+                    inferenceChannel::futexWait(header.doorbell, seen, oldestSubmitNs + deadlineNs - now);
+                    seen = header.doorbell.load(std::memory_order_acquire);
+                    collect();
+                }
+                runBatch();
+            }
+            if (reportNs > 0 && inferenceChannel::nowNs() - lastReportNs >= reportNs) {
+                report();
+            }
+        }
+        shutdown();
+    }
+
+    /// Остановка run() из обработчика сигнала или другого потока
+    static void requestStop() {
+        stopRequested().store(true, std::memory_order_relaxed);
+    }
+
+private:
+    SharedMemory &sharedMem;
+    const int maxBatch;
+    const uint64_t deadlineNs;
+    const uint64_t reportNs;
+    inferenceChannel::Segment segment;
+
+    std::vector<inferenceChannel::Slot *> batch; // ячейки в состоянии RUNNING
+    int batchStates = 0;
+    uint64_t oldestSubmitNs = 0;
+    int nextClient = 0; // с кого начинается обход колец: клиенты по очереди первыми попадают в полный батч
+
+    Log2Histogram batchSizes;
+    Log2Histogram queueWaitUs;
+    Log2Histogram inferenceUs;
+    uint64_t reportStates = 0;
+    uint64_t lastReportNs = 0;
+    uint64_t lastOwnerCheckNs = 0;
+
+    static std::atomic<bool> &stopRequested() {
+        static std::atomic<bool> flag{false};
+        return flag;
+    }
+
+    /// Забирает поданные ячейки всех клиентов (SUBMITTED -> RUNNING), пока батч не полон
+    void collect() {
+        for (int c = 0; c < inferenceChannel::MAX_CLIENTS; ++c) {
+            const int client = (nextClient + c) % inferenceChannel::MAX_CLIENTS;
+            for (int i = 0; i < inferenceChannel::RING_SLOTS; ++i) {
+                inferenceChannel::Slot &slot = segment.slot(client, i);
+                if (slot.state.load(std::memory_order_acquire) != inferenceChannel::SUBMITTED) {
+                    continue;
+                }
+                if (batchStates + static_cast<int>(slot.count) > maxBatch) {
+                    return; // остаётся для следующего батча
+                }
+                uint32_t expected = inferenceChannel::SUBMITTED;
+                if (!slot.state.compare_exchange_strong(expected, inferenceChannel::RUNNING, std::memory_order_acquire)) {
+                    continue; // кольцо умершего клиента освобождает новый владелец
+                }
+                if (batch.empty() || slot.submitNs < oldestSubmitNs) {
+                    oldestSubmitNs = slot.submitNs;
+                }
+                batch.push_back(&slot);
+                batchStates += static_cast<int>(slot.count);
+            }
+        }
+    }
+
+    void runBatch() {
+        const uint64_t startNs = inferenceChannel::nowNs();
+        int offset = 0;
+        for (inferenceChannel::Slot *slot: batch) {
+            std::memcpy(sharedMem.sampleMainChannels + static_cast<size_t>(offset) * stateToChannels::MAIN_BYTES,
+                        slot->mainChannels, static_cast<size_t>(slot->count) * stateToChannels::MAIN_BYTES);
+            std::memcpy(sharedMem.sampleMacroChannels + static_cast<size_t>(offset) * stateToChannels::MACRO_BYTES,
+                        slot->macroChannels, static_cast<size_t>(slot->count) * stateToChannels::MACRO_BYTES);
+            queueWaitUs.add((startNs - std::min(slot->submitNs, startNs)) / 1000);
+            offset += static_cast<int>(slot->count);
+        }
+        sharedMem.intVars[0] = batchStates;
+        sharedMem.intVars[SharedMemory::evaluateOffsetVar] = 0;
+        sharedMem.Evaluate();
+
+        const uint32_t version = segment.header->weightsVersion.load(std::memory_order_relaxed);
+        offset = 0;
+        for (inferenceChannel::Slot *slot: batch) {
+            std::memcpy(slot->values, sharedMem.sampleValues + offset, slot->count * sizeof(float));
+            slot->weightsVersion = version;
+            offset += static_cast<int>(slot->count);
+            slot->state.store(inferenceChannel::DONE, std::memory_order_release);
+            inferenceChannel::futexWakeAll(slot->state);
+        }
+        inferenceUs.add((inferenceChannel::nowNs() - startNs) / 1000);
+        batchSizes.add(static_cast<uint64_t>(batchStates));
+        reportStates += static_cast<uint64_t>(batchStates);
+        batch.clear();
+        batchStates = 0;
+        nextClient = (nextClient + 1) % inferenceChannel::MAX_CLIENTS;
+    }
+
+    void serveLearn() {
+        inferenceChannel::Header &header = *segment.header;
+        uint32_t expected = inferenceChannel::SUBMITTED;
+        if (!header.learnState.compare_exchange_strong(expected, inferenceChannel::RUNNING, std::memory_order_acquire)) {
+            return;
+        }
+        const uint32_t count = std::min(header.learnCount, header.learnCapacity);
+        std::memcpy(sharedMem.sampleValues, segment.learnValues, count * sizeof(float));
+        std::memcpy(sharedMem.sampleMainChannels, segment.learnMainChannels,
+                    static_cast<size_t>(count) * stateToChannels::MAIN_BYTES);
+        std::memcpy(sharedMem.sampleMacroChannels, segment.learnMacroChannels,
+                    static_cast<size_t>(count) * stateToChannels::MACRO_BYTES);
+        sharedMem.intVars[0] = static_cast<int>(count);
+        sharedMem.Learn();
+        const uint32_t version = header.weightsVersion.fetch_add(1, std::memory_order_release) + 1;
+        header.learnState.store(inferenceChannel::DONE, std::memory_order_release);
+        inferenceChannel::futexWakeAll(header.learnState);
+        std::cout << "[InferenceServer] learned on " << count << " states, weights version " << version << std::endl;
+    }
+
+    /// Область обучения, которую занял и не вернул умерший клиент, снова FREE: иначе обучение встанет у всех
+    void reclaimLearn() {
+        inferenceChannel::Header &header = *segment.header;
+        int32_t owner = header.learnOwner.load(std::memory_order_acquire);
+        if (owner == 0 || inferenceChannel::processAlive(owner)) {
+            return;
+        }
+        // Сервер сам занимает область на время сброса, чтобы не столкнуться с клиентом, сбрасывающим её же
+        if (!header.learnOwner.compare_exchange_strong(owner, header.serverPid)) {
+            return;
+        }
+        // RUNNING у области бывает только внутри serveLearn() этого же потока
+        header.learnState.store(inferenceChannel::FREE, std::memory_order_release);
+        header.learnOwner.store(0, std::memory_order_release);
+        inferenceChannel::futexWakeAll(header.learnState);
+        std::cout << "[InferenceServer] learn area of dead client " << owner << " reclaimed" << std::endl;
+    }
+
+    void report() {
+        const uint64_t now = inferenceChannel::nowNs();
+        const double seconds = static_cast<double>(now - lastReportNs) * 1e-9;
+        int clients = 0;
+        for (int c = 0; c < inferenceChannel::MAX_CLIENTS; ++c) {
+            clients += segment.header->clientPids[c].load(std::memory_order_relaxed) != 0;
+        }
+        std::cout << "[InferenceServer] " << clients << " clients, " << batchSizes.samples() << " batches, "
+                << static_cast<uint64_t>(static_cast<double>(reportStates) / seconds) << " states/s\n";
+        if (batchSizes.samples() > 0) {
+            batchSizes.print(std::cout, "batch size", "states");
+            queueWaitUs.print(std::cout, "queue wait", "us");
+            inferenceUs.print(std::cout, "inference", "us");
+        }
+        std::cout.flush();
+        batchSizes.clear();
+        queueWaitUs.clear();
+        inferenceUs.clear();
+        reportStates = 0;
+        lastReportNs = now;
+    }
+
+    /// Клиенты, ждущие ячейки или обучения, сразу видят остановку и переходят на свою модель
+    void shutdown() {
+        inferenceChannel::Header &header = *segment.header;
+        header.serverRunning.store(0, std::memory_order_release);
+        for (int c = 0; c < inferenceChannel::MAX_CLIENTS; ++c) {
+            for (int i = 0; i < inferenceChannel::RING_SLOTS; ++i) {
+                inferenceChannel::futexWakeAll(segment.slot(c, i).state);
+            }
+        }
+        inferenceChannel::futexWakeAll(header.learnState);
+        if (reportNs > 0) {
+            report();
+        }
+        segment.close();
+        std::cout << "[InferenceServer] stopped" << std::endl;
+    }
+};
+#endif
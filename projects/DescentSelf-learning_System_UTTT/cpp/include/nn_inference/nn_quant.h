@@ -0,0 +1,215 @@
+// nn_quant.h
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#if defined(__AVX2__) || defined(__AVX512VNNI__) || defined(__AVXVNNI__)
+#include <immintrin.h>
+#endif
+
+#include "nn_inference/nn_kernels.h"
+
+/**
+ * @brief Линейный слой int8 для ValueNet: веса int8 с масштабом на выходной столбец,
+ *        входы uint8 с масштабом и нулевой точкой слоя (из калибровки), накопление int32.
+ *
+ * y[o] = (Σ_k qx[k] * qw[k][o] - zero * Σ_k qw[k][o]) * inputScale * weightScale[o] + bias[o].
+ * Умножение u8 × s8 четвёрками k: vpdpbusd (AVX-512 VNNI, AVX-VNNI) или pmaddubsw + pmaddwd (AVX2).
+ * pmaddubsw насыщает сумму пары в int16, поэтому без VNNI входы ограничены 7 битами.
+ */
+namespace nnQuant {
+#if (defined(__AVX512VNNI__) && defined(__AVX512F__)) || defined(__AVXVNNI__)
+    constexpr int ACTIVATION_MAX = 255;
+#else
+    constexpr int ACTIVATION_MAX = 127; ///< 2 * 127 * 127 < 32767: сумма пары в pmaddubsw не насыщается
+#endif
+    constexpr int WEIGHT_MAX = 127;
+    constexpr int K_GROUP = 4; ///< Байт входа на одну 32-битную дорожку
+    constexpr int PANEL = nnKernels::PANEL;
+    constexpr int GROUP_BYTES = PANEL * K_GROUP; ///< Веса панели для одной четвёрки k
+    constexpr int ROW_BLOCK = 4;
+
+    struct QuantLinear {
+        bool enabled = false;
+        int in = 0;
+        int out = 0;
+        int groups = 0; ///< Четвёрок k (in дополнен до кратного 4)
+        int panels = 0;
+        std::vector<int8_t> weights; ///< [panel][group][16 столбцов][4 k]
+        std::vector<int32_t> columnSums; ///< Σ_k qw[k][o] — поправка на нулевую точку входа
+        std::vector<float> weightScale;
+        std::vector<float> bias;
+        float inputScale = 1.0f;
+        int zeroPoint = 0;
+
+        /**
+         * @param inputMin, inputMax  Диапазон входа слоя на калибровочных состояниях:
+         *                            неотрицательный (после ReLU) — нулевая точка 0, иначе — середина шкалы
+         */
+        void assign(const nnKernels::Linear &layer, float inputMin, float inputMax) {
+            enabled = true;
+            in = layer.in;
+            out = layer.out;
+            groups = (in + K_GROUP - 1) / K_GROUP;
+            panels = layer.panels;
+            weights.assign(static_cast<size_t>(panels) * groups * GROUP_BYTES, 0);
+            columnSums.assign(static_cast<size_t>(panels) * PANEL, 0);
+            weightScale.assign(static_cast<size_t>(panels) * PANEL, 0.0f);
+            bias.assign(layer.biasData(), layer.biasData() + static_cast<size_t>(panels) * PANEL);
+
+            for (int o = 0; o < out; ++o) {
+                const int panel = o / PANEL;
+                const int column = o % PANEL;
+                const float *source = layer.weightData() + static_cast<size_t>(panel) * in * PANEL + column;
+                float maxAbs = 0.0f;
+                for (int k = 0; k < in; ++k) {
+                    maxAbs = std::max(maxAbs, std::abs(source[static_cast<size_t>(k) * PANEL]));
+                }
+                const float scale = maxAbs > 0.0f ? maxAbs / WEIGHT_MAX : 1.0f;
+                weightScale[o] = scale;
+                for (int k = 0; k < in; ++k) {
+                    int q = static_cast<int>(std::lround(source[static_cast<size_t>(k) * PANEL] / scale));
+                    q = std::clamp(q, -WEIGHT_MAX, WEIGHT_MAX);
+                    weights[(static_cast<size_t>(panel) * groups + k / K_GROUP) * GROUP_BYTES + column * K_GROUP + k % K_GROUP] =
+                            static_cast<int8_t>(q);
+                    columnSums[o] += q;
+                }
+            }
+
+            if (inputMin >= 0.0f) {
+                zeroPoint = 0;
+                inputScale = inputMax > 0.0f ? inputMax / ACTIVATION_MAX : 1.0f;
+            } else {
+                zeroPoint = (ACTIVATION_MAX + 1) / 2;
+                const float range = std::max(-inputMin, inputMax);
+                inputScale = range > 0.0f ? range / (ACTIVATION_MAX - zeroPoint) : 1.0f;
+            }
+        }
+    };
+
+    /// Строки x [rows][in] -> qx [rows][groups * 4] (хвост строки — нулевая точка: веса там нулевые)
+    inline void quantizeRows(const QuantLinear &layer, const float *x, int rows, uint8_t *qx) {
+        const float inverse = 1.0f / layer.inputScale;
+        const int stride = layer.groups * K_GROUP;
+        for (int r = 0; r < rows; ++r) {
+            const float *row = x + static_cast<size_t>(r) * layer.in;
+            uint8_t *dst = qx + static_cast<size_t>(r) * stride;
+            for (int k = 0; k < layer.in; ++k) {
+                const int q = static_cast<int>(std::lrintf(row[k] * inverse)) + layer.zeroPoint;
+                dst[k] = static_cast<uint8_t>(std::clamp(q, 0, ACTIVATION_MAX));
+            }
+            std::memset(dst + layer.in, layer.zeroPoint, stride - layer.in);
+        }
+    }
+
+    /// rows строк qx -> acc [rows][16] (int32) по одной панели
+    template<int rows>
+    inline void panelBlock(const uint8_t *qx, int stride, int groups, const int8_t *panel, int32_t *acc) {
+#if defined(__AVX512VNNI__) && defined(__AVX512F__)
+        __m512i sum[rows];
+        for (int r = 0; r < rows; ++r) {
+            sum[r] = _mm512_setzero_si512();
+        }
+        for (int g = 0; g < groups; ++g) {
+            const __m512i w = _mm512_loadu_si512(panel + g * GROUP_BYTES);
+            for (int r = 0; r < rows; ++r) {
+                int32_t quad;
+                std::memcpy(&quad, qx + static_cast<size_t>(r) * stride + g * K_GROUP, sizeof(quad));
+                sum[r] = _mm512_dpbusd_epi32(sum[r], _mm512_set1_epi32(quad), w);
+            }
+        }
+        for (int r = 0; r < rows; ++r) {
+            _mm512_storeu_si512(acc + r * PANEL, sum[r]);
+        }
+#elif defined(__AVX2__)
+        __m256i sum[rows][2];
+        for (int r = 0; r < rows; ++r) {
+            sum[r][0] = _mm256_setzero_si256();
+            sum[r][1] = _mm256_setzero_si256();
+        }
+#if !defined(__AVXVNNI__)
+        const __m256i ones = _mm256_set1_epi16(1);
+#endif
+        for (int g = 0; g < groups; ++g) {
+            const __m256i w0 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(panel + g * GROUP_BYTES));
+            const __m256i w1 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(panel + g * GROUP_BYTES + 32));
+            for (int r = 0; r < rows; ++r) {
+                int32_t quad;
+                std::memcpy(&quad, qx + static_cast<size_t>(r) * stride + g * K_GROUP, sizeof(quad));
+                const __m256i a = _mm256_set1_epi32(quad);
+#if defined(__AVXVNNI__)
+                sum[r][0] = _mm256_dpbusd_avx_epi32(sum[r][0], a, w0);
+                sum[r][1] = _mm256_dpbusd_avx_epi32(sum[r][1], a, w1);
+#else
+                sum[r][0] = _mm256_add_epi32(sum[r][0], _mm256_madd_epi16(_mm256_maddubs_epi16(a, w0), ones));
+                sum[r][1] = _mm256_add_epi32(sum[r][1], _mm256_madd_epi16(_mm256_maddubs_epi16(a, w1), ones));
+#endif
+            }
+        }
+        for (int r = 0; r < rows; ++r) {
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(acc + r * PANEL), sum[r][0]);
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(acc + r * PANEL + 8), sum[r][1]);
+        }
+#else
+        std::memset(acc, 0, rows * PANEL * sizeof(int32_t));
+        for (int g = 0; g < groups; ++g) {
+            const int8_t *w = panel + g * GROUP_BYTES;
+            for (int r = 0; r < rows; ++r) {
+                const uint8_t *a = qx + static_cast<size_t>(r) * stride + g * K_GROUP;
+                for (int j = 0; j < PANEL; ++j) {
+                    for (int t = 0; t < K_GROUP; ++t) {
+                        acc[r * PANEL + j] += a[t] * w[j * K_GROUP + t];
+                    }
+                }
+            }
+        }
+#endif
+    }
+
+    /**
+     * @brief y [rows][out] = x [rows][in] · W + b в int8; scratch — буфер квантованных строк
+     */
+    inline void linear(const QuantLinear &layer, const float *x, int rows, float *y, std::vector<uint8_t> &scratch) {
+        const int stride = layer.groups * K_GROUP;
+        if (scratch.size() < static_cast<size_t>(rows) * stride) {
+            scratch.resize(static_cast<size_t>(rows) * stride);
+        }
+        quantizeRows(layer, x, rows, scratch.data());
+
+        alignas(64) int32_t acc[ROW_BLOCK * PANEL];
+        for (int p = 0; p < layer.panels; ++p) {
+            const int8_t *panel = &layer.weights[static_cast<size_t>(p) * layer.groups * GROUP_BYTES];
+            const int columns = std::min(PANEL, layer.out - p * PANEL);
+            float scale[PANEL];
+            float offset[PANEL];
+            for (int j = 0; j < columns; ++j) {
+                const int o = p * PANEL + j;
+                scale[j] = layer.inputScale * layer.weightScale[o];
+                offset[j] = layer.bias[o] - static_cast<float>(layer.zeroPoint) * layer.columnSums[o] * scale[j];
+            }
+            for (int r = 0; r < rows; r += ROW_BLOCK) {
+                const int block = std::min(ROW_BLOCK, rows - r);
+                const uint8_t *qr = scratch.data() + static_cast<size_t>(r) * stride;
+                switch (block) {
+                    case 4: panelBlock<4>(qr, stride, layer.groups, panel, acc);
+                        break;
+                    case 3: panelBlock<3>(qr, stride, layer.groups, panel, acc);
+                        break;
+                    case 2: panelBlock<2>(qr, stride, layer.groups, panel, acc);
+                        break;
+                    default: panelBlock<1>(qr, stride, layer.groups, panel, acc);
+                }
+                for (int i = 0; i < block; ++i) {
+                    float *dst = y + static_cast<size_t>(r + i) * layer.out + p * PANEL;
+                    for (int j = 0; j < columns; ++j) {
+                        dst[j] = static_cast<float>(acc[i * PANEL + j]) * scale[j] + offset[j];
+                    }
+                }
+            }
+        }
+    }
+}
@@ -1,5 +1,9 @@
 // parameters.h
 #pragma once
+
+#include <cstddef>
+#include <random>
+
 namespace params {
     constexpr int REPLAY_BUFFER_MAX_SIZE = 800000; //(µ)
     // constexpr double SAMPLING_RATE = 0.1; //(σ)
@@ -9,4 +13,23 @@ namespace params {
     constexpr float MOVE_TIME_LIMIT = 1.0f; //sec
     //----------------------
     constexpr int DESCENT_ITERATION_COUNT = 100; //сколько раз повторять descentIteration
+    constexpr int DESCENT_THREADS = 1; //число потоков, спускающихся от одного корня (1 = последовательный Descent)
+    constexpr float VIRTUAL_LOSS = 0.1f; //виртуальный штраф v'(s,a) за каждый поток, идущий через (s,a)
+    constexpr int DESCENT_ASYNC_ITERATIONS = 0; //>0: столько итераций одновременно ждут общего батча NN (асинхронный Descent); ~256 даёт батчи ~2000
+    constexpr int ASYNC_BATCH_SIZE = 2048; //целевой размер общего батча в асинхронном режиме
+    constexpr int ASYNC_EVALUATION_BUFFERS = 1; //>1: батч асинхронного режима оценивается в потоке SharedMemory, пока наполняется следующий (2 — двойная, 3 — тройная буферизация)
+    constexpr int SELF_PLAY_GAMES = 1; //>1: столько партий самоигры идут одновременно с общим батчем NN (SelfPlayPool); ход пула — SELF_PLAY_GAMES * MOVE_TIME_LIMIT
+    constexpr int POOL_ASYNC_ITERATIONS = 32; //итераций в ожидании батча на одну партию SelfPlayPool
+    constexpr std::size_t EVALUATION_CACHE_MB = 256; //память под кеш оценок сети между ходами и партиями (0 = без кеша)
+    constexpr int CONVERT_THREADS = 0; //потоков конвертации состояний в каналы сети (выборка обучения, батчи LeafBatch); 0 = по числу ядер
+    constexpr int CONVERT_MIN_CHUNK = 256; //меньше состояний на поток конвертируются в вызывающем потоке
+    constexpr bool NATIVE_EVALUATOR = false; //true: сеть оценивается на C++ (nn_inference/ValueNet.h) без вызова Python; веса выгружаются из Python после каждого Learn()
+    constexpr const char *NATIVE_WEIGHTS_PATH = "model_native.weights.bin"; //файл весов для NATIVE_EVALUATOR (формат native_export.py)
+    constexpr int NATIVE_INT8_CALIBRATION_STATES = 0; //>0: NATIVE_EVALUATOR считает в int8, калибруясь после каждого Learn() на стольких состояниях выборки
+    constexpr int NATIVE_INT8_HELDOUT_STATES = 256; //следующие состояния выборки — отчёт о расхождении int8 и FP32
+    constexpr bool INFERENCE_CLIENT = false; //true: оценка и обучение — в процессе InferenceServer (одна модель на несколько self-play процессов, только Linux)
+    constexpr const char *INFERENCE_SERVER_NAME = "/descent_inference"; //имя сегмента POSIX shm сервера
+    constexpr int INFERENCE_SERVER_MAX_BATCH = 4096; //состояний в одном батче сервера
+    constexpr int INFERENCE_SERVER_DEADLINE_US = 2000; //сколько старейший запрос ждёт, пока батч наполняется запросами других клиентов
+    constexpr int INFERENCE_SERVER_REPORT_SECONDS = 30; //период отчёта сервера (размеры батчей, ожидание в очереди)
 }
@@ -1,11 +1,12 @@
 // BatchEvaluator.h
 #pragma once
 
+#include <atomic>
 #include <cstdint>
+#include <mutex>
 #include "big_board/BigBoard.h"       // BigBoard
 #include "shared_memory/SharedMemory.h"
 #include "state_to_nn_representation/state_to_channels.h"
-#include "structures/Map_T.h"         // Map_T
 
 /**
  * @brief Класс для пакетной оценки нетерминальных состояний одним вызовом нейросети.
@@ -16,26 +17,42 @@ public:
 
 private:
     SharedMemory &sharedMem; ///< Ссылка на общий буфер (sampleMainChannels, sampleValues, и т.д.)
-    Map_T &V; ///< Ссылка на карту v(s) и v'(s,a)
     int movesCount; ///< Текущее число записей в батче
+    /**
+     * Смещение (в состояниях) собственного участка в общем буфере.
+     * У каждого потока Descent свой участок [offset, offset + MAX_SIZE),
+     * поэтому конвертация идёт без блокировок, а под evaluateMutex — только вызов сети
+     * (ValueNet считает и без него, на буферах активаций scratch).
+     */
+    int offset;
+    ValueNet::Scratch scratch; ///< Буферы активаций ValueNet этого потока
 
     /**
-     * Массив ходов (move), по которым будем потом
-     * присваивать значения v'(parentState, move).
+     * Ячейки v'(parentState, a) в записи SearchNode родителя,
+     * куда будем потом присваивать оценки.
      * Индекс i соответствует i-му добавленному состоянию.
      */
-    uint8_t moves[MAX_SIZE];
+    std::atomic<float> *targets[MAX_SIZE];
+    uint64_t keys[MAX_SIZE]; ///< canonicalKey i-го состояния — для записи в EvaluationCache
+
+    /**
+     * Состояния, оценка которых нашлась в EvaluationCache: в сеть не передаются.
+     */
+    int cachedCount;
+    std::atomic<float> *cachedTargets[MAX_SIZE];
+    float cachedValues[MAX_SIZE];
 
 public:
     /**
      * @brief Конструктор
      * @param shm   - ссылка на уже созданный SharedMemory (глобальный на всё приложение)
-     * @param mapV  - ссылка на Map_T (хранит v(s), v'(s,a))
+     * @param slot  - номер потока Descent (определяет участок общего буфера)
      */
-    BatchEvaluator(SharedMemory &shm, Map_T &mapV)
+    explicit BatchEvaluator(SharedMemory &shm, int slot = 0)
         : sharedMem(shm)
-          , V(mapV)
-          , movesCount(0) {
+          , movesCount(0)
+          , offset(slot * MAX_SIZE)
+          , cachedCount(0) {
     }
 
     /**
@@ -45,22 +62,35 @@ public:
      */
     inline void beginBatch() {
         movesCount = 0;
+        cachedCount = 0;
     }
 
     /**
      * @brief Добавляем нетерминальное состояние (child) в общий буфер.
+     *        Если оценка уже есть в EvaluationCache, сеть для него не вызывается.
+     * @param target - ячейка v'(parentState, a) для оценки child = a(parentState)
      */
-    inline void addNonTerminalState(const BigBoard &childBoard, uint8_t move) {
+    inline void addNonTerminalState(const BigBoard &childBoard, std::atomic<float> *target) {
+        // (0) Оценка могла остаться с прошлых ходов или партий
+        float cachedValue;
+        if (sharedMem.evaluationCache.lookup(childBoard.canonicalKey, cachedValue)) {
+            cachedTargets[cachedCount] = target;
+            cachedValues[cachedCount] = cachedValue;
+            cachedCount++;
+            return;
+        }
+
         // (1) Найдём адрес, куда писать каналы для i-го child
         const int i = movesCount;
-        uint8_t *dstMain = sharedMem.sampleMainChannels + (std::size_t) i * (9 * 9 * 6);
-        uint8_t *dstMacro = sharedMem.sampleMacroChannels + (std::size_t) i * (3 * 3 * 2);
+        uint8_t *dstMain = sharedMem.sampleMainChannels + (std::size_t) (offset + i) * stateToChannels::MAIN_BYTES;
+        uint8_t *dstMacro = sharedMem.sampleMacroChannels + (std::size_t) (offset + i) * stateToChannels::MACRO_BYTES;
 
         // (2) Конвертируем состояние BigBoard -> каналы
         stateToChannels::convert(&childBoard, dstMain, dstMacro);
 
-        // (3) Запоминаем ход
-        moves[i] = move;
+        // (3) Запоминаем ячейку v'(s,a) и ключ состояния
+        targets[i] = target;
+        keys[i] = childBoard.canonicalKey;
 
         // (4) Увеличиваем счётчик
         movesCount++;
@@ -68,18 +98,30 @@ public:
 
     /**
      * @brief Запустить нейросеть на всём батче добавленных состояний
-     *        и записать результаты в V(parentState, move).
+     *        и записать результаты в v'(parentState, a).
      */
     inline void evaluateAllNonTerminalChildStates(BigBoard *parentState) {
-        if (movesCount == 0) [[unlikely]] {
+        if (movesCount == 0 && cachedCount == 0) [[unlikely]] {
             return; // Нечего оценивать
         }
 
-        // (1) Сообщаем Python, сколько реально child-состояний
-        sharedMem.intVars[0] = movesCount;
+        const uint32_t weightsVersion = sharedMem.evaluationCache.weightsVersion(); // до вызова сети
+        if (movesCount > 0 && !sharedMem.evaluateConcurrently(offset, movesCount, scratch)) {
+            std::lock_guard<std::mutex> lock(sharedMem.evaluateMutex);
 
-        // (2) Запуск Evaluate() (один вызов)
-        sharedMem.Evaluate();
+            // (1) Сообщаем Python, сколько реально child-состояний и где они лежат
+            sharedMem.intVars[0] = movesCount;
+            sharedMem.intVars[SharedMemory::evaluateOffsetVar] = offset;
+
+            // (2) Запуск Evaluate() (один вызов)
+            sharedMem.EvaluateFromThread();
+        }
+        const float *values = sharedMem.sampleValues + offset;
+
+        // (3) Сохраняем выход сети (без учёта знака родителя) для следующих ходов и партий
+        for (int i = 0; i < movesCount; i++) {
+            sharedMem.evaluationCache.store(keys[i], values[i], weightsVersion);
+        }
 
         int parentPl = parentState->getCurrentPlayer();
 
@@ -87,21 +129,28 @@ public:
             // Если реальный ход X, то каналы без свапа,
             // сеть вернула + = "хорошо X", => можно напрямую писать
             for (int i = 0; i < movesCount; i++) {
-                float netVal = sharedMem.sampleValues[i];
+                float netVal = values[i];
                 // v'(s, a) = netVal
-                V(parentState, moves[i]) = netVal;
+                targets[i]->store(netVal, std::memory_order_relaxed);
+            }
+            for (int i = 0; i < cachedCount; i++) {
+                cachedTargets[i]->store(cachedValues[i], std::memory_order_relaxed);
             }
         } else {
             // Если реальный ход O, то каналы со свапом,
             // сеть вернула "+ = хорошо для 'X'(свапнутого)", но это реально "хорошо для O".
             // => нужно инвертировать знак, чтобы оставалось + = X в глобальных координатах
             for (int i = 0; i < movesCount; i++) {
-                float netVal = sharedMem.sampleValues[i];
-                V(parentState, moves[i]) = -netVal;
+                float netVal = values[i];
+                targets[i]->store(-netVal, std::memory_order_relaxed);
+            }
+            for (int i = 0; i < cachedCount; i++) {
+                cachedTargets[i]->store(-cachedValues[i], std::memory_order_relaxed);
             }
         }
 
         // (4) Сбрасываем movesCount
         movesCount = 0;
+        cachedCount = 0;
     }
 };
@@ -1,27 +1,57 @@
 // Descent.h
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <bitset>
 #include <chrono>
+#include <optional>
+#include <thread>
+#include <vector>
 
 #include "BatchEvaluator.h"
+#include "LeafBatch.h"
 #include "parameters.h"
 #include "structures/Set_S.h"
 #include "structures/Map_T.h"
 #include "big_board/BigBoard.h"
 #include "utils/Counter.h"
+#include "utils/value_kernels.h"
 
 
 class Descent {
 private:
-    long evaluatedStateCount;
+    std::atomic<long> evaluatedStateCount;
+
+    static_assert(params::SAMPLE_SIZE >= params::DESCENT_THREADS * BatchEvaluator::MAX_SIZE,
+                  "SharedMemory must hold one BatchEvaluator slot per Descent thread");
+    static_assert(params::DESCENT_ASYNC_ITERATIONS == 0 || params::DESCENT_THREADS == 1,
+                  "Async Descent drives all in-flight iterations from one thread");
 
 public:
     /**
      * @param s - ссылка на множество состояний (Set_S), в котором храним посещённые BigBoard
      * @param v - ссылка на Map_T, где храним v(s) и v'(s,a)
+     * @param asyncIterationCount - число одновременных итераций асинхронного режима (0 = выключен)
+     * @param threadCount - потоков, спускающихся от корня без асинхронного режима
+     *                      (не больше, чем участков BatchEvaluator в буферах SharedMemory);
+     *                      больше одного — только пока сеть считается в потоках (SharedMemory::canEvaluateConcurrently)
      */
-    Descent(Set_S &s, Map_T &v, SharedMemory &shm)
-        : S(s), V(v), counter(params::DESCENT_ITERATION_COUNT), batchEvaluator(shm, v) {
+    Descent(Set_S &s, Map_T &v, SharedMemory &shm, int asyncIterationCount = params::DESCENT_ASYNC_ITERATIONS,
+            int threadCount = params::DESCENT_THREADS)
+        : S(s), V(v), sharedMem(shm), counter(params::DESCENT_ITERATION_COUNT),
+          threads(std::clamp<int>(threadCount, 1, static_cast<int>(shm.sampleLength / BatchEvaluator::MAX_SIZE))),
+          leafBatch(shm, params::ASYNC_BATCH_SIZE),
+          asyncIterations(asyncIterationCount) {
+        batchEvaluators.reserve(threads);
+        for (int t = 0; t < threads; ++t) {
+            batchEvaluators.emplace_back(shm, t);
+        }
+        for (PendingIteration &it: asyncIterations) {
+            it.path.reserve(bigBoardArrays::movesSize + 1);
+            it.nodes.reserve(bigBoardArrays::movesSize);
+            it.children.reserve(bigBoardArrays::movesSize);
+        }
     }
 
     /**
@@ -29,6 +59,7 @@ public:
      *
      * @param board          - текущее состояние
      * @param moveTimeLimit  - лимит времени (в секундах) на совокупность итераций
+     * @return число завершённых итераций
      */
     // void descent(BigBoard *board, float moveTimeLimit) {
     //     resetTimer();
@@ -37,20 +68,45 @@ public:
     //     }
     // }
 
-    void descent(BigBoard *board, float moveTimeLimit) {
+    long descent(BigBoard *board, float moveTimeLimit) {
         // while (!counter.isCountExceeded()) {
         //     descentIteration(board);
         // }
+        prepareForMove();
+        timeLimit = moveTimeLimit;
         resetTimer();
-        int iterCount = 0;
+        std::atomic<long> iterCount = 0;
         evaluatedStateCount = 0;
-        while (!isTimeExceeded(params::MOVE_TIME_LIMIT)) {
-            descentIteration(board);
-            ++iterCount;
+        // Python и InferenceServer оценивают по одному раскрытию под evaluateMutex: остальные потоки только ждали бы
+        activeThreads = sharedMem.canEvaluateConcurrently() ? threads : 1;
+        if (activeThreads < threads && !warnedSerialEvaluator) {
+            warnedSerialEvaluator = true;
+            std::cerr << "[Descent] " << threads << " threads need the native evaluator, searching with one" << std::endl;
+        }
+
+        if (!asyncIterations.empty()) {
+            iterCount = descentAsync(board);
+        } else if (activeThreads == 1) {
+            runWorker(board, batchEvaluators[0], iterCount);
+        } else {
+            // Главный поток держит GIL; отпускаем его, чтобы рабочие потоки могли вызывать Evaluate()
+            py::gil_scoped_release releaseGil;
+            std::vector<std::thread> workers;
+            workers.reserve(activeThreads - 1);
+            for (int t = 1; t < activeThreads; ++t) {
+                workers.emplace_back([this, board, t, &iterCount] {
+                    runWorker(board, batchEvaluators[t], iterCount);
+                });
+            }
+            runWorker(board, batchEvaluators[0], iterCount);
+            for (std::thread &worker: workers) {
+                worker.join();
+            }
         }
         std::cout << "\niterations count = " << iterCount << std::endl;
         std::cout << "States NN evaluated = " << evaluatedStateCount << std::endl;
         std::cout << "Value: " << V(board) << std::endl;
+        return iterCount;
     }
 
     /**
@@ -74,112 +130,439 @@ public:
     *        v(s) ← v′(s, ab)
     *    return v(s)
      */
-    float descentIteration(BigBoard *state) {
-        // 1) Проверка на терминальность
-        if (state->isGameOver()) {
-            float score = state->getTerminalScore();
-            if (!S.contains(state))
-                S.add(state); // S ← S ∪ {s}
-            V(state) = score; // v(s) ← ft(s)
-            return score;
+    float descentIteration(const BigBoard *root, BatchEvaluator &batchEvaluator) {
+        // Спуск и раскрытие идут на одной рабочей доске: ход к ребёнку делается на месте
+        // (при раскрытии — с откатом undoMove), а для обратного прохода в стеке пути хватает записи узла, индекса ребёнка и игрока
+        BigBoard state = *root;
+        PathEdge path[bigBoardArrays::movesSize];
+        int depth = 0;
+        float value;
+
+        while (true) {
+            // 1) Проверка на терминальность
+            if (state.isGameOver()) {
+                value = state.getTerminalScore();
+                if (!S.contains(&state))
+                    S.add(&state); // S ← S ∪ {s}
+                V(&state) = value; // v(s) ← ft(s)
+                break;
+            }
+
+            // 2) Если s не в S, инициализируем v'(s,a).
+            //    Раскрывает только поток, первым занявший s; остальные ждут готовности v'(s,a).
+            SearchNode *node;
+            if (S.tryClaim(&state)) {
+                uint8_t actions[bigBoardArrays::movesSize];
+                node = createNode(&state, actions);
+
+                BigBoard::MoveUndo undo;
+                for (int i = 0; i < node->movesCount; ++i) { //foreach a ∈ actions(s)
+                    state.applyMove(actions[i], undo); // child = a(s) на месте s
+
+                    if (state.isGameOver()) {
+                        S.add(&state); // S ← S ∪ {a(s)}
+                        float termVal = state.getTerminalScore();
+                        node->childValues()[i] = termVal; // v′(s,a) ← ft(a(s))
+                        V(&state) = termVal; // v(a(s)) ← v′(s,a)
+                    } else {
+                        batchEvaluator.addNonTerminalState(state, &node->childValues()[i]); //v′(s, a) ← fθ(a(s))
+                        evaluatedStateCount++;
+                    }
+                    state.undoMove(undo);
+                }
+                batchEvaluator.evaluateAllNonTerminalChildStates(&state);
+                S.markReady(&state);
+            } else {
+                S.waitReady(&state);
+                node = V.findNode(&state);
+            }
+
+            // 3) ab ← best_action(s) и спуск в ab(s) (вместо рекурсивного вызова)
+            PathEdge &edge = path[depth++];
+            edge.node = node;
+            edge.isFirstPlayer = state.getCurrentPlayer() == cell::X;
+            edge.child = static_cast<uint8_t>(bestChildOf(edge.isFirstPlayer, node, true));
+            // Виртуальный штраф: другие потоки реже выбирают (s, ab), пока этот спускается по нему
+            node->inFlight()[edge.child].fetch_add(1, std::memory_order_relaxed);
+            state.applyMove(state.moveFromCanonical(node->moves()[edge.child]));
         }
 
-        // 2) Если s не в S, инициализируем v'(s,a)
-        if (!S.contains(state)) {
-            S.add(state);
+        // 4) Обратный проход от листа к корню
+        while (depth > 0) {
+            const PathEdge &edge = path[--depth];
+            SearchNode *node = edge.node;
+            node->childValues()[edge.child] = value; // v′(s, ab) ← descent_iteration(ab(s))
+            node->inFlight()[edge.child].fetch_sub(1, std::memory_order_relaxed);
+            value = node->childValues()[bestChildOf(edge.isFirstPlayer, node)]; // ab ← best_action(s) (повторный вызов)
+            node->value = value; // v(s) ← v′(s, ab)
+        }
+        return value; // return v(s)
+    }
 
-            uint8_t *moves = state->getValidMoves(); // все действия
+    /**
+     * Асинхронный Descent: DESCENT_ASYNC_ITERATIONS итераций идут одновременно.
+     * Каждая спускается, пока не дойдёт до нераскрытого узла, кладёт его детей в общий
+     * LeafBatch и приостанавливается (явное состояние продолжения — путь от корня).
+     * Когда батч набран, один вызов сети оценивает всех детей, и итерации продолжаются.
+     * С несколькими буферами LeafBatch сеть считает батч в потоке SharedMemory, а итерации,
+     * не ждущие его, тем временем набирают следующий.
+     *
+     * @return число завершённых итераций
+     */
+    long descentAsync(BigBoard *board) {
+        leafBatch.resetStats();
+        beginAsync(board);
+        std::optional<py::gil_scoped_release> releaseGil;
+        if (leafBatch.isPipelined()) {
+            releaseGil.emplace(); // GIL нужен потоку оценки SharedMemory
+        }
+        bool anyActive = true;
+        while (anyActive) {
+            bool stop = isTimeExceeded(timeLimit) || isSearchSaturated();
+            if (stop) {
+                leafBatch.flush();
+                completeAsyncBatch(leafBatch);
+                finishAsync();
+                break;
+            }
+            anyActive = advanceAsync(leafBatch, false);
+            leafBatch.evaluate();
+            completeAsyncBatch(leafBatch);
+        }
+        std::cout << "\nNN batches = " << leafBatch.calls()
+                << ", average batch size = " << leafBatch.averageSize() << std::endl;
+        return asyncCompleted;
+    }
 
-            int movesCount = moves[0];
-            for (int i = 1; i <= movesCount; ++i) {
-                uint8_t move = moves[i]; //foreach a ∈ actions(s)
+    /**
+     * @brief Однопоточная подготовка таблиц S/V к ходу (рост до начала параллельной фазы).
+     */
+    void prepareForMove() {
+        S.prepareForConcurrentPhase();
+        V.prepareForConcurrentPhase();
+    }
 
-                BigBoard stateAfterMove = *state; // child = a(s)
-                stateAfterMove.applyMove(move);
+    /**
+     * @brief Таблицы S/V заполнены до предела — новых узлов в этом ходу не раскрывать.
+     */
+    inline bool isSearchSaturated() const {
+        return S.isNearlyFull() || V.isNearlyFull();
+    }
+
+    /**
+     * @brief Сбрасывает приостановленные итерации на новый корень.
+     */
+    void beginAsync(const BigBoard *board) {
+        asyncCompleted = 0;
+        for (PendingIteration &it: asyncIterations) {
+            it.path.clear();
+            it.nodes.clear();
+            it.children.clear();
+            it.path.emplace_back(*board);
+            it.active = true;
+        }
+    }
 
-                if (stateAfterMove.isGameOver()) {
-                    S.add(&stateAfterMove); // S ← S ∪ {a(s)}
-                    float termVal = stateAfterMove.getTerminalScore();
-                    V(state, move) = termVal; // v′(s,a) ← ft(a(s))
-                    V(&stateAfterMove) = termVal; // v(a(s)) ← v′(s,a)
+    /**
+     * @brief Продвигает все итерации до приостановки (или завершения) и наполняет batch.
+     *
+     * Завершившаяся итерация сразу начинается заново от корня, если не stopStarting.
+     * Продвижение прекращается, когда в batch нет места ещё на один узел.
+     *
+     * @return есть ли ещё активные итерации
+     */
+    bool advanceAsync(LeafBatch &batch, bool stopStarting) {
+        bool anyActive = false;
+        const size_t n = asyncIterations.size();
+        // Начинаем с другой итерации каждый раунд, чтобы при заполнении батча никто не голодал
+        asyncCursor = (asyncCursor + 1) % n;
+        for (size_t j = 0; j < n; ++j) {
+            PendingIteration &it = asyncIterations[(asyncCursor + j) % n];
+            // Не больше одного завершения за раунд: когда дерево полностью раскрыто, итерации
+            // проходят без обращения к сети и иначе крутились бы здесь без проверки времени
+            if (it.active && batch.hasRoomForNode() && advance(it, batch)) {
+                ++asyncCompleted;
+                if (stopStarting) {
+                    it.active = false;
                 } else {
-                    batchEvaluator.addNonTerminalState(stateAfterMove, move); //v′(s, a) ← fθ(a(s))
-                    evaluatedStateCount++;
+                    it.path.resize(1); // снова от корня
                 }
             }
-            batchEvaluator.evaluateAllNonTerminalChildStates(state);
+            anyActive |= it.active;
+        }
+        return anyActive;
+    }
+
+    /**
+     * @brief Вызывается после batch.evaluate(): узлы, чьи дети уже оценены, становятся готовыми.
+     */
+    void completeAsyncBatch(const LeafBatch &batch) {
+        for (PendingIteration &it: asyncIterations) {
+            if (it.active && it.claimedLeaf && it.claimedBatch < batch.completedGeneration()) {
+                S.markReady(&it.path.back());
+                it.claimedLeaf = false;
+            }
         }
+    }
 
-        uint8_t bestMove = bestActionOf(state); // ab ← best_action(s)
-        {
-            BigBoard stateAfterBestMove = *state;
-            stateAfterBestMove.applyMove(bestMove);
-            // v′(s, ab) ← descent_iteration(ab(s))
-            V(state, bestMove) = descentIteration(&stateAfterBestMove);
+    /**
+     * @brief Останов по времени: значения уже раскрытых узлов поднимаются вверх по пути,
+     *        виртуальные штрафы снимаются. Вызывать только после batch.flush() и completeAsyncBatch().
+     */
+    void finishAsync() {
+        for (PendingIteration &it: asyncIterations) {
+            if (!it.active) {
+                continue;
+            }
+            // Узел, до которого итерация ещё не дошла (не в S), отбрасываем вместе с ребром
+            while (it.path.size() > 1 && !S.contains(&it.path.back())) {
+                it.path.pop_back();
+                it.nodes.back()->inFlight()[it.children.back()].fetch_sub(1, std::memory_order_relaxed);
+                it.nodes.pop_back();
+                it.children.pop_back();
+            }
+            BigBoard *leaf = &it.path.back();
+            if (S.contains(leaf) && !leaf->isGameOver()) {
+                SearchNode *node = V.findNode(leaf);
+                float value = node->childValues()[bestChildOf(leaf, node)];
+                node->value = value;
+                unwind(it, value);
+            }
+            it.active = false;
         }
+    }
 
-        uint8_t finalAction = bestActionOf(state); // ab ← best_action(s) (повторный вызов)
-        float finalVal = V(state, finalAction); // v(s) ← v′(s, ab)
-        V(state) = finalVal;
+    /// Итерации асинхронного режима, завершённые с beginAsync()
+    inline long asyncIterationsCompleted() const {
+        return asyncCompleted;
+    }
 
-        return finalVal; // return v(s)
+    /// Есть ли итерации, которые finishAsync() ещё не остановил
+    inline bool isAsyncActive() const {
+        for (const PendingIteration &it: asyncIterations) {
+            if (it.active) {
+                return true;
+            }
+        }
+        return false;
     }
 
     /**
      * Поиск лучшего действия (best_action) в зависимости от игрока.
      * Если текущий игрок X=0, то берём argmax,
      * если O=1, то argmin.
+     *
+     * Один проход по v'(s,a) записи узла, без обращений к хеш-таблице. В однопоточном
+     * Descent значения читаются векторно (valueKernels), при нескольких потоках — атомарно.
+     *
+     * @param withVirtualLoss - учитывать ли штраф за (s,a), по которым сейчас спускаются
+     *                          другие потоки (только при выборе пути спуска)
+     * @return индекс ребёнка в node (ход — state->moveFromCanonical(node->moves()[i]))
      */
-    inline uint8_t bestActionOf(BigBoard *state) {
+    inline int bestChildOf(const BigBoard *state, SearchNode *node, bool withVirtualLoss = false) {
         // Сразу определим, кто игрок (X=0 => maximize, O=1 => minimize)
-        const bool isFirstPlayer = (state->getCurrentPlayer() == cell::X);
+        return bestChildOf(state->getCurrentPlayer() == cell::X, node, withVirtualLoss);
+    }
 
-        const uint8_t *moves = state->getValidMoves();
-        const int movesCount = moves[0];
+    /**
+     * best_action по уже известному игроку узла — для обратного прохода, где самой позиции уже нет.
+     */
+    inline int bestChildOf(bool isFirstPlayer, SearchNode *node, bool withVirtualLoss = false) {
+        const bool applyPenalty = withVirtualLoss && (activeThreads > 1 || !asyncIterations.empty());
+
+        const int movesCount = node->movesCount;
+        if (activeThreads == 1) {
+            const float *values = node->childValuesUnsynchronized();
+            if (applyPenalty) {
+                const int32_t *inFlight = node->inFlightUnsynchronized();
+                return isFirstPlayer
+                           ? valueKernels::bestIndex<true>(values, inFlight, params::VIRTUAL_LOSS, movesCount)
+                           : valueKernels::bestIndex<false>(values, inFlight, params::VIRTUAL_LOSS, movesCount);
+            }
+            return isFirstPlayer
+                       ? valueKernels::bestIndex<true>(values, movesCount)
+                       : valueKernels::bestIndex<false>(values, movesCount);
+        }
 
-        // Адрес массива действий (пропускаем moves[0], где хранится movesCount)
-        const uint8_t *actions = moves + 1;
+        const std::atomic<float> *values = node->childValues();
+        const std::atomic<int32_t> *inFlight = node->inFlight();
 
         if (isFirstPlayer) {
             // Максимизируем v'(s,a)
             float bestVal = -1e9f;
-            uint8_t bestAction = actions[0];
+            int best = 0;
 
             for (int i = 0; i < movesCount; ++i) {
-                uint8_t action = actions[i];
-                float val = V(state, action); // v'(s,a)
+                float val = values[i].load(std::memory_order_relaxed); // v'(s,a)
+                if (applyPenalty) {
+                    val -= params::VIRTUAL_LOSS * inFlight[i].load(std::memory_order_relaxed);
+                }
                 if (val > bestVal) {
                     bestVal = val;
-                    bestAction = action;
+                    best = i;
                 }
             }
-            return bestAction;
+            return best;
         } else {
             // Минимизируем v'(s,a)
             float bestVal = 1e9f;
-            uint8_t bestAction = actions[0];
+            int best = 0;
 
             for (int i = 0; i < movesCount; ++i) {
-                uint8_t a = actions[i];
-                float val = V(state, a); // v'(s,a)
+                float val = values[i].load(std::memory_order_relaxed); // v'(s,a)
+                if (applyPenalty) {
+                    val += params::VIRTUAL_LOSS * inFlight[i].load(std::memory_order_relaxed);
+                }
                 if (val < bestVal) {
                     bestVal = val;
-                    bestAction = a;
+                    best = i;
                 }
             }
-            return bestAction;
+            return best;
         }
     }
 
 private:
     Set_S &S; ///< Хранилище уникальных состояний
     Map_T &V; ///< Карта оценок: v(s) и v'(s,a)
+    SharedMemory &sharedMem;
     Counter counter;
+    const int threads; ///< Потоков синхронного Descent
+    int activeThreads = 1; ///< Потоков текущего descent(): threads или 1, если сеть не считается в потоках
+    bool warnedSerialEvaluator = false;
+    float timeLimit = params::MOVE_TIME_LIMIT; ///< moveTimeLimit текущего descent()
     std::chrono::time_point<std::chrono::high_resolution_clock> startTime;
     /**
-     * @brief Экземпляр BatchEvaluator, позволяющий батч-оценку нетерминальных состояний
+     * @brief Экземпляры BatchEvaluator (по одному на поток), позволяющие батч-оценку нетерминальных состояний
+     */
+    std::vector<BatchEvaluator> batchEvaluators;
+
+    /**
+     * Приостановленная итерация асинхронного Descent (явное состояние продолжения).
+     * path[k+1] — ребёнок children[k] записи nodes[k] узла path[k];
+     * path.back() — узел, на котором итерация стоит.
+     */
+    struct PendingIteration {
+        std::vector<BigBoard> path;
+        std::vector<SearchNode *> nodes;
+        std::vector<uint8_t> children;
+        bool active = false;
+        bool claimedLeaf = false; ///< path.back() раскрыт этой итерацией и ждёт оценки батча
+        uint64_t claimedBatch = 0; ///< LeafBatch::generation() батча с детьми path.back()
+    };
+
+    /**
+     * Ребро пути синхронной итерации: ребёнок child записи node, игрок в узле.
+     * Глубина пути не больше числа клеток, поэтому стек — массив фиксированного размера.
+     */
+    struct PathEdge {
+        SearchNode *node;
+        uint8_t child;
+        bool isFirstPlayer;
+    };
+
+    LeafBatch leafBatch;
+    std::vector<PendingIteration> asyncIterations;
+    long asyncCompleted = 0;
+    size_t asyncCursor = 0;
+
+    /**
+     * Продвигает одну итерацию — тот же алгоритм, что descentIteration, но с приостановкой на время оценки батча.
+     * @return true — итерация дошла до терминала и подняла значение до корня;
+     *         false — приостановлена (ждёт оценки своих детей или узла другой итерации)
+     */
+    bool advance(PendingIteration &it, LeafBatch &batch) {
+        while (true) {
+            BigBoard *state = &it.path.back();
+
+            if (state->isGameOver()) {
+                float score = state->getTerminalScore();
+                S.add(state); // S ← S ∪ {s}
+                V(state) = score; // v(s) ← ft(s)
+                unwind(it, score);
+                return true;
+            }
+
+            SearchNode *node;
+            if (S.tryClaim(state)) {
+                if (expandAsync(state, batch, node) > 0) {
+                    it.claimedLeaf = true;
+                    it.claimedBatch = batch.generation();
+                    return false;
+                }
+                S.markReady(state); // все дети терминальные или оценены из EvaluationCache — сеть не нужна
+            } else if (!S.isReady(state)) {
+                return false; // узел раскрыт другой итерацией в этом раунде
+            } else {
+                node = V.findNode(state);
+            }
+
+            int best = bestChildOf(state, node, true); // ab ← best_action(s)
+            node->inFlight()[best].fetch_add(1, std::memory_order_relaxed);
+            it.nodes.push_back(node);
+            it.children.push_back(static_cast<uint8_t>(best));
+            it.path.emplace_back(*state); // без перевыделения: reserve(82) в конструкторе
+            it.path.back().applyMove(state->moveFromCanonical(node->moves()[best]));
+        }
+    }
+
+    /**
+     * Раскрытие s: терминальные дети оцениваются сразу, остальные — в batch.
+     * @param node - созданная запись s
+     * @return число состояний, добавленных в batch
+     */
+    int expandAsync(BigBoard *state, LeafBatch &batch, SearchNode *&node) {
+        const bool parentIsX = state->getCurrentPlayer() == cell::X;
+        int added = 0;
+        uint8_t actions[bigBoardArrays::movesSize];
+        node = createNode(state, actions);
+        BigBoard::MoveUndo undo;
+        for (int i = 0; i < node->movesCount; ++i) {
+            state->applyMove(actions[i], undo);
+
+            if (state->isGameOver()) {
+                S.add(state);
+                float termVal = state->getTerminalScore();
+                node->childValues()[i] = termVal;
+                V(state) = termVal;
+            } else {
+                if (batch.add(*state, &node->childValues()[i], parentIsX)) {
+                    ++added; // иначе оценка взята из EvaluationCache
+                }
+            }
+            state->undoMove(undo);
+        }
+        evaluatedStateCount += added;
+        return added;
+    }
+
+    /**
+     * Обратный проход по пути: v'(s,ab) ← значение ребёнка, v(s) ← v'(s, best_action(s)).
+     */
+    void unwind(PendingIteration &it, float value) {
+        for (int k = static_cast<int>(it.children.size()) - 1; k >= 0; --k) {
+            SearchNode *node = it.nodes[k];
+            int child = it.children[k];
+            node->childValues()[child] = value;
+            node->inFlight()[child].fetch_sub(1, std::memory_order_relaxed);
+            value = node->childValues()[bestChildOf(&it.path[k], node)];
+            node->value = value;
+        }
+        it.nodes.clear();
+        it.children.clear();
+    }
+
+    /**
+     * Цикл одного потока: повторяет descentIteration от корня,
+     * пока не выйдет время или таблицы S/V не заполнятся до предела.
+     * (Корень только читается: каждая итерация спускается на своей рабочей копии.)
      */
-    BatchEvaluator batchEvaluator;
+    void runWorker(const BigBoard *board, BatchEvaluator &batchEvaluator, std::atomic<long> &iterCount) {
+        while (!isTimeExceeded(timeLimit) && !isSearchSaturated()) {
+            descentIteration(board, batchEvaluator);
+            iterCount.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
     /**
      * Сбрасывает таймер при начале descent.
      */
@@ -187,6 +570,34 @@ private:
         startTime = std::chrono::high_resolution_clock::now();
     }
 
+    /**
+     * Создаёт запись s в V: по одному ребёнку на класс симметричных ходов
+     * (в симметричной позиции равноценные ходы делят v'(s,a), оценивать их повторно незачем).
+     *
+     * @param actions - сюда пишутся ходы детей в координатах s, в порядке записи
+     */
+    SearchNode *createNode(BigBoard *state, uint8_t *actions) {
+        uint8_t *moves = state->getValidMoves(); // все действия
+        uint8_t canonicalMoves[bigBoardArrays::movesSize];
+        const bool isSymmetric = state->isSelfSymmetric();
+        std::bitset<symmetry::MOVES_TABLE_SIZE> handled;
+
+        int count = 0;
+        for (int i = 1; i <= moves[0]; ++i) {
+            uint8_t canonical = state->canonicalMove(moves[i]);
+            if (isSymmetric) [[unlikely]] {
+                if (handled.test(canonical)) {
+                    continue; // v'(s,a) общий с уже раскрытым симметричным ходом
+                }
+                handled.set(canonical);
+            }
+            actions[count] = moves[i];
+            canonicalMoves[count] = canonical;
+            ++count;
+        }
+        return V.createNode(state, canonicalMoves, count);
+    }
+
     /**
      * Проверяет, истекло ли moveTimeLimit секунд с момента resetTimer().
      */
@@ -0,0 +1,243 @@
+// LeafBatch.h
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <vector>
+#include "parameters.h"
+#include "big_board/BigBoard.h"
+#include "shared_memory/SharedMemory.h"
+#include "state_to_nn_representation/state_to_channels.h"
+
+/**
+ * @brief Большой батч для асинхронного Descent: дети многих раскрытых узлов
+ *        (из разных приостановленных итераций) оцениваются одним вызовом сети.
+ *
+ * В отличие от BatchEvaluator, который оценивает детей сразу после раскрытия одного
+ * узла, здесь ячейки v'(s,a) разных узлов ждут общего вызова сети. Записи SearchNode
+ * не перемещаются до Map_T::clear(), поэтому адреса ячеек остаются действительными.
+ *
+ * add() только копирует слова состояния; в каналы весь батч конвертируется в evaluate()
+ * потоками SharedMemory::convertPool, каждый — в свой участок буферов.
+ *
+ * С несколькими буферами (ASYNC_EVALUATION_BUFFERS) буферы SharedMemory делятся на участки:
+ * evaluate() отдаёт батч потоку оценки (SharedMemory::submitEvaluation) и сразу возвращается,
+ * следующий батч набирается в другом участке, пока сеть считает предыдущий. Какие батчи уже
+ * записаны в v'(s,a), показывают generation() / completedGeneration().
+ */
+class LeafBatch {
+public:
+    static constexpr int MAX_CHILDREN = 81; ///< Максимум детей у одного раскрываемого узла
+
+    /**
+     * @param shm          - общий буфер с Python
+     * @param targetSize   - желаемый размер батча (ограничивается участком буфера)
+     * @param buffersCount - батчей в работе одновременно (1 — синхронный Evaluate())
+     */
+    LeafBatch(SharedMemory &shm, int targetSize, int buffersCount = params::ASYNC_EVALUATION_BUFFERS)
+        : sharedMem(shm),
+          buffers(std::max(1, buffersCount)),
+          capacity(std::min<int>(targetSize + MAX_CHILDREN, static_cast<int>(shm.sampleLength / buffers.size()))),
+          count(0),
+          evaluateCalls(0),
+          evaluatedStates(0) {
+        for (Buffer &buffer: buffers) {
+            buffer.targets.resize(capacity);
+            buffer.negate.resize(capacity);
+            buffer.keys.resize(capacity);
+        }
+        states.resize(capacity);
+    }
+
+    /**
+     * @brief Хватит ли места, чтобы раскрыть ещё один узел целиком.
+     */
+    inline bool hasRoomForNode() const {
+        return count + MAX_CHILDREN <= capacity;
+    }
+
+    inline int size() const {
+        return count;
+    }
+
+    /// Оценка идёт в потоке SharedMemory: вызывающий на время поиска должен отпустить GIL
+    inline bool isPipelined() const {
+        return buffers.size() > 1;
+    }
+
+    /// Номер набираемого батча (в него попадают состояния add())
+    inline uint64_t generation() const {
+        return submitted;
+    }
+
+    /// Батчи с номерами меньше этого оценены и записаны в v'(s,a)
+    inline uint64_t completedGeneration() const {
+        return completed;
+    }
+
+    /**
+     * @brief Добавляет нетерминальное состояние child = a(parent).
+     * @param target      - ячейка v'(parent, a), куда будет записана оценка
+     * @param parentIsX   - ход в parent делает X (тогда каналы child свапнуты и знак нужно инвертировать)
+     * @return false, если оценка нашлась в EvaluationCache и уже записана в target (в батч не добавлено)
+     */
+    inline bool add(const BigBoard &childBoard, std::atomic<float> *target, bool parentIsX) {
+        float cachedValue;
+        if (sharedMem.evaluationCache.lookup(childBoard.canonicalKey, cachedValue)) {
+            target->store(parentIsX ? -cachedValue : cachedValue, std::memory_order_relaxed);
+            return false;
+        }
+
+        const int i = count;
+        std::memcpy(states[i].data(), childBoard.boardsArray, sizeof(states[i]));
+
+        Buffer &buffer = buffers[submitted % buffers.size()];
+        buffer.targets[i] = target;
+        buffer.negate[i] = parentIsX;
+        buffer.keys[i] = childBoard.canonicalKey;
+        count++;
+        return true;
+    }
+
+    /**
+     * @brief Оценка набранного батча и запись результатов в v'(s,a).
+     *
+     * С одним буфером — один вызов Evaluate(), батч записан при возврате. С несколькими батч уходит
+     * в поток оценки, а записываются уже оценённые; если участок следующего батча ещё в работе,
+     * ждём его. Пустой батч при батчах в работе — ждём старейший, чтобы ожидающие итерации продвинулись.
+     */
+    void evaluate() {
+        if (!isPipelined()) {
+            if (count > 0) {
+                evaluateNow();
+            }
+            return;
+        }
+        if (count > 0) {
+            submit();
+            while (submitted - completed >= buffers.size()) {
+                retireOldest();
+            }
+        } else if (completed < submitted) {
+            retireOldest();
+        }
+        while (completed < submitted && sharedMem.pollEvaluation(buffers[completed % buffers.size()].ticket)) {
+            retireOldest();
+        }
+    }
+
+    /// Оценивает всё добавленное и ждёт все батчи в работе (перед finishAsync и концом хода)
+    void flush() {
+        if (!isPipelined()) {
+            evaluate();
+            return;
+        }
+        if (count > 0) {
+            submit();
+        }
+        while (completed < submitted) {
+            retireOldest();
+        }
+    }
+
+    /// Средний размер батча с последнего resetStats()
+    inline float averageSize() const {
+        return evaluateCalls == 0 ? 0.0f : static_cast<float>(evaluatedStates) / static_cast<float>(evaluateCalls);
+    }
+
+    inline long calls() const {
+        return evaluateCalls;
+    }
+
+    void resetStats() {
+        evaluateCalls = 0;
+        evaluatedStates = 0;
+    }
+
+private:
+    /**
+     * Ячейки v'(s,a) одного батча; батч generation g лежит в buffers[g % size] и в участке
+     * [index * capacity, index * capacity + count) буферов SharedMemory.
+     */
+    struct Buffer {
+        std::vector<std::atomic<float> *> targets;
+        std::vector<uint8_t> negate;
+        std::vector<uint64_t> keys; ///< canonicalKey состояний — для записи в EvaluationCache
+        int count = 0;
+        uint64_t ticket = 0; ///< Билет SharedMemory::submitEvaluation
+        uint32_t weightsVersion = 0; ///< EvaluationCache::weightsVersion() при отправке в сеть
+    };
+
+    SharedMemory &sharedMem;
+    std::vector<Buffer> buffers;
+    int capacity;
+    int count;
+    std::vector<std::array<uint64_t, stateToChannels::STATE_WORDS> > states; ///< Слова состояний до конвертации в каналы
+    uint64_t submitted = 0;
+    uint64_t completed = 0;
+    long evaluateCalls;
+    long evaluatedStates;
+
+    /// Каналы набранного батча — в участок его буфера
+    void convert(size_t offset) {
+        sharedMem.convertPool.parallelFor(count, params::CONVERT_MIN_CHUNK, [this, offset](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                uint8_t *dstMain = sharedMem.sampleMainChannels + (offset + i) * stateToChannels::MAIN_BYTES;
+                uint8_t *dstMacro = sharedMem.sampleMacroChannels + (offset + i) * stateToChannels::MACRO_BYTES;
+                stateToChannels::convert(states[i].data(), dstMain, dstMacro);
+            }
+        });
+    }
+
+    /// Оценка sampleValues участка буфера -> EvaluationCache и v'(s,a)
+    void scatter(const Buffer &buffer, size_t offset) {
+        const float *values = sharedMem.sampleValues + offset;
+        for (int i = 0; i < buffer.count; i++) {
+            float netVal = values[i];
+            sharedMem.evaluationCache.store(buffer.keys[i], netVal, buffer.weightsVersion);
+            buffer.targets[i]->store(buffer.negate[i] ? -netVal : netVal, std::memory_order_relaxed);
+        }
+        evaluateCalls++;
+        evaluatedStates += buffer.count;
+    }
+
+    void evaluateNow() {
+        Buffer &buffer = buffers[0];
+        buffer.count = count;
+        convert(0);
+        buffer.weightsVersion = sharedMem.evaluationCache.weightsVersion();
+        {
+            std::lock_guard<std::mutex> lock(sharedMem.evaluateMutex);
+            sharedMem.intVars[0] = count;
+            sharedMem.intVars[SharedMemory::evaluateOffsetVar] = 0;
+            sharedMem.EvaluateFromThread();
+        }
+        scatter(buffer, 0);
+        count = 0;
+        submitted++;
+        completed++;
+    }
+
+    void submit() {
+        const size_t index = submitted % buffers.size();
+        Buffer &buffer = buffers[index];
+        buffer.count = count;
+        convert(index * capacity);
+        buffer.weightsVersion = sharedMem.evaluationCache.weightsVersion();
+        buffer.ticket = sharedMem.submitEvaluation(static_cast<int>(index * capacity), count);
+        count = 0;
+        submitted++;
+    }
+
+    void retireOldest() {
+        const size_t index = completed % buffers.size();
+        const Buffer &buffer = buffers[index];
+        sharedMem.waitEvaluation(buffer.ticket);
+        scatter(buffer, index * capacity);
+        completed++;
+    }
+};
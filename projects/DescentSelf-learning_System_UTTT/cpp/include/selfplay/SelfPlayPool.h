@@ -0,0 +1,163 @@
+// SelfPlayPool.h
+#pragma once
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "structures/ReplayBuffer.h"
+#include "structures/Set_S.h"
+#include "structures/Map_T.h"
+#include "big_board/BigBoard.h"
+#include "Descent.h"
+#include "LeafBatch.h"
+#include "utils/OrdinalActionSelector.h"
+
+/**
+ * @brief Пул из K независимых партий самоигры, которые ходят синхронно (lock-step).
+ *
+ * У каждой партии свои S, V и асинхронный Descent; приостановленные итерации всех
+ * партий наполняют один общий LeafBatch, который оценивается одним вызовом сети
+ * (с несколькими буферами — в потоке SharedMemory, пока партии набирают следующий батч).
+ * Законченная партия, как и в SelfPlayer, переносится в буфер через ReplayBuffer::moveAll
+ * и тут же заменяется новой.
+ *
+ * Ход пула длится K * params::MOVE_TIME_LIMIT: на партию приходится столько же времени поиска,
+ * сколько у SelfPlayer, а выигрыш общего батча идёт в число итераций, а не в урезанный поиск.
+ */
+class SelfPlayPool {
+public:
+    SelfPlayPool(ReplayBuffer &replayBuffer, SharedMemory &shm, int gamesCount)
+        : replayBuffer(replayBuffer),
+          sharedMem(shm),
+          sharedBatch(shm, params::ASYNC_BATCH_SIZE),
+          finishedGames(0) {
+        games.reserve(gamesCount);
+        for (int i = 0; i < gamesCount; ++i) {
+            games.push_back(std::make_unique<Game>(shm));
+        }
+    }
+
+    /**
+     * Ходы во всех партиях, пока в буфере не накопится достаточно новых данных.
+     * Незаконченные партии продолжаются при следующем вызове.
+     */
+    void runSelfPlay() {
+        while (!replayBuffer.isEnoughNewData()) {
+            playMoveInAllGames();
+        }
+    }
+
+private:
+    /**
+     * Одна партия пула: собственные S, V и Descent (асинхронный режим).
+     */
+    struct Game {
+        Map_T V; ///< Хранит v(s) и v'(s,a)
+        Set_S S; ///< Хранит множество уникальных состояний
+        Descent descentLogic;
+        BigBoard board; ///< Позиция партии; новая партия начинается board.stateInit() — без выделения памяти
+        bool inProgress = false;
+        int moveNum = 0;
+
+        explicit Game(SharedMemory &shm)
+            : descentLogic(S, V, shm, params::POOL_ASYNC_ITERATIONS) {
+        }
+    };
+
+    ReplayBuffer &replayBuffer; ///< Буфер для (состояние, значение)
+    SharedMemory &sharedMem;
+    std::vector<std::unique_ptr<Game> > games;
+    LeafBatch sharedBatch; ///< Общий батч NN для всех партий
+    long finishedGames;
+    size_t gameCursor = 0;
+    std::chrono::time_point<std::chrono::high_resolution_clock> startTime;
+    std::optional<std::chrono::time_point<std::chrono::high_resolution_clock> > poolStartTime; ///< первый ход пула
+
+    /**
+     * Один ход во всех K партиях: общий для них Descent на K * params::MOVE_TIME_LIMIT,
+     * затем выбор хода по Ordinal distribution в каждой партии.
+     */
+    void playMoveInAllGames() {
+        if (!poolStartTime) {
+            poolStartTime = std::chrono::high_resolution_clock::now();
+        }
+        for (std::unique_ptr<Game> &game: games) {
+            if (!game->inProgress) {
+                game->board.stateInit();
+                game->inProgress = true;
+                game->moveNum = 0;
+            }
+            game->descentLogic.prepareForMove();
+            game->descentLogic.beginAsync(&game->board);
+        }
+
+        startTime = std::chrono::high_resolution_clock::now();
+        sharedBatch.resetStats();
+        std::optional<py::gil_scoped_release> releaseGil;
+        if (sharedBatch.isPipelined()) {
+            releaseGil.emplace(); // GIL нужен потоку оценки SharedMemory
+        }
+        const float moveTimeLimit = static_cast<float>(games.size()) * params::MOVE_TIME_LIMIT;
+        bool anyActive = true;
+        while (anyActive && !isTimeExceeded(moveTimeLimit)) {
+            anyActive = false;
+            // Начинаем с разных партий, чтобы при заполнении батча ни одна не голодала
+            gameCursor = (gameCursor + 1) % games.size();
+            for (size_t j = 0; j < games.size() && sharedBatch.hasRoomForNode(); ++j) {
+                Descent &descentLogic = games[(gameCursor + j) % games.size()]->descentLogic;
+                if (descentLogic.isSearchSaturated()) {
+                    if (descentLogic.isAsyncActive()) {
+                        sharedBatch.flush(); // дети узлов партии могут быть ещё в работе
+                        descentLogic.completeAsyncBatch(sharedBatch);
+                        descentLogic.finishAsync();
+                    }
+                    continue;
+                }
+                anyActive |= descentLogic.advanceAsync(sharedBatch, false);
+            }
+            sharedBatch.evaluate();
+            for (std::unique_ptr<Game> &game: games) {
+                game->descentLogic.completeAsyncBatch(sharedBatch);
+            }
+        }
+        sharedBatch.flush();
+        for (std::unique_ptr<Game> &game: games) {
+            game->descentLogic.completeAsyncBatch(sharedBatch);
+        }
+        releaseGil.reset();
+
+        long iterations = 0;
+        for (std::unique_ptr<Game> &game: games) {
+            game->descentLogic.finishAsync();
+            iterations += game->descentLogic.asyncIterationsCompleted();
+            float ratio = game->moveNum == 0 ? 0.0f : params::ORDINAL_ACTION_RATIO;
+            uint8_t action = OrdinalActionSelector::select(&game->board, game->V, ratio); //a ← action_selection(s, S, T)
+            game->board.applyMove(action); //s ← a(s)
+            game->moveNum++;
+
+            if (game->board.isGameOver()) {
+                replayBuffer.moveAll(game->S, game->V); // После партии переносим все (s, v(s)) из S в буфер
+                game->inProgress = false;
+                finishedGames++;
+            }
+        }
+        const double hours = std::chrono::duration<double, std::ratio<3600> >(
+            std::chrono::high_resolution_clock::now() - *poolStartTime).count();
+        std::cout << "[SelfPlayPool] NN batches = " << sharedBatch.calls()
+                << ", average batch size = " << sharedBatch.averageSize()
+                << ", iterations per game = " << iterations / static_cast<long>(games.size())
+                << ", cache hit rate = " << sharedMem.evaluationCache.hitRate()
+                << ", finished games = " << finishedGames
+                << ", games/hour = " << static_cast<double>(finishedGames) / hours
+                << ", new added = " << replayBuffer.newAddedCount << std::endl;
+    }
+
+    bool isTimeExceeded(float moveTimeLimit) const {
+        using namespace std::chrono;
+        float elapsed = duration<float>(high_resolution_clock::now() - startTime).count();
+        return (elapsed >= moveTimeLimit);
+    }
+};
@@ -1,8 +1,6 @@
 #pragma once
 
-#include <cstdlib>   // rand()
 #include <chrono>
-#include <algorithm> // std::sort
 #include <iostream>
 
 #include "structures/ReplayBuffer.h"
@@ -11,11 +9,13 @@
 #include "big_board/BigBoard.h"
 #include "Descent.h" // Предполагаем, что этот класс реализует descent(board, moveTimeLimit)
 #include "boards/utils/big_board_renderer.h"
+#include "utils/OrdinalActionSelector.h"
 
 class SelfPlayer {
 public:
     explicit SelfPlayer(ReplayBuffer &replayBuffer, SharedMemory &shm)
         : replayBuffer(replayBuffer),
+          sharedMem(shm),
           descentLogic(S, V, shm) // Передаём ссылки на S и V в конструктор Descent
     {
     }
@@ -31,6 +31,7 @@ public:
             std::cout << "New Added: " << replayBuffer.newAddedCount << std::endl;
             std::cout << "Buffer Size: " << replayBuffer.bufferSize() << std::endl;
             std::cout << "S.size: " << S.size << std::endl;
+            printEvaluationCacheStats();
             replayBuffer.moveAll(S, V); // После партии переносим все (s, v(s)) из S в буфер,
             std::cout << "---After Added---" << std::endl;
             std::cout << "New Added: " << replayBuffer.newAddedCount << std::endl;
@@ -41,6 +42,7 @@ public:
 
 private:
     ReplayBuffer &replayBuffer; ///< Буфер для (состояние, значение)
+    SharedMemory &sharedMem; ///< Связь с сетью (и её EvaluationCache)
     Map_T V; ///< Хранит v(s) и v'(s,a)
     Set_S S; ///< Хранит множество уникальных состояний
     Descent descentLogic; ///< Алгоритм Descent, работающий с S и V
@@ -50,83 +52,38 @@ private:
      * В каждом ходу вызываем Descent, а затем выбираем ход по Ordinal distribution.
      */
     void playSingleGame() {
-        BigBoard *board = new BigBoard();
+        BigBoard board;
         moveNum = 0;
-        while (!board->isGameOver()) {
-            descentLogic.descent(board, params::MOVE_TIME_LIMIT); // S, T ← descent(s, S, T, fθ, ft)
-            uint8_t action = selectMoveOrdinal(board, params::ORDINAL_ACTION_RATIO); //a ← action_selection(s, S, T)
-            board->applyMove(action); //s ← a(s)
-            drawBigBoard(*board);
+        while (!board.isGameOver()) {
+            descentLogic.descent(&board, params::MOVE_TIME_LIMIT); // S, T ← descent(s, S, T, fθ, ft)
+            uint8_t action = selectMoveOrdinal(&board, params::ORDINAL_ACTION_RATIO); //a ← action_selection(s, S, T)
+            board.applyMove(action); //s ← a(s)
+            drawBigBoard(board);
             std::cout << "S.size = " << S.size << std::endl;
             std::cout << "Move Num: " << moveNum << std::endl;
             moveNum++;
         }
-        delete board;
     }
 
     /**
-     * Реализует Ordinal action distribution:
-     *  - сортируем ходы по убыванию/возрастанию в зависимости от игрока;
-     *  - идём от лучшего к худшему, на j-м шаге бросаем случай [0..1];
-     *  - c вероятностью p берём текущий ход, иначе идём к j+1;
-     *  - если дошли до конца — берём последний.
-     *  - ratio = 0:  равномерное распределение по всем 𝑛 − 𝑗 оставшимся вариантам.
-     *  - ratio = 1:  выбираем первый (самый лучший) ход
+     * Накопленная статистика кеша оценок сети — для подбора params::EVALUATION_CACHE_MB.
+     */
+    void printEvaluationCacheStats() const {
+        const EvaluationCache &cache = sharedMem.evaluationCache;
+        std::cout << "Evaluation cache: hit rate = " << cache.hitRate()
+                << ", hits = " << cache.hits()
+                << ", misses = " << cache.misses()
+                << ", evictions = " << cache.evictions()
+                << ", capacity = " << cache.capacity() << std::endl;
+    }
+
+    /**
+     * Ordinal action distribution; на первом ходу партии — равномерно по всем ходам.
      */
     uint8_t selectMoveOrdinal(BigBoard *board, float ratio) {
         if (moveNum == 0) {
             ratio = 0.0;
         }
-        uint8_t *moves = board->getValidMoves();
-        int movesCount = moves[0];
-        if (movesCount == 0) {
-            return 0;
-        }
-
-        bool firstPlayer = (board->getCurrentPlayer() == cell::X);
-
-        MoveVal mv[81];
-
-        for (int i = 0; i < movesCount; ++i) {
-            uint8_t m = moves[i + 1];
-            mv[i].move = m;
-            mv[i].val = V(board, m);
-        }
-
-        // Сортируем массив с использованием оптимизированных компараторов
-        if (firstPlayer) {
-            std::sort(mv, mv + movesCount, compare_desc);
-        } else {
-            std::sort(mv, mv + movesCount, compare_asc);
-        }
-
-        // Алгоритм Ordinal:
-        // На j-м шаге p = ratio * ((n-j-1)/(n-j)) + (1/(n-j))
-        int n = movesCount;
-        for (int j = 0; j < n; j++) {
-            float p = ratio * (float(n - j - 1) / float(n - j))
-                      + (1.0f / float(n - j));
-
-            float r = float(rand()) / float(RAND_MAX);
-            if (r < p) {
-                return mv[j].move;
-            }
-        }
-
-        // Если все "отвергли" - берём последний
-        return mv[n - 1].move;
-    }
-
-    struct MoveVal {
-        uint8_t move;
-        float val;
-    };
-
-    static inline bool compare_desc(const MoveVal &a, const MoveVal &b) noexcept {
-        return a.val > b.val;
-    }
-
-    static inline bool compare_asc(const MoveVal &a, const MoveVal &b) noexcept {
-        return a.val < b.val;
+        return OrdinalActionSelector::select(board, V, ratio);
     }
 };
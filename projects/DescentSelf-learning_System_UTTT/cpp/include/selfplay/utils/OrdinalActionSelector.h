@@ -0,0 +1,85 @@
+// OrdinalActionSelector.h
+#pragma once
+
+#include <cstdlib>   // rand()
+#include <algorithm> // std::fill
+#include <cstring>
+
+#include "big_board/BigBoard.h"
+#include "structures/Map_T.h"
+#include "value_kernels.h"
+
+/**
+ * @brief Выбор хода по Ordinal action distribution (общий для SelfPlayer и SelfPlayPool).
+ */
+class OrdinalActionSelector {
+public:
+    /**
+     * Реализует Ordinal action distribution:
+     *  - сортируем ходы по убыванию/возрастанию в зависимости от игрока;
+     *  - идём от лучшего к худшему, на j-м шаге бросаем случай [0..1];
+     *  - c вероятностью p берём текущий ход, иначе идём к j+1;
+     *  - если дошли до конца — берём последний.
+     *  - ratio = 0:  равномерное распределение по всем 𝑛 − 𝑗 оставшимся вариантам.
+     *  - ratio = 1:  выбираем первый (самый лучший) ход
+     *
+     * Броски не зависят от значений, поэтому сначала разыгрываем ранг j, а затем
+     * находим ход с этим рангом (valueKernels::nthBestIndex) без полной сортировки.
+     */
+    static uint8_t select(BigBoard *board, Map_T &V, float ratio) {
+        uint8_t *moves = board->getValidMoves();
+        int movesCount = moves[0];
+        if (movesCount == 0) {
+            return 0;
+        }
+
+        bool firstPlayer = (board->getCurrentPlayer() == cell::X);
+
+        float values[valueKernels::MAX_VALUES];
+        childValuesOf(board, V, moves, values);
+
+        // Алгоритм Ordinal:
+        // На j-м шаге p = ratio * ((n-j-1)/(n-j)) + (1/(n-j))
+        int n = movesCount;
+        int rank = n - 1; // Если все "отвергли" - берём последний
+        for (int j = 0; j < n; j++) {
+            float p = ratio * (float(n - j - 1) / float(n - j))
+                      + (1.0f / float(n - j));
+
+            float r = float(rand()) / float(RAND_MAX);
+            if (r < p) {
+                rank = j;
+                break;
+            }
+        }
+
+        uint8_t order[valueKernels::MAX_VALUES];
+        int i = firstPlayer
+                    ? valueKernels::nthBestIndex<true>(values, n, rank, order)
+                    : valueKernels::nthBestIndex<false>(values, n, rank, order);
+        return moves[i + 1];
+    }
+
+private:
+    /**
+     * v'(s,a) для всех допустимых ходов (симметричные ходы получают значение общего ребёнка):
+     * одно обращение к V, дальше — таблица канонический ход → ребёнок записи.
+     */
+    static void childValuesOf(const BigBoard *board, Map_T &V, const uint8_t *moves, float *values) {
+        const int movesCount = moves[0];
+        SearchNode *node = V.findNode(board);
+        if (node == nullptr) {
+            std::fill(values, values + movesCount, 0.0f);
+            return;
+        }
+        int8_t childOf[symmetry::MOVES_TABLE_SIZE];
+        std::memset(childOf, -1, sizeof(childOf));
+        for (int c = 0; c < node->movesCount; ++c) {
+            childOf[node->moves()[c]] = static_cast<int8_t>(c);
+        }
+        for (int i = 0; i < movesCount; ++i) {
+            int c = childOf[board->canonicalMove(moves[i + 1])];
+            values[i] = c < 0 ? 0.0f : node->childValues()[c].load(std::memory_order_relaxed);
+        }
+    }
+};
@@ -0,0 +1,201 @@
+// value_kernels.h
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+/**
+ * @brief Поиск лучшего v'(s,a) среди детей узла (best_action) и хода заданного ранга
+ *        (Ordinal action distribution) без полной сортировки.
+ *
+ * maximize — знак игрока (X = argmax, O = argmin) задаётся на этапе компиляции.
+ * Реализация выбирается по флагам компилятора: AVX2 (8 значений за такт), SSE2 (4), скаляр.
+ * При равенстве возвращается первый индекс — как в прежнем цикле Descent::bestActionOf.
+ */
+namespace valueKernels {
+    constexpr int MAX_VALUES = 81;
+
+    /// Значение с виртуальным штрафом: лучший ход для игрока становится хуже
+    template<bool maximize>
+    inline float penalized(float value, int32_t inFlight, float penalty) {
+        return maximize ? value - penalty * static_cast<float>(inFlight) : value + penalty * static_cast<float>(inFlight);
+    }
+
+    template<bool maximize>
+    inline bool isBetter(float a, float b) {
+        return maximize ? a > b : a < b;
+    }
+
+    /**
+     * Скалярный вариант (и эталон для векторных): values[i] ∓ penalty * inFlight[i],
+     * при inFlight == nullptr — просто values[i].
+     */
+    template<bool maximize>
+    inline int bestIndexScalar(const float *values, const int32_t *inFlight, float penalty, int n) {
+        int best = 0;
+        float bestVal = maximize ? -1e9f : 1e9f;
+        for (int i = 0; i < n; ++i) {
+            float val = inFlight == nullptr ? values[i] : penalized<maximize>(values[i], inFlight[i], penalty);
+            if (isBetter<maximize>(val, bestVal)) {
+                bestVal = val;
+                best = i;
+            }
+        }
+        return best;
+    }
+
+#if defined(__AVX2__)
+    /// 8 значений начиная с i; дорожки за n заполняются заведомо худшим значением
+    template<bool maximize, bool withPenalty>
+    inline __m256 loadAvx2(const float *values, const int32_t *inFlight, __m256 penalty, int i, int n) {
+        const __m256 worst = _mm256_set1_ps(maximize ? -1e30f : 1e30f);
+        __m256 v;
+        __m256i lanes = _mm256_setzero_si256();
+        const bool isTail = i + 8 > n;
+        if (isTail) {
+            lanes = _mm256_cmpgt_epi32(_mm256_set1_epi32(n - i), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+            v = _mm256_maskload_ps(values + i, lanes);
+        } else {
+            v = _mm256_loadu_ps(values + i);
+        }
+        if constexpr (withPenalty) {
+            __m256i counts = isTail
+                                 ? _mm256_maskload_epi32(reinterpret_cast<const int *>(inFlight + i), lanes)
+                                 : _mm256_loadu_si256(reinterpret_cast<const __m256i *>(inFlight + i));
+            __m256 loss = _mm256_mul_ps(penalty, _mm256_cvtepi32_ps(counts));
+            v = maximize ? _mm256_sub_ps(v, loss) : _mm256_add_ps(v, loss);
+        }
+        return isTail ? _mm256_blendv_ps(worst, v, _mm256_castsi256_ps(lanes)) : v;
+    }
+
+    template<bool maximize, bool withPenalty>
+    inline int bestIndexAvx2(const float *values, const int32_t *inFlight, float penaltyValue, int n) {
+        const __m256 penalty = _mm256_set1_ps(penaltyValue);
+
+        // 1) Экстремум по всем дорожкам
+        __m256 acc = loadAvx2<maximize, withPenalty>(values, inFlight, penalty, 0, n);
+        for (int i = 8; i < n; i += 8) {
+            __m256 v = loadAvx2<maximize, withPenalty>(values, inFlight, penalty, i, n);
+            acc = maximize ? _mm256_max_ps(acc, v) : _mm256_min_ps(acc, v);
+        }
+        __m128 r = maximize
+                       ? _mm_max_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1))
+                       : _mm_min_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+        r = maximize ? _mm_max_ps(r, _mm_movehl_ps(r, r)) : _mm_min_ps(r, _mm_movehl_ps(r, r));
+        r = maximize ? _mm_max_ss(r, _mm_shuffle_ps(r, r, 1)) : _mm_min_ss(r, _mm_shuffle_ps(r, r, 1));
+        const __m256 best = _mm256_set1_ps(_mm_cvtss_f32(r));
+
+        // 2) Первая дорожка, равная экстремуму (те же вычисления — значения совпадают побитово)
+        for (int i = 0; i < n; i += 8) {
+            __m256 v = loadAvx2<maximize, withPenalty>(values, inFlight, penalty, i, n);
+            int mask = _mm256_movemask_ps(_mm256_cmp_ps(v, best, _CMP_EQ_OQ));
+            if (mask != 0) {
+                return i + __builtin_ctz(mask);
+            }
+        }
+        return 0;
+    }
+#elif defined(__SSE2__)
+    template<bool maximize, bool withPenalty>
+    inline __m128 loadSse2(const float *values, const int32_t *inFlight, __m128 penalty, int i) {
+        __m128 v = _mm_loadu_ps(values + i);
+        if constexpr (withPenalty) {
+            __m128i counts = _mm_loadu_si128(reinterpret_cast<const __m128i *>(inFlight + i));
+            __m128 loss = _mm_mul_ps(penalty, _mm_cvtepi32_ps(counts));
+            v = maximize ? _mm_sub_ps(v, loss) : _mm_add_ps(v, loss);
+        }
+        return v;
+    }
+
+    template<bool maximize, bool withPenalty>
+    inline int bestIndexSse2(const float *values, const int32_t *inFlight, float penaltyValue, int n) {
+        const int vectorEnd = n & ~3;
+        if (vectorEnd == 0) {
+            return bestIndexScalar<maximize>(values, withPenalty ? inFlight : nullptr, penaltyValue, n);
+        }
+        const __m128 penalty = _mm_set1_ps(penaltyValue);
+
+        // 1) Экстремум: векторная часть, затем хвост скалярно
+        __m128 acc = loadSse2<maximize, withPenalty>(values, inFlight, penalty, 0);
+        for (int i = 4; i < vectorEnd; i += 4) {
+            __m128 v = loadSse2<maximize, withPenalty>(values, inFlight, penalty, i);
+            acc = maximize ? _mm_max_ps(acc, v) : _mm_min_ps(acc, v);
+        }
+        acc = maximize ? _mm_max_ps(acc, _mm_movehl_ps(acc, acc)) : _mm_min_ps(acc, _mm_movehl_ps(acc, acc));
+        acc = maximize ? _mm_max_ss(acc, _mm_shuffle_ps(acc, acc, 1)) : _mm_min_ss(acc, _mm_shuffle_ps(acc, acc, 1));
+        float bestVal = _mm_cvtss_f32(acc);
+        int tailBest = -1;
+        for (int i = vectorEnd; i < n; ++i) {
+            float val = withPenalty ? penalized<maximize>(values[i], inFlight[i], penaltyValue) : values[i];
+            if (isBetter<maximize>(val, bestVal)) {
+                bestVal = val;
+                tailBest = i;
+            }
+        }
+        if (tailBest >= 0) {
+            return tailBest; // хвост строго лучше всей векторной части
+        }
+
+        // 2) Первая дорожка, равная экстремуму
+        const __m128 best = _mm_set1_ps(bestVal);
+        for (int i = 0; i < vectorEnd; i += 4) {
+            __m128 v = loadSse2<maximize, withPenalty>(values, inFlight, penalty, i);
+            int mask = _mm_movemask_ps(_mm_cmpeq_ps(v, best));
+            if (mask != 0) {
+                return i + __builtin_ctz(mask);
+            }
+        }
+        return 0;
+    }
+#endif
+
+    /**
+     * @return индекс лучшего из values[0..n)
+     */
+    template<bool maximize>
+    inline int bestIndex(const float *values, int n) {
+#if defined(__AVX2__)
+        return bestIndexAvx2<maximize, false>(values, nullptr, 0.0f, n);
+#elif defined(__SSE2__)
+        return bestIndexSse2<maximize, false>(values, nullptr, 0.0f, n);
+#else
+        return bestIndexScalar<maximize>(values, nullptr, 0.0f, n);
+#endif
+    }
+
+    /**
+     * @return индекс лучшего из values[i] ∓ penalty * inFlight[i] (виртуальный штраф)
+     */
+    template<bool maximize>
+    inline int bestIndex(const float *values, const int32_t *inFlight, float penalty, int n) {
+#if defined(__AVX2__)
+        return bestIndexAvx2<maximize, true>(values, inFlight, penalty, n);
+#elif defined(__SSE2__)
+        return bestIndexSse2<maximize, true>(values, inFlight, penalty, n);
+#else
+        return bestIndexScalar<maximize>(values, inFlight, penalty, n);
+#endif
+    }
+
+    /**
+     * @brief Индекс значения с рангом rank (0 — лучшее) — частичная сортировка за O(n).
+     * @param order - рабочий массив на n индексов
+     */
+    template<bool maximize>
+    inline int nthBestIndex(const float *values, int n, int rank, uint8_t *order) {
+        if (rank == 0) {
+            return bestIndex<maximize>(values, n);
+        }
+        for (int i = 0; i < n; ++i) {
+            order[i] = static_cast<uint8_t>(i);
+        }
+        std::nth_element(order, order + rank, order + n, [values](uint8_t a, uint8_t b) {
+            return isBetter<maximize>(values[a], values[b]);
+        });
+        return order[rank];
+    }
+}
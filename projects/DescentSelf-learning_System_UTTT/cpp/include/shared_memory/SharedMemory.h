@@ -1,11 +1,24 @@
 // SharedMemory.h
 #pragma once
 
+#include <atomic>
+#include <condition_variable>
 #include <cstddef>
 #include <cstdint>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
 #include <pybind11/pybind11.h>
 #include <pybind11/numpy.h>
 
+#include "inference_server/InferenceClient.h"
+#include "nn_inference/ValueNet.h"
+#include "state_to_nn_representation/channels_layout.h"
+#include "structures/EvaluationCache.h"
+#include "structures/WorkerPool.h"
+
 namespace py = pybind11;
 
 class SharedMemory {
@@ -16,17 +29,29 @@ public:
     const std::size_t sampleLength;
 
     // Основные массивы
-    uint8_t *sampleMainChannels;    // размер: sampleLength * 9 * 9 * 6
-    uint8_t *sampleMacroChannels;   // размер: sampleLength * 3 * 3 * 2
+    uint8_t *sampleMainChannels;    // размер: sampleLength * MAIN_BYTES (9 * 9 * 6, NN_INPUT_PACKED — 64)
+    uint8_t *sampleMacroChannels;   // размер: sampleLength * MACRO_BYTES (3 * 3 * 2, NN_INPUT_PACKED — 3)
     float *sampleValues;          // размер: sampleLength
-    int *intVars;               // размер: 11
+    int *intVars;               // размер: intVarsCount
     float *floatVars;             // размер: 8
 
-private:
     // Числа элементов в intVars / floatVars
     static constexpr std::size_t intVarsCount = 11;
     static constexpr std::size_t floatVarsCount = 10;
+    // Смещение участка буферов для Evaluate() (intVars[0] — число состояний) — последний элемент intVars:
+    // команды Do() пишут в intVars[1..] строки (путь модели) и до него не доходят
+    static constexpr std::size_t evaluateOffsetVar = intVarsCount - 1;
+
+    // Сериализует доступ к intVars и вызовам Python из рабочих потоков Descent (ValueNet — см. evaluateConcurrently)
+    std::mutex evaluateMutex;
+
+    // Оценки сети для текущих весов; сбрасывается при каждой смене весов (Learn(), Do())
+    EvaluationCache evaluationCache;
+
+    // Потоки конвертации состояний в sampleMainChannels / sampleMacroChannels (SampleTrainer, LeafBatch)
+    WorkerPool convertPool;
 
+private:
     // Python-модуль (shared_memory_script)
     py::object shared_memory_script_;
 
@@ -34,12 +59,49 @@ private:
     py::object do_func_;
     py::object evaluate_func_;
     py::object learn_func_;
+    py::object export_native_func_;
+
+    // Оценка на C++ (useNativeEvaluator): файл весов пуст — оценивает Python
+    ValueNet nativeNet;
+    std::string nativeWeightsPath;
+    int quantCalibrationStates = 0; // > 0: после Learn() ValueNet калибруется и переходит на int8
+    int quantHeldOutStates = 0;
+
+    // Асинхронная оценка (submitEvaluation): очередь участков буферов и поток, который их оценивает
+    struct EvaluationRequest {
+        int offset;
+        int count;
+    };
+
+    std::thread evaluatorThread;
+    std::mutex evaluationQueueMutex;
+    std::condition_variable evaluationSubmitted;
+    std::condition_variable evaluationCompleted;
+    std::deque<EvaluationRequest> evaluationQueue;
+    uint64_t submittedEvaluations = 0; // под evaluationQueueMutex
+    std::atomic<uint64_t> completedEvaluations{0};
+    bool stopEvaluator = false;
+
+    // Оценка и обучение в процессе InferenceServer (общая модель нескольких self-play процессов)
+    InferenceClient inferenceClient;
+    uint32_t remoteWeightsVersion = 0; // версия весов сервера, для которой заполнен evaluationCache
 
 public:
     // -------------------------------------------------------
     // КОНСТРУКТОР / ДЕСТРУКТОР
     // -------------------------------------------------------
-    explicit SharedMemory(std::size_t paramSampleLength);
+    /**
+     * @param paramSampleLength     - число состояний в буферах
+     * @param evaluationCacheBytes  - память под EvaluationCache (0 — без кеша)
+     * @param convertThreads        - потоков в convertPool вместе с вызывающим (0 — по числу ядер)
+     * @param inferenceServer       - имя сегмента InferenceServer: Evaluate() и Learn() уходят на сервер;
+     *                                пусто или сервера нет — модель в этом процессе
+     *
+     * Python-скрипт (и TensorFlow) загружается при первом обращении к модели Python,
+     * поэтому с InferenceServer или useNativeWeights() он не нужен вовсе.
+     */
+    explicit SharedMemory(std::size_t paramSampleLength, std::size_t evaluationCacheBytes = 0, int convertThreads = 1,
+                          const std::string &inferenceServer = "");
 
     ~SharedMemory();
 
@@ -47,17 +109,120 @@ public:
     // Методы, вызывающие Python-функции
     // -------------------------------------------------------
     inline void Do() {
+        if (inferenceClient.isConnected()) {
+            std::cerr << "[SharedMemory] Do() is not forwarded to the inference server" << std::endl;
+            return;
+        }
+        ensureScript();
         do_func_();
+        reloadNativeEvaluator();
+        evaluationCache.invalidate(); // команда может загрузить другие веса
     }
 
     inline void Evaluate() {
+        if (inferenceClient.isConnected() && evaluateRemote()) {
+            return;
+        }
+        if (nativeNet.isLoaded()) {
+            evaluateNative();
+            return;
+        }
+        ensureScript();
+        evaluate_func_();
+    }
+
+    /**
+     * @brief Evaluate() для вызова из любого потока: захватывает GIL на время вызова.
+     *        Вызывающий поток должен держать evaluateMutex.
+     */
+    inline void EvaluateFromThread() {
+        if (inferenceClient.isConnected() && evaluateRemote()) {
+            return; // без Python: GIL не нужен
+        }
+        if (nativeNet.isLoaded()) {
+            evaluateNative(); // без Python: GIL не нужен
+            return;
+        }
+        py::gil_scoped_acquire gil;
+        ensureScript();
         evaluate_func_();
     }
 
     inline void Learn() {
+        const int sampleSize = intVars[0]; // в буферах — выборка ReplayBuffer (SampleTrainer)
+        if (inferenceClient.isConnected() &&
+            inferenceClient.learn(sampleMainChannels, sampleMacroChannels, sampleValues, sampleSize, remoteWeightsVersion)) {
+            evaluationCache.invalidate();
+            return;
+        }
+        ensureScript();
         learn_func_();
+        reloadNativeEvaluator();
+        calibrateNativeEvaluator(sampleSize);
+        evaluationCache.invalidate(); // веса обучены, а Evaluate() может переключиться на эксперта
     }
 
+    /**
+     * @brief Переключает Evaluate() на ValueNet (прямой проход на C++ без Python).
+     *        Python выгружает в path веса модели, которой оценивал бы сам (main или expert);
+     *        после каждой смены весов (Learn(), Do()) выгрузка повторяется.
+     * @param calibrationStates  > 0 — после каждого Learn() ValueNet калибруется на первых calibrationStates
+     *                           состояниях обучающей выборки и считает в int8 (до первого Learn() — FP32)
+     * @param heldOutStates      следующие состояния выборки — для отчёта о расхождении int8 и FP32
+     * @return false — веса не загрузились или оценивает InferenceServer, оценка остаётся прежней
+     */
+    bool useNativeEvaluator(const std::string &path, int calibrationStates = 0, int heldOutStates = 0);
+
+    /**
+     * @brief Evaluate() на ValueNet с готовым файлом весов (native_export.py) без Python: веса не меняются
+     *        ни Learn(), ни Do() — для замеров и игры без обучения.
+     * @return false — веса не загрузились или оценивает InferenceServer
+     */
+    bool useNativeWeights(const std::string &path);
+
+    /**
+     * @brief Оценка участка [offset, offset + count) буферов на ValueNet без evaluateMutex и intVars:
+     *        потоки Descent со своими scratch считают одновременно. Веса меняются только между ходами
+     *        (Learn(), Do() из главного потока), поэтому во время поиска их можно читать без блокировки.
+     * @return false — оценивает Python или InferenceServer: нужен EvaluateFromThread() под evaluateMutex
+     */
+    inline bool evaluateConcurrently(int offset, int count, ValueNet::Scratch &scratch) {
+        if (!canEvaluateConcurrently()) {
+            return false;
+        }
+        nativeNet.evaluate(sampleMainChannels + static_cast<std::size_t>(offset) * stateToChannels::MAIN_BYTES,
+                           sampleMacroChannels + static_cast<std::size_t>(offset) * stateToChannels::MACRO_BYTES,
+                           count, sampleValues + offset, scratch);
+        return true;
+    }
+
+    /**
+     * @brief Может ли evaluateConcurrently() считать сейчас. Нет — каждое раскрытие потоков Descent
+     *        встаёт в очередь на evaluateMutex, и потоки сверх одного ничего не ускоряют.
+     */
+    inline bool canEvaluateConcurrently() const {
+        return nativeNet.isLoaded() && !inferenceClient.isConnected();
+    }
+
+    // -------------------------------------------------------
+    // Асинхронная оценка: сеть считает в отдельном потоке, пока вызывающий готовит следующий батч
+    // -------------------------------------------------------
+    /**
+     * @brief Ставит в очередь оценку участка [offset, offset + count) буферов и сразу возвращается.
+     *        Поток оценки (запускается при первом вызове) по очереди вызывает EvaluateFromThread()
+     *        под evaluateMutex — GIL на время вызова держит только он. До завершения билета участок
+     *        нельзя менять, а вызывающий поток не должен держать GIL (иначе оценка в Python его ждёт).
+     * @return билет для pollEvaluation() / waitEvaluation(); билеты завершаются в порядке выдачи
+     */
+    uint64_t submitEvaluation(int offset, int count);
+
+    inline bool pollEvaluation(uint64_t ticket) const {
+        return completedEvaluations.load(std::memory_order_acquire) > ticket;
+    }
+
+    /// Ждёт, пока sampleValues участка билета не будут записаны
+    void waitEvaluation(uint64_t ticket);
+
     // -------------------------------------------------------
     // Геттеры массивов (возвращают NumPy-массивы без копий)
     // -------------------------------------------------------
@@ -84,4 +249,46 @@ private:
 
     // Регистрация класса SharedMemory (однократно)
     static void ensureClassRegistered();
+
+    // Цикл потока оценки: участки из evaluationQueue по одному через EvaluateFromThread()
+    void evaluatorLoop();
+
+    // Импорт shared_memory_script и init_arrays(self) — при первом обращении к модели Python
+    void loadScript();
+
+    inline void ensureScript() {
+        if (!shared_memory_script_) {
+            loadScript();
+        }
+    }
+
+    // Оценка участка буферов на InferenceServer; false — сервер недоступен (клиент отключается)
+    inline bool evaluateRemote() {
+        const std::size_t offset = intVars[evaluateOffsetVar];
+        uint32_t version = remoteWeightsVersion;
+        if (!inferenceClient.evaluate(sampleMainChannels + offset * stateToChannels::MAIN_BYTES,
+                                      sampleMacroChannels + offset * stateToChannels::MACRO_BYTES,
+                                      intVars[0], sampleValues + offset, version)) {
+            return false;
+        }
+        if (version != remoteWeightsVersion) {
+            remoteWeightsVersion = version; // сервер обучился на выборке другого клиента
+            evaluationCache.invalidate();
+        }
+        return true;
+    }
+
+    // Повторная выгрузка и загрузка весов ValueNet, если включена оценка на C++
+    void reloadNativeEvaluator();
+
+    // Калибровка int8 на выборке обучения из буферов (sampleSize состояний) и отчёт о расхождении с FP32
+    void calibrateNativeEvaluator(int sampleSize);
+
+    // Оценка участка [offset, offset + intVars[0]) буферов через ValueNet (offset — intVars[evaluateOffsetVar])
+    inline void evaluateNative() {
+        const std::size_t offset = intVars[evaluateOffsetVar];
+        nativeNet.evaluate(sampleMainChannels + offset * stateToChannels::MAIN_BYTES,
+                           sampleMacroChannels + offset * stateToChannels::MACRO_BYTES,
+                           intVars[0], sampleValues + offset);
+    }
 };
@@ -0,0 +1,29 @@
+// channels_layout.h
+#pragma once
+
+#include <cstddef>
+
+/**
+ * Размеры записи одного состояния в sampleMainChannels / sampleMacroChannels.
+ *
+ * Обычная запись — байт 0/1 на значение: [9, 9, 6] и [3, 3, 2].
+ * С NN_INPUT_PACKED — бит на значение в том же порядке: значение с плоским номером k
+ * (k = (h * 9 + w) * 6 + c для main, k = boardIndex * 2 + c для macro) — бит k % 8 байта k / 8.
+ * 486 бит main дополнены нулями до 64 байт (одна линия кеша на состояние), 18 бит macro — 3 байта.
+ * Python распаковывает биты в графе TF (descent/packed_inputs.py).
+ */
+namespace stateToChannels {
+    constexpr std::size_t MAIN_VALUES = 9 * 9 * 6;
+    constexpr std::size_t MACRO_VALUES = 3 * 3 * 2;
+
+    constexpr std::size_t PACKED_MAIN_BYTES = 64;
+    constexpr std::size_t PACKED_MACRO_BYTES = (MACRO_VALUES + 7) / 8;
+
+#ifdef NN_INPUT_PACKED
+    constexpr bool PACKED = true;
+#else
+    constexpr bool PACKED = false;
+#endif
+    constexpr std::size_t MAIN_BYTES = PACKED ? PACKED_MAIN_BYTES : MAIN_VALUES;
+    constexpr std::size_t MACRO_BYTES = PACKED ? PACKED_MACRO_BYTES : MACRO_VALUES;
+}
@@ -4,7 +4,12 @@
 #include <cstdint>
 #include <cstring>
 
+#if defined(__AVX2__) || defined(__SSSE3__) || defined(__BMI2__)
+#include <immintrin.h>
+#endif
+
 #include "big_board/BigBoard.h"
+#include "state_to_nn_representation/channels_layout.h"
 #include "boards/fields_functions/small_board_access.h" // для boardGet::*
 #include "bits/constants/bit_constants.h"               // для rights::_9_BITS, etc.
 
@@ -117,25 +122,164 @@ namespace stateToChannels {
     }
 
 
+    constexpr int CELLS = 81;
+    constexpr int GROUP_CELLS = 16; ///< Клеток в одной векторной группе записи: 16 * 6 = 96 байт
+    constexpr int GROUP_BYTES = GROUP_CELLS * main_channelsSize;
+    constexpr int VECTOR_GROUPS = CELLS / GROUP_CELLS; ///< 5 групп = 80 клеток, последняя клетка — отдельно
+
     /**
-     * @brief Конвертирует состояние BigBoard в (height=9, width=9, channels=6),
-     *        записывая 0/1 в буфер \p address.
+     * Таблицы записи каналов: битовые маски -> байты 0/1.
+     * Шаблон клетки — 6 бит, бит c = значение канала c в этой клетке.
+     */
+    struct ExpandTables {
+        uint64_t bitsToBytes[256]; ///< Байт i = бит i маски
+        uint64_t patternToChannels[64]; ///< Байт c = бит c шаблона (6 байт записи клетки)
+        alignas(32) uint8_t groupCell[GROUP_BYTES]; ///< Номер клетки в группе для каждого байта записи
+        alignas(32) uint8_t groupChannelBit[GROUP_BYTES]; ///< 1 << канал для каждого байта записи
+    };
+
+    constexpr ExpandTables generateExpandTables() {
+        ExpandTables tables{};
+        for (int mask = 0; mask < 256; ++mask) {
+            for (int bit = 0; bit < 8; ++bit) {
+                tables.bitsToBytes[mask] |= uint64_t((mask >> bit) & 1) << (bit * 8);
+            }
+        }
+        for (int pattern = 0; pattern < 64; ++pattern) {
+            tables.patternToChannels[pattern] = tables.bitsToBytes[pattern];
+        }
+        for (int i = 0; i < GROUP_BYTES; ++i) {
+            tables.groupCell[i] = static_cast<uint8_t>(i / main_channelsSize);
+            tables.groupChannelBit[i] = static_cast<uint8_t>(1 << (i % main_channelsSize));
+        }
+        return tables;
+    }
+
+    alignas(64) inline constexpr ExpandTables expandTables = generateExpandTables();
+
+    /**
+     * @brief Собирает шаблоны клеток: patterns[h * 9 + w], бит c = значение канала c в клетке.
+     *
+     * Для каждой малой доски шаблоны всех 9 клеток собираются сразу: bitsToBytes раскладывает
+     * маску канала по байтам, сдвиг на c ставит её в бит c каждого байта.
+     * Тройки клеток строк доски копируются в patterns на свои места (h * 9 + w).
+     */
+    inline void buildCellPatterns(const uint64_t channelsStates[main_channelsSize][9], uint8_t patterns[CELLS]) {
+        for (int boardIndex = 0; boardIndex < 9; ++boardIndex) {
+            uint64_t low = 0; // клетки 0-7
+            uint64_t high = 0; // клетка 8
+            for (int c = 0; c < main_channelsSize; ++c) {
+                uint64_t mask = channelsStates[c][boardIndex];
+                low |= expandTables.bitsToBytes[mask & rights::_8_BITS] << c;
+                high |= ((mask >> 8) & rights::_1_BIT) << c;
+            }
+            uint8_t cells[9];
+            std::memcpy(cells, &low, sizeof(low));
+            cells[8] = static_cast<uint8_t>(high);
+            uint8_t *boardRows = patterns + (boardIndex / 3) * 27 + (boardIndex % 3) * 3;
+            for (int row = 0; row < 3; ++row) {
+                std::memcpy(boardRows + row * 9, cells + row * 3, 3);
+            }
+        }
+    }
+
+    /**
+     * @brief Записывает шаблоны клеток в address[(h * 9 + w) * 6 + c] (0/1 на байт).
+     *
+     * Shuffle размножает шаблон клетки на её 6 байт, AND с 1 << c и min(., 1) оставляют 0/1 —
+     * по 96 байт (16 клеток) за группу.
+     */
+    inline void expandCellPatterns(const uint8_t patterns[CELLS], uint8_t *address) {
+#if defined(__AVX2__)
+        const __m256i one = _mm256_set1_epi8(1);
+        for (int group = 0; group < VECTOR_GROUPS; ++group) {
+            // pshufb работает в пределах 128-битной половины: шаблоны группы нужны в обеих
+            __m256i source = _mm256_broadcastsi128_si256(
+                _mm_load_si128(reinterpret_cast<const __m128i *>(patterns + group * GROUP_CELLS)));
+            for (int part = 0; part < GROUP_BYTES / 32; ++part) {
+                __m256i cellIndex = _mm256_load_si256(reinterpret_cast<const __m256i *>(expandTables.groupCell + part * 32));
+                __m256i channelBit = _mm256_load_si256(reinterpret_cast<const __m256i *>(expandTables.groupChannelBit + part * 32));
+                __m256i bytes = _mm256_and_si256(_mm256_shuffle_epi8(source, cellIndex), channelBit);
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(address + group * GROUP_BYTES + part * 32),
+                                    _mm256_min_epu8(bytes, one));
+            }
+        }
+#elif defined(__SSSE3__)
+        const __m128i one = _mm_set1_epi8(1);
+        for (int group = 0; group < VECTOR_GROUPS; ++group) {
+            __m128i source = _mm_load_si128(reinterpret_cast<const __m128i *>(patterns + group * GROUP_CELLS));
+            for (int part = 0; part < GROUP_BYTES / 16; ++part) {
+                __m128i cellIndex = _mm_load_si128(reinterpret_cast<const __m128i *>(expandTables.groupCell + part * 16));
+                __m128i channelBit = _mm_load_si128(reinterpret_cast<const __m128i *>(expandTables.groupChannelBit + part * 16));
+                __m128i bytes = _mm_and_si128(_mm_shuffle_epi8(source, cellIndex), channelBit);
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(address + group * GROUP_BYTES + part * 16),
+                                 _mm_min_epu8(bytes, one));
+            }
+        }
+#else
+        for (int cellIndex = 0; cellIndex < VECTOR_GROUPS * GROUP_CELLS; ++cellIndex) {
+            std::memcpy(address + cellIndex * main_channelsSize,
+                        &expandTables.patternToChannels[patterns[cellIndex]], main_channelsSize);
+        }
+#endif
+        for (int cellIndex = VECTOR_GROUPS * GROUP_CELLS; cellIndex < CELLS; ++cellIndex) {
+            std::memcpy(address + cellIndex * main_channelsSize,
+                        &expandTables.patternToChannels[patterns[cellIndex]], main_channelsSize);
+        }
+    }
+
+    constexpr int PACK_CELLS = 8; ///< Клеток в одном слове упаковки: 8 * 6 = 48 бит = 6 байт
+    constexpr int PACK_BYTES = PACK_CELLS * main_channelsSize / 8;
+    constexpr int PACK_GROUPS = CELLS / PACK_CELLS; ///< 10 слов = 80 клеток, последняя клетка — отдельно
+    constexpr uint64_t PATTERN_BITS = 0x3F3F3F3F3F3F3F3FULL; ///< Младшие 6 бит каждого байта
+
+    /**
+     * @brief Записывает шаблоны клеток по биту на значение (NN_INPUT_PACKED, см. channels_layout.h):
+     *        значение (h * 9 + w) * 6 + c — бит номер (h * 9 + w) * 6 + c, всего PACKED_MAIN_BYTES байт.
+     *
+     * Шаблоны клеток идут подряд по 6 бит, поэтому 8 клеток сжимаются в 6 байт (pext по маске 0x3F в байте).
+     */
+    inline void packCellPatterns(const uint8_t patterns[CELLS], uint8_t *address) {
+        for (int group = 0; group < PACK_GROUPS; ++group) {
+            uint64_t cells;
+            std::memcpy(&cells, patterns + group * PACK_CELLS, sizeof(cells));
+#if defined(__BMI2__)
+            uint64_t bits = _pext_u64(cells, PATTERN_BITS);
+#else
+            uint64_t bits = 0;
+            for (int cell = 0; cell < PACK_CELLS; ++cell) {
+                bits |= ((cells >> (cell * 8)) & rights::_6_BITS) << (cell * main_channelsSize);
+            }
+#endif
+            std::memcpy(address + group * PACK_BYTES, &bits, PACK_BYTES); // little-endian: младший байт — первый
+        }
+        uint8_t *tail = address + PACK_GROUPS * PACK_BYTES;
+        tail[0] = patterns[CELLS - 1];
+        std::memset(tail + 1, 0, PACKED_MAIN_BYTES - PACK_GROUPS * PACK_BYTES - 1);
+    }
+
+    /// Сколько первых слов BigBoard::boardsArray нужно для конвертации: 9 малых досок, bigState1, bigState2
+    constexpr int STATE_WORDS = bigBoardArrays::bigState2Pos + 1;
+
+    /**
+     * @brief Конвертирует состояние в (height=9, width=9, channels=6),
+     *        записывая 0/1 в буфер \p address (packed = true — по биту на значение, см. channels_layout.h).
      *
      * Форма записи:  address[(h * 9 + w) * 6 + c].
      *
-     * @param[in]  pBigBoard  Указатель на BigBoard (9 мини-досок в boardsArray[0..8]).
-     * @param[out] addressMainChannels   Массив размером 9*9*6 = 486 байт, куда записываются каналы.
+     * @param[in]  boardsArray  Первые STATE_WORDS слов BigBoard::boardsArray (можно копию — для отложенной конвертации).
+     * @param[out] addressMainChannels   Массив размером MAIN_BYTES (9*9*6 = 486 байт без упаковки), куда записываются каналы.
      */
-    inline void convert(const BigBoard *pBigBoard, uint8_t *addressMainChannels, uint8_t *addressMacroChannels) {
-        const uint64_t *boardsArray = pBigBoard->boardsArray;
-        uint64_t bigState1 = pBigBoard->bigState1;
-        uint64_t bigState2 = pBigBoard->bigState2;
+    template<bool packed>
+    inline void convertTo(const uint64_t *boardsArray, uint8_t *addressMainChannels, uint8_t *addressMacroChannels) {
+        uint64_t bigState1 = boardsArray[bigBoardArrays::bigState1Pos];
+        uint64_t bigState2 = boardsArray[bigBoardArrays::bigState2Pos];
 
         uint64_t mainChannelsStates[main_channelsSize][9];
         uint64_t macroWinsX;
         uint64_t macroWinsO;
 
-        if (pBigBoard->getCurrentPlayer() == cell::X) {
+        if (BigBoardGet::player(bigState2) == cell::X) {
             fillChannelsStatesForPlayerX(mainChannelsStates, boardsArray, bigState1, bigState2);
             macroWinsX = BigBoardGet::layerWinsX(bigState1);
             macroWinsO = BigBoardGet::layerWinsO(bigState1);
@@ -151,26 +295,36 @@ namespace stateToChannels {
         //  bitValue = (channelsStates[c][boardIndex] >> cellIndex) & 1
         //
         //  addressIndex = (h * 9 + w) * main_channelsSize + c
+        alignas(16) uint8_t patterns[CELLS];
+        buildCellPatterns(mainChannelsStates, patterns);
 
-        for (int h = 0; h < 9; h++) {
-            const int baseBoardIndex = (h / 3) * 3;
-            const int baseCellIndex = (h % 3) * 3;
-
-            for (int w = 0; w < 9; w++) {
-                const int boardIndex = baseBoardIndex + (w / 3);
-                const int cellIndex = baseCellIndex + (w % 3);
-
-                for (int c = 0; c < main_channelsSize; c++) {
-                    const uint64_t maskForBoard = mainChannelsStates[c][boardIndex];
-                    const uint64_t bitValue = (maskForBoard >> cellIndex) & 1ULL;
-                    *(addressMainChannels++) = static_cast<uint8_t>(bitValue);
-                }
+        if constexpr (packed) {
+            packCellPatterns(patterns, addressMainChannels);
+            uint32_t macroBits = 0; // бит boardIndex * 2 + c
+            for (int boardIndex = 0; boardIndex < 9; ++boardIndex) {
+                macroBits |= static_cast<uint32_t>((macroWinsX >> boardIndex) & 1ULL) << (boardIndex * 2);
+                macroBits |= static_cast<uint32_t>((macroWinsO >> boardIndex) & 1ULL) << (boardIndex * 2 + 1);
+            }
+            std::memcpy(addressMacroChannels, &macroBits, PACKED_MACRO_BYTES);
+        } else {
+            expandCellPatterns(patterns, addressMainChannels);
+            for (int boardIndex = 0; boardIndex < 9; ++boardIndex) {
+                *(addressMacroChannels++) = (macroWinsX >> boardIndex) & 1ULL;
+                *(addressMacroChannels++) = (macroWinsO >> boardIndex) & 1ULL;
             }
         }
-        for (int boardIndex = 0; boardIndex < 9; ++boardIndex) {
-            *(addressMacroChannels++) = (macroWinsX >> boardIndex) & 1ULL;
-            *(addressMacroChannels++) = (macroWinsO >> boardIndex) & 1ULL;
-        }
+    }
+
+    /// Запись в формате буферов SharedMemory (NN_INPUT_PACKED — по биту на значение)
+    inline void convert(const uint64_t *boardsArray, uint8_t *addressMainChannels, uint8_t *addressMacroChannels) {
+        convertTo<PACKED>(boardsArray, addressMainChannels, addressMacroChannels);
+    }
+
+    /**
+     * @param[in]  pBigBoard  Указатель на BigBoard (9 мини-досок в boardsArray[0..8]).
+     */
+    inline void convert(const BigBoard *pBigBoard, uint8_t *addressMainChannels, uint8_t *addressMacroChannels) {
+        convert(pBigBoard->boardsArray, addressMainChannels, addressMacroChannels);
     }
 
 
@@ -0,0 +1,199 @@
+// ConcurrentTable.h
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Lock-free хеш-таблица с открытой адресацией (линейное пробирование) для ключей uint64_t.
+ *
+ * Общая основа для Map_T и Set_S в многопоточном Descent:
+ *  - вставка и поиск без блокировок (CAS по ключу), удаления нет;
+ *  - рост (rehash) выполняется только вне параллельной фазы — в prepareForConcurrentPhase();
+ *  - во время параллельной фазы потоки проверяют isNearlyFull() и прекращают поиск заранее.
+ *
+ * Ключ 0 зарезервирован как "пусто", поэтому хеш 0 переносится в 1.
+ */
+class ConcurrentTable {
+public:
+    struct Entry {
+        std::atomic<uint64_t> key; ///< 0 = пустая ячейка
+        std::atomic<float> value; ///< не используется Map_T (v(s) хранится в SearchNode)
+        std::atomic<int32_t> counter; ///< ссылка на SearchNode (Map_T) или флаг готовности (Set_S)
+    };
+
+    explicit ConcurrentTable(size_t initialCapacity)
+        : capacity(roundUpPow2(initialCapacity)),
+          mask(capacity - 1),
+          entries(new Entry[capacity]),
+          count(0),
+          countAtLastPrepare(0) {
+        resetEntries(entries, capacity);
+    }
+
+    ConcurrentTable(const ConcurrentTable &) = delete;
+
+    ConcurrentTable &operator=(const ConcurrentTable &) = delete;
+
+    ~ConcurrentTable() {
+        delete[] entries;
+    }
+
+    /**
+     * @brief Находит ячейку ключа или занимает новую.
+     * @param inserted - true, если ключ был вставлен именно этим вызовом
+     */
+    inline Entry &findOrInsert(uint64_t key, bool &inserted) {
+        key = nonZero(key);
+        for (size_t i = slotOf(key);; i = (i + 1) & mask) {
+            Entry &e = entries[i];
+            uint64_t current = e.key.load(std::memory_order_acquire);
+            if (current == key) {
+                inserted = false;
+                return e;
+            }
+            if (current == 0) {
+                if (e.key.compare_exchange_strong(current, key, std::memory_order_acq_rel)) {
+                    count.fetch_add(1, std::memory_order_relaxed);
+                    inserted = true;
+                    return e;
+                }
+                if (current == key) {
+                    inserted = false;
+                    return e;
+                }
+            }
+        }
+    }
+
+    inline Entry &findOrInsert(uint64_t key) {
+        bool inserted;
+        return findOrInsert(key, inserted);
+    }
+
+    inline Entry *find(uint64_t key) const {
+        key = nonZero(key);
+        for (size_t i = slotOf(key);; i = (i + 1) & mask) {
+            Entry &e = entries[i];
+            uint64_t current = e.key.load(std::memory_order_acquire);
+            if (current == key) {
+                return &e;
+            }
+            if (current == 0) {
+                return nullptr;
+            }
+        }
+    }
+
+    inline size_t size() const {
+        return count.load(std::memory_order_relaxed);
+    }
+
+    inline size_t bucketCount() const {
+        return capacity;
+    }
+
+    /**
+     * Заполненность выше 3/4: дальнейшие вставки сильно замедляют пробирование,
+     * а при 100% поиск не завершится. Потоки Descent останавливаются на этой границе.
+     */
+    inline bool isNearlyFull() const {
+        return size() * 4 >= capacity * 3;
+    }
+
+    /**
+     * @brief Вызывается однопоточно перед параллельной фазой (например, в начале хода).
+     *
+     * Гарантирует, что после вставки ещё 2× от числа вставок прошлой фазы
+     * заполненность не превысит 1/2. Иначе — удваивает ёмкость с rehash.
+     */
+    void prepareForConcurrentPhase() {
+        size_t current = size();
+        size_t lastPhaseInserts = current - countAtLastPrepare;
+        size_t required = (current + 2 * lastPhaseInserts) * 2;
+        if (required > capacity) {
+            rehash(roundUpPow2(required));
+        }
+        countAtLastPrepare = size();
+    }
+
+    /**
+     * @brief Очистка без освобождения памяти (однопоточно).
+     */
+    void clear() {
+        resetEntries(entries, capacity);
+        count.store(0, std::memory_order_relaxed);
+        countAtLastPrepare = 0;
+    }
+
+    /**
+     * @brief Обход всех занятых ячеек (однопоточно).
+     */
+    template<typename Fn>
+    void forEach(Fn &&fn) const {
+        for (size_t i = 0; i < capacity; ++i) {
+            uint64_t key = entries[i].key.load(std::memory_order_relaxed);
+            if (key != 0) {
+                fn(entries[i]);
+            }
+        }
+    }
+
+private:
+    size_t capacity;
+    size_t mask;
+    Entry *entries;
+    std::atomic<size_t> count;
+    size_t countAtLastPrepare;
+
+    static inline uint64_t nonZero(uint64_t key) {
+        return key + (key == 0);
+    }
+
+    /// Фибоначчиево перемешивание: младшие биты FNV/комбинированных ключей распределены неравномерно
+    inline size_t slotOf(uint64_t key) const {
+        return static_cast<size_t>((key * 0x9E3779B97F4A7C15ULL) >> 17) & mask;
+    }
+
+    static size_t roundUpPow2(size_t n) {
+        size_t p = 1024;
+        while (p < n) {
+            p <<= 1;
+        }
+        return p;
+    }
+
+    static void resetEntries(Entry *dst, size_t n) {
+        for (size_t i = 0; i < n; ++i) {
+            dst[i].key.store(0, std::memory_order_relaxed);
+            dst[i].value.store(0.0f, std::memory_order_relaxed);
+            dst[i].counter.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    void rehash(size_t newCapacity) {
+        Entry *oldEntries = entries;
+        size_t oldCapacity = capacity;
+
+        capacity = newCapacity;
+        mask = capacity - 1;
+        entries = new Entry[capacity];
+        resetEntries(entries, capacity);
+
+        for (size_t i = 0; i < oldCapacity; ++i) {
+            uint64_t key = oldEntries[i].key.load(std::memory_order_relaxed);
+            if (key == 0) {
+                continue;
+            }
+            size_t j = slotOf(key);
+            while (entries[j].key.load(std::memory_order_relaxed) != 0) {
+                j = (j + 1) & mask;
+            }
+            entries[j].key.store(key, std::memory_order_relaxed);
+            entries[j].value.store(oldEntries[i].value.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            entries[j].counter.store(oldEntries[i].counter.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        }
+        delete[] oldEntries;
+    }
+};
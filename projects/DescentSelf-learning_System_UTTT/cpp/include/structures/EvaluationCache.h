@@ -0,0 +1,213 @@
+// EvaluationCache.h
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+/**
+ * @brief Ограниченный по памяти кеш оценок нейросети: canonicalKey состояния → выход сети.
+ *
+ * Живёт дольше одного хода и одной партии, поэтому повторяющиеся позиции (дебюты,
+ * транспозиции) не отправляются в сеть повторно. Каждая запись помечена версией весов;
+ * invalidate() (после Learn() / загрузки чекпоинта) делает все записи устаревшими за O(1).
+ *
+ * Устройство: 4-канальные наборы по 64 байта, вытеснение CLOCK внутри набора.
+ * Без блокировок: запись хранит check = key ^ data, поэтому "разорванное" чтение
+ * при гонке с записью просто даёт промах.
+ */
+class EvaluationCache {
+public:
+    static constexpr int WAYS = 4;
+
+    /**
+     * @param memoryBytes - предел памяти под записи (0 — кеш выключен)
+     */
+    explicit EvaluationCache(std::size_t memoryBytes)
+        : bucketsCount(0),
+          bucketMask(0),
+          currentVersion(1),
+          hitsCount(0),
+          missesCount(0),
+          evictionsCount(0) {
+        std::size_t count = 1;
+        while (count * 2 * sizeof(Bucket) <= memoryBytes) {
+            count *= 2;
+        }
+        if (count * sizeof(Bucket) <= memoryBytes) {
+            bucketsCount = count;
+            bucketMask = count - 1;
+            buckets = std::make_unique<Bucket[]>(count);
+            clockState = std::make_unique<std::atomic<uint8_t>[]>(count);
+        }
+    }
+
+    EvaluationCache(const EvaluationCache &) = delete;
+
+    EvaluationCache &operator=(const EvaluationCache &) = delete;
+
+    inline bool isEnabled() const {
+        return bucketsCount != 0;
+    }
+
+    /**
+     * @brief Ищет оценку состояния для текущей версии весов.
+     * @return true и value при попадании
+     */
+    inline bool lookup(uint64_t key, float &value) {
+        if (!isEnabled()) [[unlikely]] {
+            return false;
+        }
+        const std::size_t b = key & bucketMask;
+        const uint32_t version = currentVersion.load(std::memory_order_relaxed);
+        Bucket &bucket = buckets[b];
+        for (int w = 0; w < WAYS; ++w) {
+            uint64_t data = bucket.entries[w].data.load(std::memory_order_relaxed);
+            uint64_t check = bucket.entries[w].check.load(std::memory_order_relaxed);
+            if ((check ^ data) == key && versionOf(data) == version) {
+                value = valueOf(data);
+                markReferenced(b, w);
+                hitsCount.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        missesCount.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    /**
+     * @brief Сохраняет оценку. Место: та же позиция → пустая/устаревшая запись → жертва CLOCK.
+     * @param version - weightsVersion(), прочитанная до вызова сети: если веса сменились, пока сеть
+     *                  считала (invalidate() из другого потока), оценка старых весов не сохраняется
+     */
+    inline void store(uint64_t key, float value, uint32_t version) {
+        if (!isEnabled() || version != currentVersion.load(std::memory_order_relaxed)) [[unlikely]] {
+            return;
+        }
+        const std::size_t b = key & bucketMask;
+        Bucket &bucket = buckets[b];
+
+        int victim = -1;
+        for (int w = 0; w < WAYS; ++w) {
+            uint64_t data = bucket.entries[w].data.load(std::memory_order_relaxed);
+            uint64_t check = bucket.entries[w].check.load(std::memory_order_relaxed);
+            if ((check ^ data) == key) {
+                victim = w;
+                break;
+            }
+            if (victim < 0 && versionOf(data) != version) {
+                victim = w;
+            }
+        }
+        if (victim < 0) {
+            victim = clockVictim(b);
+            evictionsCount.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        // Помечаем версией оценки, а не текущей: invalidate() между проверкой и записью оставит запись устаревшей
+        uint64_t data = (static_cast<uint64_t>(version) << 32) | floatBits(value);
+        bucket.entries[victim].data.store(data, std::memory_order_relaxed);
+        bucket.entries[victim].check.store(key ^ data, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Веса сети изменились: все записи становятся устаревшими.
+     */
+    inline void invalidate() {
+        currentVersion.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    inline uint32_t weightsVersion() const {
+        return currentVersion.load(std::memory_order_relaxed);
+    }
+
+    inline std::size_t capacity() const {
+        return bucketsCount * WAYS;
+    }
+
+    inline uint64_t hits() const {
+        return hitsCount.load(std::memory_order_relaxed);
+    }
+
+    inline uint64_t misses() const {
+        return missesCount.load(std::memory_order_relaxed);
+    }
+
+    /// Вытеснения актуальных записей: если их много, кешу не хватает памяти
+    inline uint64_t evictions() const {
+        return evictionsCount.load(std::memory_order_relaxed);
+    }
+
+    inline float hitRate() const {
+        uint64_t total = hits() + misses();
+        return total == 0 ? 0.0f : static_cast<float>(hits()) / static_cast<float>(total);
+    }
+
+    void resetStats() {
+        hitsCount = 0;
+        missesCount = 0;
+        evictionsCount = 0;
+    }
+
+private:
+    struct Entry {
+        std::atomic<uint64_t> check{0}; ///< key ^ data
+        std::atomic<uint64_t> data{0}; ///< версия весов (старшие 32 бита) | биты float (младшие 32)
+    };
+
+    struct alignas(64) Bucket {
+        Entry entries[WAYS];
+    };
+
+    std::size_t bucketsCount;
+    std::size_t bucketMask;
+    std::unique_ptr<Bucket[]> buckets;
+    /// На набор: биты 0-3 — "недавно использована" для каждого канала, биты 4-5 — стрелка CLOCK
+    std::unique_ptr<std::atomic<uint8_t>[]> clockState;
+    std::atomic<uint32_t> currentVersion; ///< Версия 0 — пустые записи, поэтому начинаем с 1
+    std::atomic<uint64_t> hitsCount;
+    std::atomic<uint64_t> missesCount;
+    std::atomic<uint64_t> evictionsCount;
+
+    static inline uint32_t versionOf(uint64_t data) {
+        return static_cast<uint32_t>(data >> 32);
+    }
+
+    static inline float valueOf(uint64_t data) {
+        uint32_t bits = static_cast<uint32_t>(data);
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    static inline uint64_t floatBits(float value) {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    }
+
+    inline void markReferenced(std::size_t b, int way) {
+        uint8_t bit = static_cast<uint8_t>(1 << way);
+        if ((clockState[b].load(std::memory_order_relaxed) & bit) == 0) {
+            clockState[b].fetch_or(bit, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief CLOCK: стрелка пропускает каналы с битом использования (сбрасывая его)
+     *        и останавливается на первом без него. Гонки здесь влияют только на выбор жертвы.
+     */
+    inline int clockVictim(std::size_t b) {
+        uint8_t state = clockState[b].load(std::memory_order_relaxed);
+        int hand = (state >> 4) & (WAYS - 1);
+        while (state & (1 << hand)) {
+            state &= ~(1 << hand);
+            hand = (hand + 1) & (WAYS - 1);
+        }
+        int victim = hand;
+        hand = (hand + 1) & (WAYS - 1);
+        clockState[b].store(static_cast<uint8_t>((state & 0x0F) | (hand << 4)), std::memory_order_relaxed);
+        return victim;
+    }
+};
@@ -1,56 +1,123 @@
 // Map_T.h
 #pragma once
 
-#include "structures/robin_lib/robin_map.h" // Заголовок из библиотеки tsl::robin_map
+#include <thread>
+
+#include "structures/ConcurrentTable.h"
+#include "structures/NodeArena.h"
+#include "structures/SearchNode.h"
 #include "big_board/BigBoard.h"
 
 
+/**
+ * @brief Карта оценок v(s) и v'(s,a), общая для всех потоков Descent.
+ *
+ * Каждое состояние — одна запись SearchNode (v(s), ходы, v'(s,a), виртуальные штрафы)
+ * в NodeArena; хеш-таблица хранит только ссылку на неё. Descent находит запись одной
+ * пробой и дальше работает с детьми по индексу, без хеширования пар (s,a).
+ *
+ * Ключи канонические (BigBoard::canonicalKey), ходы в записи — BigBoard::canonicalMove,
+ * поэтому симметричные позиции делят одну запись.
+ */
 class Map_T {
 public:
-    explicit Map_T(size_t reserve_size_states = 1024, size_t reserve_size_state_actions = 1024) {
-        state_valueMap.reserve(reserve_size_states);
-        state_action_valueMap.reserve(reserve_size_state_actions);
+    explicit Map_T(size_t reserve_size_states = 1 << 17)
+        : nodeIndex(reserve_size_states) {
+    }
+
+    /**
+     * @brief Запись состояния (одна проба) или nullptr, если её ещё нет.
+     */
+    inline SearchNode *findNode(const BigBoard *s) const {
+        const ConcurrentTable::Entry *e = nodeIndex.find(s->canonicalKey);
+        if (e == nullptr) {
+            return nullptr;
+        }
+        int32_t published = e->counter.load(std::memory_order_acquire);
+        return published == 0 ? nullptr : resolve(published);
     }
 
-    inline float &operator()(BigBoard *s) {
-        return state_valueMap[s->hashKey]; // Позволяет присваивать и получать
+    /**
+     * @brief Создаёт запись раскрываемого s с детьми canonicalMoves (без повторов).
+     *
+     * Вызывает только поток, занявший s (Set_S::tryClaim); остальные получают запись
+     * через findNode() после Set_S::waitReady().
+     */
+    SearchNode *createNode(const BigBoard *s, const uint8_t *canonicalMoves, int count) {
+        ConcurrentTable::Entry &e = nodeIndex.findOrInsert(s->canonicalKey);
+        uint32_t ref;
+        uint32_t *memory = arena.allocate(SearchNode::wordsFor(count), ref);
+        SearchNode *node = SearchNode::construct(memory, canonicalMoves, count);
+        e.counter.store(static_cast<int32_t>(ref + 1), std::memory_order_release);
+        return node;
     }
 
-    inline float &operator()(BigBoard *s, uint8_t a) {
-        uint64_t hashKey = combineStateHashWithMove(s->hashKey, a);
-        return state_action_valueMap[hashKey]; // Позволяет присваивать и получать
+    /**
+     * @brief v(s). Терминальным состояниям (у них нет детей) запись создаётся при первом обращении.
+     */
+    inline std::atomic<float> &operator()(const BigBoard *s) {
+        bool inserted;
+        ConcurrentTable::Entry &e = nodeIndex.findOrInsert(s->canonicalKey, inserted);
+        if (inserted) {
+            uint32_t ref;
+            SearchNode *node = SearchNode::construct(arena.allocate(SearchNode::wordsFor(0), ref), nullptr, 0);
+            e.counter.store(static_cast<int32_t>(ref + 1), std::memory_order_release);
+            return node->value;
+        }
+        int32_t published;
+        while ((published = e.counter.load(std::memory_order_acquire)) == 0) {
+            std::this_thread::yield(); // запись публикует вставивший ключ поток
+        }
+        return resolve(published)->value;
+    }
+
+    /**
+     * @brief v'(s,a) для выбора хода после поиска (по одной пробе на вызов; в Descent не используется).
+     * @return 0, если s не раскрыто
+     */
+    inline float operator()(const BigBoard *s, uint8_t a) const {
+        SearchNode *node = findNode(s);
+        if (node == nullptr) {
+            return 0.0f;
+        }
+        int i = node->indexOf(s->canonicalMove(a));
+        return i < 0 ? 0.0f : node->childValues()[i].load(std::memory_order_relaxed);
     }
 
     void clear() {
-        state_valueMap.clear(); //не сокращает capacity, а только удаляет элементы. То есть исходный bucket_count сохранится.
-        state_action_valueMap.clear();
+        nodeIndex.clear(); //не сокращает capacity, а только удаляет элементы
+        arena.clear();
     }
 
-    inline size_t sizeStates() const {
-        return state_valueMap.size();
+    /**
+     * @brief Однопоточная подготовка к ходу: при необходимости расширяет индекс.
+     *        Сами записи не перемещаются.
+     */
+    void prepareForConcurrentPhase() {
+        nodeIndex.prepareForConcurrentPhase();
     }
 
-    inline size_t sizeStateActions() const {
-        return state_action_valueMap.size();
+    inline bool isNearlyFull() const {
+        return nodeIndex.isNearlyFull() || arena.isNearlyFull();
     }
 
-    inline bool contains(const BigBoard *s) const {
-        return state_valueMap.contains(s->hashKey);
+    inline size_t sizeStates() const {
+        return nodeIndex.size();
+    }
+
+    inline size_t memoryBytes() const {
+        return arena.usedBytes();
     }
 
-    inline bool containsStateAction(const BigBoard *s, uint8_t a) const {
-        uint64_t hashKey = combineStateHashWithMove(s->hashKey, a);
-        return state_action_valueMap.contains(hashKey);
+    inline bool contains(const BigBoard *s) const {
+        return findNode(s) != nullptr;
     }
 
 private:
-    tsl::robin_map<uint64_t, float> state_valueMap;
-    tsl::robin_map<uint64_t, float> state_action_valueMap;
-
-    inline uint64_t combineStateHashWithMove(uint64_t stateHash, uint8_t move) const {
-        stateHash ^= static_cast<uint64_t>(move) * 0x87c37b91114253d5ULL;
-        stateHash = (stateHash << 31) | (stateHash >> 33);
-        stateHash *= 0x4cf5ad432745937fULL;
-        return stateHash;
+    ConcurrentTable nodeIndex; ///< canonicalKey -> ссылка на SearchNode + 1 (в counter; 0 — ещё не опубликована)
+    NodeArena arena;
+
+    inline SearchNode *resolve(int32_t published) const {
+        return reinterpret_cast<SearchNode *>(arena.resolve(static_cast<uint32_t>(published) - 1));
     }
 };
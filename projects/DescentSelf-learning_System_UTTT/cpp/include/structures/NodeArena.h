@@ -0,0 +1,101 @@
+// NodeArena.h
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+/**
+ * @brief Память под записи SearchNode: блоки по 16 МБ, выделение сдвигом курсора (CAS).
+ *
+ * Записи никогда не перемещаются, поэтому адреса v'(s,a) (LeafBatch) и указатели на узлы
+ * (приостановленные итерации) действительны до clear(). Освобождения отдельных записей нет:
+ * clear() после партии (ReplayBuffer::moveAll) сбрасывает курсор, а блоки переиспользуются.
+ *
+ * Запись адресуется 31-битной ссылкой (номер блока, смещение в словах) —
+ * она хранится в counter ячейки ConcurrentTable.
+ */
+class NodeArena {
+public:
+    static constexpr int CHUNK_BITS = 22;
+    static constexpr std::size_t CHUNK_WORDS = std::size_t{1} << CHUNK_BITS; ///< 4M слов = 16 МБ
+    static constexpr int MAX_CHUNKS = 256; ///< Предел 4 ГБ на одну партию
+
+    NodeArena() : cursor(0) {
+        for (std::atomic<uint32_t *> &chunk: chunks) {
+            chunk.store(nullptr, std::memory_order_relaxed);
+        }
+    }
+
+    NodeArena(const NodeArena &) = delete;
+
+    NodeArena &operator=(const NodeArena &) = delete;
+
+    ~NodeArena() {
+        for (std::atomic<uint32_t *> &chunk: chunks) {
+            delete[] chunk.load(std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief Выделяет words слов (потокобезопасно). Запись не пересекает границу блока.
+     * @param ref - ссылка на выделенную память для resolve()
+     */
+    inline uint32_t *allocate(std::size_t words, uint32_t &ref) {
+        uint64_t position = cursor.load(std::memory_order_relaxed);
+        uint64_t start;
+        do {
+            start = position;
+            if ((start & (CHUNK_WORDS - 1)) + words > CHUNK_WORDS) {
+                start = ((start >> CHUNK_BITS) + 1) << CHUNK_BITS; // остаток блока пропускаем
+            }
+        } while (!cursor.compare_exchange_weak(position, start + words, std::memory_order_relaxed));
+
+        const std::size_t chunkIndex = start >> CHUNK_BITS;
+        ref = static_cast<uint32_t>(start);
+        return ensureChunk(chunkIndex) + (start & (CHUNK_WORDS - 1));
+    }
+
+    inline uint32_t *resolve(uint32_t ref) const {
+        return chunks[ref >> CHUNK_BITS].load(std::memory_order_acquire) + (ref & (CHUNK_WORDS - 1));
+    }
+
+    /**
+     * Последние два блока — запас для итераций, которые ещё не заметили заполнения:
+     * Descent перестаёт раскрывать новые узлы на этой границе.
+     */
+    inline bool isNearlyFull() const {
+        return (cursor.load(std::memory_order_relaxed) >> CHUNK_BITS) >= MAX_CHUNKS - 2;
+    }
+
+    /// Занятая память в байтах (включая пропущенные хвосты блоков)
+    inline std::size_t usedBytes() const {
+        return cursor.load(std::memory_order_relaxed) * sizeof(uint32_t);
+    }
+
+    /**
+     * @brief Все записи становятся недействительными; блоки остаются для следующей партии (однопоточно).
+     */
+    void clear() {
+        cursor.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<uint64_t> cursor; ///< Глобальное смещение в словах: номер блока << CHUNK_BITS | смещение в блоке
+    std::atomic<uint32_t *> chunks[MAX_CHUNKS];
+    std::mutex chunkMutex; ///< Только для выделения нового блока
+
+    inline uint32_t *ensureChunk(std::size_t chunkIndex) {
+        uint32_t *chunk = chunks[chunkIndex].load(std::memory_order_acquire);
+        if (chunk == nullptr) [[unlikely]] {
+            std::lock_guard<std::mutex> lock(chunkMutex);
+            chunk = chunks[chunkIndex].load(std::memory_order_relaxed);
+            if (chunk == nullptr) {
+                chunk = new uint32_t[CHUNK_WORDS];
+                chunks[chunkIndex].store(chunk, std::memory_order_release);
+            }
+        }
+        return chunk;
+    }
+};
@@ -10,10 +10,17 @@
 #include "big_board/BigBoard.h"
 
 struct StateValuePair {
-    BigBoard *board;
+    PackedBoard board; // BigBoard восстанавливается через BigBoard::unpack
     float value;
 };
 
+/**
+ * @brief Кольцевой буфер пар (состояние, значение) с фиксированными ячейками.
+ *
+ * Все массивы выделяются один раз в конструкторе: moveAll копирует упакованные состояния
+ * прямо в ячейки кольца (вытесняя самые старые), getSample — в заранее выделенный sampleArray.
+ * Во время самоигры и обучения буфер не обращается к куче.
+ */
 class ReplayBuffer {
 public:
     size_t newAddedCount; //отслеживает количество добавленных элементов перед выборкой
@@ -31,22 +38,15 @@ public:
         // Выделяем память под массив ReplayItem размером maxSize
         bufferArray = new StateValuePair[maxBufferSize];
         for (size_t i = 0; i < maxBufferSize; ++i) {
-            bufferArray[i].board = nullptr;
+            bufferArray[i].board = PackedBoard{};
             bufferArray[i].value = 0.0f;
         }
         sampleArray = nullptr;
+        sampleArrayCheckGrow(params::SAMPLE_SIZE);
         indices = new size_t[maxBufferSize];
     }
 
-    /**
-     * Деструктор:
-     * освобождаем все BigBoard*, которые ещё хранятся в буфере,
-     * и сам массив m_buffer.
-     */
     ~ReplayBuffer() {
-        for (size_t i = 0; i < maxBufferSize; ++i) {
-            delete bufferArray[i].board;
-        }
         delete[] bufferArray;
         delete[] sampleArray;
         delete[] indices;
@@ -59,10 +59,7 @@ public:
     /**
      * Добавить пару (board, value) в буфер.
      */
-    void add(BigBoard *s, float v) {
-        if (bufferFull) [[likely]] {
-            delete bufferArray[insertPos].board;
-        }
+    void add(const PackedBoard &s, float v) {
         bufferArray[insertPos].board = s;
         bufferArray[insertPos].value = v;
 
@@ -75,15 +72,16 @@ public:
     }
 
     /**
-     *   Забирает все указатели на состояния (BigBoard * board),
-     *   Для каждой board берет значение (value) из Map_T T,
+     *   Забирает все упакованные состояния из Set_S S,
+     *   Для каждого берет значение (value) из Map_T T (по ключу распакованной доски),
      */
     void moveAll(Set_S &S, Map_T &V) {
         size_t S_size;
-        BigBoard **states = S.getAllStates(S_size);
+        const PackedBoard *states = S.getAllStates(S_size);
+        BigBoard board;
         for (int i = 0; i < S_size; ++i) {
-            BigBoard *board = states[i];
-            add(board, V(board));
+            board.unpack(states[i]);
+            add(states[i], V(&board));
         }
         S.clear();
         V.clear();
@@ -100,26 +98,20 @@ public:
      * Получить случайную выборку элементов из буфера.
      */
     StateValuePair *getSample(size_t &outSampleSize) {
-        size_t sampleSize = params::SAMPLE_SIZE;
-        sampleArrayCheckGrow(sampleSize);
+        sampleArrayCheckGrow(params::SAMPLE_SIZE);
         const size_t bufferActualSize = bufferSize();
-        //------shuffle----------
-        for (size_t i = 0; i < bufferActualSize; ++i) {
-            indices[i] = i;
+        const size_t sampleSize = std::min<size_t>(params::SAMPLE_SIZE, bufferActualSize);
+        // indices — перестановка [0, bufferActualSize) между вызовами; дописываем ячейки, заполненные с прошлой выборки
+        for (; indicesSize < bufferActualSize; ++indicesSize) {
+            indices[indicesSize] = indicesSize;
         }
-        std::shuffle(indices, indices + bufferActualSize, generator);
-        //-----------------------
-        if (bufferActualSize <= sampleSize) [[unlikely]] {
-            for (size_t i = 0; i < bufferActualSize; ++i) {
-                sampleArray[i] = bufferArray[indices[i]];
-            }
-            outSampleSize = bufferActualSize;
-        } else {
-            for (size_t i = 0; i < sampleSize; ++i) {
-                sampleArray[i] = bufferArray[indices[i]];
-            }
-            outSampleSize = sampleSize;
+        //------частичный Фишер–Йейтс: перемешиваем только первые sampleSize позиций, O(sampleSize)------
+        for (size_t i = 0; i < sampleSize; ++i) {
+            std::uniform_int_distribution<size_t> pick(i, bufferActualSize - 1);
+            std::swap(indices[i], indices[pick(generator)]);
+            sampleArray[i] = bufferArray[indices[i]];
         }
+        outSampleSize = sampleSize;
         newAddedCount = 0;
         return sampleArray;
     }
@@ -130,6 +122,7 @@ private:
     StateValuePair *bufferArray;
     StateValuePair *sampleArray;
     size_t *indices; // массив индексов для шафла
+    size_t indicesSize = 0; // сколько первых indices уже заполнено (перестановка ячеек буфера)
     bool bufferFull; // Флаг, что буфер заполнен
     size_t insertPos; // Текущая позиция для записи
     std::mt19937 generator; // Генератор случайных чисел
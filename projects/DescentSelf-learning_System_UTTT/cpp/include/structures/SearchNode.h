@@ -0,0 +1,87 @@
+// SearchNode.h
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+/**
+ * @brief Запись состояния в Map_T: v(s) и все v'(s,a) одним непрерывным блоком.
+ *
+ * Расположение в памяти (NodeArena, слова по 4 байта):
+ *   [value][movesCount] [childValues × n] [inFlight × n] [moves × n байт, до целого слова]
+ *
+ * Ходы хранятся в координатах канонического образа позиции (BigBoard::canonicalMove),
+ * по одному на класс симметричных ходов; обратно — BigBoard::moveFromCanonical.
+ * best_action(s) — линейный проход по childValues без обращений к хеш-таблице.
+ */
+struct SearchNode {
+    std::atomic<float> value; ///< v(s)
+    uint8_t movesCount; ///< Число детей (0 — терминальное состояние)
+
+    /// Размер записи с movesCount детьми в 4-байтовых словах
+    static constexpr std::size_t wordsFor(int movesCount) {
+        return sizeof(SearchNode) / sizeof(uint32_t) + 2 * movesCount + (movesCount + 3) / 4;
+    }
+
+    /**
+     * @brief Конструирует запись в памяти arena (wordsFor(count) слов): v(s) = 0, v'(s,a) = 0.
+     */
+    static SearchNode *construct(uint32_t *memory, const uint8_t *canonicalMoves, int count) {
+        SearchNode *node = new(memory) SearchNode;
+        node->value.store(0.0f, std::memory_order_relaxed);
+        node->movesCount = static_cast<uint8_t>(count);
+        for (int i = 0; i < count; ++i) {
+            new(node->childValues() + i) std::atomic<float>(0.0f);
+            new(node->inFlight() + i) std::atomic<int32_t>(0);
+            node->moves()[i] = canonicalMoves[i];
+        }
+        return node;
+    }
+
+    /// v'(s,a) детей
+    inline std::atomic<float> *childValues() {
+        return reinterpret_cast<std::atomic<float> *>(this + 1);
+    }
+
+    /// Число потоков/итераций, спускающихся сейчас через ребёнка, — для виртуального штрафа
+    inline std::atomic<int32_t> *inFlight() {
+        return reinterpret_cast<std::atomic<int32_t> *>(childValues() + movesCount);
+    }
+
+    /**
+     * v'(s,a) как обычные float — для векторного чтения (valueKernels).
+     * Только когда значения узла пишет тот же поток (последовательный и асинхронный Descent).
+     */
+    inline const float *childValuesUnsynchronized() {
+        return reinterpret_cast<const float *>(childValues());
+    }
+
+    inline const int32_t *inFlightUnsynchronized() {
+        return reinterpret_cast<const int32_t *>(inFlight());
+    }
+
+    /// Канонические ходы детей
+    inline uint8_t *moves() {
+        return reinterpret_cast<uint8_t *>(inFlight() + movesCount);
+    }
+
+    /**
+     * @return индекс ребёнка с каноническим ходом canonicalMove или -1
+     */
+    inline int indexOf(uint8_t canonicalMove) {
+        const uint8_t *m = moves();
+        for (int i = 0; i < movesCount; ++i) {
+            if (m[i] == canonicalMove) {
+                return i;
+            }
+        }
+        return -1;
+    }
+};
+
+static_assert(sizeof(SearchNode) % sizeof(uint32_t) == 0 && alignof(SearchNode) <= alignof(uint32_t),
+              "SearchNode is laid out in 4-byte NodeArena words");
+static_assert(sizeof(std::atomic<float>) == sizeof(float) && sizeof(std::atomic<int32_t>) == sizeof(int32_t),
+              "SearchNode arrays assume lock-free 4-byte atomics");
@@ -1,22 +1,37 @@
 // Set_S.h
 #pragma once
 
-#include "structures/robin_lib/robin_set.h"
+#include <atomic>
+
+#include "structures/ConcurrentTable.h"
 #include "big_board/BigBoard.h"
 
+/**
+ * @brief Множество посещённых состояний S, общее для всех потоков Descent.
+ *
+ * Для каждого ключа хранится флаг готовности: состояние, занятое одним потоком
+ * под раскрытие, становится "готовым" только после записи всех v'(s,a).
+ * Остальные потоки спят в waitReady() (atomic::wait на флаге), пока markReady() их не разбудит.
+ *
+ * Ключ — BigBoard::canonicalKey: из симметричных позиций в S попадает одна (первая встреченная).
+ * Сами состояния хранятся упакованными (PackedBoard, 18 байт) — без копии BigBoard в куче на каждое.
+ */
 class Set_S {
 private:
-    size_t capacity; // Выделенная ёмкость
-    tsl::robin_set<uint64_t> setHashKeys; // Robin-set для быстрого поиска уникальных указателей
-    BigBoard **arrayStates; // массив состояний
+    static constexpr int32_t PENDING = 0;
+    static constexpr int32_t READY = 1;
+
+    size_t capacity; // Выделенная ёмкость массива состояний
+    ConcurrentTable setHashKeys; // Хеши состояний + флаг готовности
+    PackedBoard *arrayStates; // массив состояний
 public:
-    size_t size; // Текущее количество элементов
+    std::atomic<size_t> size; // Текущее количество элементов
 
-    Set_S(size_t initial_capacity = 1024)
-        : arrayStates(new BigBoard *[initial_capacity]),
-          size(0),
-          capacity(initial_capacity) {
-        setHashKeys.reserve(initial_capacity); // Резервируем начальную ёмкость для robin_set
+    Set_S(size_t initial_capacity = 1 << 17)
+        : capacity(initial_capacity),
+          setHashKeys(initial_capacity),
+          arrayStates(new PackedBoard[initial_capacity]),
+          size(0) {
     }
 
     // Запрещаем конструктор копирования
@@ -30,32 +45,79 @@ public:
         delete[] arrayStates;
     }
 
-    // Добавление указателя
-    void add(BigBoard *bigBoard) {
-        uint64_t hashKey = bigBoard->hashKey;
-        if (setHashKeys.contains(hashKey)) [[unlikely]] {
-            return;
+    // Добавление готового состояния (терминального или уже раскрытого)
+    inline void add(BigBoard *bigBoard) {
+        if (tryClaim(bigBoard)) {
+            markReady(bigBoard);
         }
+    }
 
-        if (size == capacity) [[unlikely]] {
-            grow();
+    /**
+     * @brief Атомарно добавляет состояние в S со статусом "раскрывается".
+     * @return true, если именно этот поток добавил состояние и должен его раскрыть.
+     */
+    inline bool tryClaim(BigBoard *bigBoard) {
+        bool inserted;
+        setHashKeys.findOrInsert(bigBoard->canonicalKey, inserted);
+        if (!inserted) [[unlikely]] {
+            return false;
+        }
+        size_t index = size.fetch_add(1, std::memory_order_relaxed);
+        arrayStates[index] = bigBoard->pack(); // Добавляем в массив
+        return true;
+    }
+
+    inline void markReady(const BigBoard *bigBoard) {
+        std::atomic<int32_t> &ready = setHashKeys.findOrInsert(bigBoard->canonicalKey).counter;
+        ready.store(READY, std::memory_order_release);
+        ready.notify_all(); // без ждущих — без системного вызова
+    }
+
+    inline bool isReady(const BigBoard *bigBoard) const {
+        const ConcurrentTable::Entry *e = setHashKeys.find(bigBoard->canonicalKey);
+        return e != nullptr && e->counter.load(std::memory_order_acquire) == READY;
+    }
+
+    /**
+     * @brief Ожидает, пока поток, занявший состояние, закончит его раскрытие.
+     *        Раскрытие ждёт сети, поэтому поток спит, а не крутится, отнимая ядро у раскрывающего.
+     */
+    inline void waitReady(const BigBoard *bigBoard) const {
+        const ConcurrentTable::Entry *e = setHashKeys.find(bigBoard->canonicalKey);
+        int32_t state;
+        while ((state = e->counter.load(std::memory_order_acquire)) != READY) {
+            e->counter.wait(state, std::memory_order_acquire);
         }
-        setHashKeys.insert(hashKey); // Добавляем в robin_set
-        arrayStates[size++] = bigBoard->clone(); // Добавляем в массив
     }
 
     // Очистка без освобождения памяти
     void clear() {
         size = 0; // Сбрасываем размер массива
-        setHashKeys.clear(); // Очищаем robin_set
+        setHashKeys.clear();
     }
 
     // Проверка наличия элемента
-    inline bool contains(BigBoard *bigBoard) const {
-        return setHashKeys.contains(bigBoard->hashKey);
+    inline bool contains(const BigBoard *bigBoard) const {
+        return setHashKeys.find(bigBoard->canonicalKey) != nullptr;
     }
 
-    inline BigBoard **getAllStates(size_t &outSize) {
+    inline bool isNearlyFull() const {
+        return setHashKeys.isNearlyFull();
+    }
+
+    /**
+     * @brief Однопоточная подготовка к ходу: расширяет хеш-таблицу и массив состояний
+     *        с запасом, так чтобы параллельные вставки не требовали роста.
+     */
+    void prepareForConcurrentPhase() {
+        setHashKeys.prepareForConcurrentPhase();
+        // массив не переполнится раньше таблицы: isNearlyFull() срабатывает на 3/4 её ёмкости
+        while (capacity < setHashKeys.bucketCount()) {
+            grow();
+        }
+    }
+
+    inline const PackedBoard *getAllStates(size_t &outSize) const {
         outSize = size;
         return arrayStates;
     }
@@ -64,12 +126,10 @@ private:
     // Увеличение ёмкости массива
     inline void grow() {
         size_t new_capacity = capacity * 2;
-        BigBoard **new_data = new BigBoard *[new_capacity];
-        std::memcpy(new_data, arrayStates, size * sizeof(BigBoard *)); // Копируем указатели побайтно
+        PackedBoard *new_data = new PackedBoard[new_capacity];
+        std::memcpy(new_data, arrayStates, size * sizeof(PackedBoard)); // Копируем состояния побайтно
         delete[] arrayStates;
         arrayStates = new_data;
         capacity = new_capacity;
-
-        setHashKeys.reserve(new_capacity); // Резервируем ёмкость для robin_set
     }
 };
@@ -0,0 +1,122 @@
+// WorkerPool.h
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Постоянные рабочие потоки для параллельных циклов по непересекающимся участкам
+ *        (конвертация состояний в каналы сети: SampleTrainer, LeafBatch).
+ *
+ * parallelFor делит [0, count) на непрерывные участки: первый выполняет вызывающий поток,
+ * остальные — рабочие; возврат — после завершения всех участков. Потоки создаются один раз,
+ * поэтому вызов стоит одного пробуждения, а не запуска потоков.
+ * Одновременные вызовы parallelFor из разных потоков не поддерживаются.
+ */
+class WorkerPool {
+public:
+    /**
+     * @param threads Всего потоков вместе с вызывающим (0 — std::thread::hardware_concurrency())
+     */
+    explicit WorkerPool(int threads = 1) {
+        if (threads <= 0) {
+            threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+        }
+        workers.reserve(threads - 1);
+        for (int t = 1; t < threads; ++t) {
+            workers.emplace_back([this, t] { workerLoop(t); });
+        }
+    }
+
+    WorkerPool(const WorkerPool &) = delete;
+
+    WorkerPool &operator=(const WorkerPool &) = delete;
+
+    ~WorkerPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (std::thread &worker: workers) {
+            worker.join();
+        }
+    }
+
+    inline int threadCount() const {
+        return static_cast<int>(workers.size()) + 1;
+    }
+
+    /**
+     * @brief Вызывает body(begin, end) на участках [0, count), по одному на поток.
+     * @param minChunk Минимум элементов на поток: короткие циклы выполняются целиком в вызывающем потоке
+     */
+    template<class Body>
+    void parallelFor(size_t count, size_t minChunk, Body &&body) {
+        size_t chunks = std::min<size_t>(threadCount(), (count + minChunk - 1) / minChunk);
+        if (chunks <= 1) {
+            body(size_t(0), count);
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            job = [&body](size_t begin, size_t end) { body(begin, end); };
+            jobCount = count;
+            jobChunks = chunks;
+            pending = chunks - 1;
+            ++generation;
+        }
+        wake.notify_all();
+        body(size_t(0), chunkEnd(0));
+
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [this] { return pending == 0; });
+        job = nullptr;
+    }
+
+private:
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake; ///< Новый цикл или остановка
+    std::condition_variable done; ///< Все рабочие закончили свои участки
+    std::function<void(size_t, size_t)> job;
+    size_t jobCount = 0;
+    size_t jobChunks = 0;
+    size_t pending = 0; ///< Участки рабочих, ещё не завершённые в текущем цикле
+    uint64_t generation = 0; ///< Номер цикла parallelFor — по нему рабочие отличают новый цикл
+    bool stopping = false;
+
+    /// Конец участка chunk (начало — chunkEnd(chunk - 1)), при jobChunks участках
+    inline size_t chunkEnd(size_t chunk) const {
+        return jobCount * (chunk + 1) / jobChunks;
+    }
+
+    void workerLoop(size_t index) {
+        uint64_t seenGeneration = 0;
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            wake.wait(lock, [&] { return stopping || generation != seenGeneration; });
+            if (stopping) {
+                return;
+            }
+            seenGeneration = generation;
+            if (index >= jobChunks) {
+                continue; // короткий цикл: участка для этого потока нет
+            }
+            size_t begin = chunkEnd(index - 1);
+            size_t end = chunkEnd(index);
+            lock.unlock();
+            job(begin, end);
+            lock.lock();
+            if (--pending == 0) {
+                done.notify_one();
+            }
+        }
+    }
+};
@@ -37,36 +37,46 @@ public:
         // 2) Заполняем sharedMem_.intVars[0] числом образцов
         sharedMem_.intVars[0] = static_cast<int>(sampleSize);
 
-        // 3) Для каждого i-го элемента семпла
+        // 3) Для каждого i-го элемента семпла (участки семпла — по потокам convertPool)
         //    - конвертируем board -> 9×9×6 каналы + 3×3×2 macro
         //    - пишем value (при player == O -> val = -val)
-        uint8_t *dstMain = sharedMem_.sampleMainChannels;
-        uint8_t *dstMacro = sharedMem_.sampleMacroChannels;
+        sharedMem_.convertPool.parallelFor(sampleSize, params::CONVERT_MIN_CHUNK, [&](size_t begin, size_t end) {
+            convertRange(sampleData, begin, end);
+        });
+
+        // 4) Вызываем Python-метод Learn(), чтобы обучить нейросеть
+        sharedMem_.Learn();
+    }
+
+private:
+    ReplayBuffer &replayBuffer_;
+    SharedMemory &sharedMem_;
+
+    /**
+     * @brief Конвертирует элементы семпла [begin, end) в их (непересекающиеся) участки буферов sharedMem_.
+     */
+    void convertRange(const StateValuePair *sampleData, size_t begin, size_t end) const {
+        uint8_t *dstMain = sharedMem_.sampleMainChannels + begin * stateToChannels::MAIN_BYTES;
+        uint8_t *dstMacro = sharedMem_.sampleMacroChannels + begin * stateToChannels::MACRO_BYTES;
         float *dstVals = sharedMem_.sampleValues;
 
-        for (size_t i = 0; i < sampleSize; i++) {
-            const BigBoard *board = sampleData[i].board;
+        BigBoard board; // одна доска на участок: состояния в буфере упакованы
+        for (size_t i = begin; i < end; i++) {
+            board.unpack(sampleData[i].board);
             float val = sampleData[i].value;
 
             // Конвертируем board в каналы
-            stateToChannels::convert(board, dstMain, dstMacro);
+            stateToChannels::convert(&board, dstMain, dstMacro);
 
             // Если ход у O, переворачиваем знак оценки
-            if (board->getCurrentPlayer() == cell::O) {
+            if (board.getCurrentPlayer() == cell::O) {
                 val = -val;
             }
             dstVals[i] = val;
 
             // Сдвигаемся на следующий блок
-            dstMain += (9 * 9 * 6);
-            dstMacro += (3 * 3 * 2);
+            dstMain += stateToChannels::MAIN_BYTES;
+            dstMacro += stateToChannels::MACRO_BYTES;
         }
-
-        // 4) Вызываем Python-метод Learn(), чтобы обучить нейросеть
-        sharedMem_.Learn();
     }
-
-private:
-    ReplayBuffer &replayBuffer_;
-    SharedMemory &sharedMem_;
 };
@@ -1,18 +1,29 @@
-#include "boards/precalculated/precalculated_small_boards.h"
 #include <cstdlib>
 
 #include "selfplay/SelfPlayer.h"
+#include "selfplay/SelfPlayPool.h"
 #include "structures/ReplayBuffer.h"
 #include "training/SampleTrainer.h"
 
 
 int main() {
     srand(params::SEED);
-    precalculateSmallBoardsArray();
-    SharedMemory sharedMemory(params::SAMPLE_SIZE);
+    SharedMemory sharedMemory(params::SAMPLE_SIZE, params::EVALUATION_CACHE_MB << 20, params::CONVERT_THREADS,
+                              params::INFERENCE_CLIENT ? params::INFERENCE_SERVER_NAME : "");
+    if constexpr (params::NATIVE_EVALUATOR) {
+        sharedMemory.useNativeEvaluator(params::NATIVE_WEIGHTS_PATH, params::NATIVE_INT8_CALIBRATION_STATES,
+                                        params::NATIVE_INT8_HELDOUT_STATES);
+    }
     ReplayBuffer replayBuffer;
-    SelfPlayer selfPlayer(replayBuffer, sharedMemory);
     SampleTrainer trainer(replayBuffer, sharedMemory);
+    if constexpr (params::SELF_PLAY_GAMES > 1) {
+        SelfPlayPool selfPlayPool(replayBuffer, sharedMemory, params::SELF_PLAY_GAMES);
+        while (true) {
+            selfPlayPool.runSelfPlay();
+            trainer.trainSample();
+        }
+    }
+    SelfPlayer selfPlayer(replayBuffer, sharedMemory);
     while (true) {
         selfPlayer.runSelfPlay();
         trainer.trainSample();
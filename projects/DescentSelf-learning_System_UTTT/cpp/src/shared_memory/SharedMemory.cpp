@@ -2,6 +2,7 @@
 #include "shared_memory/SharedMemory.h"
 #include "shared_memory/python_config.h"
 #include <pybind11/embed.h>  // для py::scoped_interpreter
+#include <algorithm>
 #include <cstring>           // memset
 #include <iostream>
 
@@ -16,8 +17,11 @@ py::module_ SharedMemory::moduleCppBindings_;
 // -----------------------------------------------------
 // Конструктор
 // -----------------------------------------------------
-SharedMemory::SharedMemory(std::size_t paramSampleLength)
-    : sampleLength(paramSampleLength) {
+SharedMemory::SharedMemory(std::size_t paramSampleLength, std::size_t evaluationCacheBytes, int convertThreads,
+                           const std::string &inferenceServer)
+    : sampleLength(paramSampleLength),
+      evaluationCache(evaluationCacheBytes),
+      convertPool(convertThreads) {
     // 1) Инициализируем Python (однократно)
     ensurePythonInitialized();
 
@@ -25,20 +29,28 @@ SharedMemory::SharedMemory(std::size_t paramSampleLength)
     ensureClassRegistered();
 
     // 3) Выделяем память под наши массивы
-    sampleMainChannels = new uint8_t[sampleLength * 9 * 9 * 6];
-    sampleMacroChannels = new uint8_t[sampleLength * 3 * 3 * 2];
+    sampleMainChannels = new uint8_t[sampleLength * stateToChannels::MAIN_BYTES];
+    sampleMacroChannels = new uint8_t[sampleLength * stateToChannels::MACRO_BYTES];
     sampleValues = new float[sampleLength];
     intVars = new int[intVarsCount];
     floatVars = new float[floatVarsCount];
 
     // 4) Обнулим всё для наглядности
-    std::memset(sampleMainChannels, 0, sampleLength * 9 * 9 * 6 * sizeof(uint8_t));
-    std::memset(sampleMacroChannels, 0, sampleLength * 3 * 3 * 2 * sizeof(uint8_t));
+    std::memset(sampleMainChannels, 0, sampleLength * stateToChannels::MAIN_BYTES * sizeof(uint8_t));
+    std::memset(sampleMacroChannels, 0, sampleLength * stateToChannels::MACRO_BYTES * sizeof(uint8_t));
     std::memset(sampleValues, 0, sampleLength * sizeof(float));
     std::memset(intVars, 0, intVarsCount * sizeof(int));
     std::memset(floatVars, 0, floatVarsCount * sizeof(float));
 
-    // 5) Импортируем Python-скрипт
+    // 5) Оценивает InferenceServer — модель в этом процессе не нужна;
+    //    иначе Python-скрипт загрузит первое обращение к модели (ensureScript)
+    if (!inferenceServer.empty() && !inferenceClient.connect(inferenceServer)) {
+        std::cout << "[SharedMemory] Evaluating with the local model" << std::endl;
+    }
+}
+
+void SharedMemory::loadScript() {
+    // 6) Импортируем Python-скрипт
     {
         py::module_ sys = py::module_::import("sys");
         // Пример для Windows: подставьте нужные пути
@@ -48,19 +60,33 @@ SharedMemory::SharedMemory(std::size_t paramSampleLength)
         shared_memory_script_ = py::module_::import("shared_memory_script");
     }
 
-    // 6) Вызываем init_arrays(self), чтобы Python сохранил ссылки на массивы
+    // 7) Вызываем init_arrays(self), чтобы Python сохранил ссылки на массивы
     shared_memory_script_.attr("init_arrays")(py::cast(this));
 
-    // 7) Сохраняем ссылки на функции Do, Evaluate, Learn
+    // 8) Сохраняем ссылки на функции Do, Evaluate, Learn
     do_func_ = shared_memory_script_.attr("Do");
     evaluate_func_ = shared_memory_script_.attr("Evaluate");
     learn_func_ = shared_memory_script_.attr("Learn");
+    export_native_func_ = shared_memory_script_.attr("export_native_weights");
 }
 
 // -----------------------------------------------------
 // Деструктор
 // -----------------------------------------------------
 SharedMemory::~SharedMemory() {
+    if (evaluatorThread.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(evaluationQueueMutex);
+            stopEvaluator = true;
+        }
+        evaluationSubmitted.notify_one();
+        if (PyGILState_Check()) {
+            py::gil_scoped_release releaseGil; // текущая оценка может ждать GIL
+            evaluatorThread.join();
+        } else {
+            evaluatorThread.join();
+        }
+    }
     delete[] sampleMainChannels;
     delete[] sampleMacroChannels;
     delete[] sampleValues;
@@ -70,10 +96,121 @@ SharedMemory::~SharedMemory() {
 }
 
 
+// -----------------------------------------------------
+// Оценка на C++ (ValueNet)
+// -----------------------------------------------------
+bool SharedMemory::useNativeEvaluator(const std::string &path, int calibrationStates, int heldOutStates) {
+    if (inferenceClient.isConnected()) {
+        std::cerr << "[SharedMemory] Native evaluator is not used: evaluation runs on the inference server" << std::endl;
+        return false;
+    }
+    nativeWeightsPath = path;
+    quantCalibrationStates = calibrationStates;
+    quantHeldOutStates = heldOutStates;
+    reloadNativeEvaluator();
+    return nativeNet.isLoaded();
+}
+
+bool SharedMemory::useNativeWeights(const std::string &path) {
+    if (inferenceClient.isConnected()) {
+        std::cerr << "[SharedMemory] Native evaluator is not used: evaluation runs on the inference server" << std::endl;
+        return false;
+    }
+    nativeWeightsPath.clear(); // без повторной выгрузки из Python
+    quantCalibrationStates = 0;
+    return nativeNet.load(path);
+}
+
+void SharedMemory::reloadNativeEvaluator() {
+    if (nativeWeightsPath.empty()) {
+        return;
+    }
+    ensureScript();
+    export_native_func_(nativeWeightsPath);
+    if (!nativeNet.load(nativeWeightsPath)) {
+        std::cerr << "[SharedMemory] Native evaluator disabled, falling back to Python Evaluate()" << std::endl;
+        nativeWeightsPath.clear();
+    }
+}
+
+void SharedMemory::calibrateNativeEvaluator(int sampleSize) {
+    if (quantCalibrationStates <= 0 || !nativeNet.isLoaded() || sampleSize < quantCalibrationStates) {
+        return;
+    }
+    nativeNet.calibrate(sampleMainChannels, sampleMacroChannels, quantCalibrationStates);
+    const int heldOut = std::min(quantHeldOutStates, sampleSize - quantCalibrationStates);
+    if (heldOut > 0) {
+        ValueNet::QuantError error = nativeNet.compareWithFloat(
+            sampleMainChannels + quantCalibrationStates * stateToChannels::MAIN_BYTES,
+            sampleMacroChannels + quantCalibrationStates * stateToChannels::MACRO_BYTES, heldOut);
+        std::cout << "[SharedMemory] int8 evaluator: calibrated on " << quantCalibrationStates
+                << " replay states, held-out " << heldOut << ": mean |v_int8 - v_fp32| = " << error.meanAbs
+                << ", max = " << error.maxAbs << std::endl;
+    }
+    nativeNet.setPrecision(ValueNet::Precision::INT8);
+}
+
+
+// -----------------------------------------------------
+// Асинхронная оценка
+// -----------------------------------------------------
+uint64_t SharedMemory::submitEvaluation(int offset, int count) {
+    uint64_t ticket;
+    {
+        std::lock_guard<std::mutex> lock(evaluationQueueMutex);
+        if (!evaluatorThread.joinable()) {
+            evaluatorThread = std::thread(&SharedMemory::evaluatorLoop, this);
+        }
+        evaluationQueue.push_back({offset, count});
+        ticket = submittedEvaluations++;
+    }
+    evaluationSubmitted.notify_one();
+    return ticket;
+}
+
+void SharedMemory::waitEvaluation(uint64_t ticket) {
+    if (pollEvaluation(ticket)) {
+        return;
+    }
+    std::unique_lock<std::mutex> lock(evaluationQueueMutex);
+    evaluationCompleted.wait(lock, [this, ticket] { return pollEvaluation(ticket); });
+}
+
+void SharedMemory::evaluatorLoop() {
+    std::unique_lock<std::mutex> lock(evaluationQueueMutex);
+    while (true) {
+        evaluationSubmitted.wait(lock, [this] { return stopEvaluator || !evaluationQueue.empty(); });
+        if (stopEvaluator) {
+            return;
+        }
+        const EvaluationRequest request = evaluationQueue.front();
+        evaluationQueue.pop_front();
+        lock.unlock();
+        {
+            std::lock_guard<std::mutex> evaluateLock(evaluateMutex);
+            intVars[0] = request.count;
+            intVars[evaluateOffsetVar] = request.offset;
+            EvaluateFromThread();
+        }
+        lock.lock();
+        completedEvaluations.fetch_add(1, std::memory_order_release);
+        evaluationCompleted.notify_all();
+    }
+}
+
+
 // -----------------------------------------------------
 // Геттеры для NumPy (без копий)
 // -----------------------------------------------------
 py::array_t<uint8_t> SharedMemory::get_sample_main_channels() {
+    py::capsule cap(sampleMainChannels, [](void *) {
+    });
+    if constexpr (stateToChannels::PACKED) {
+        // 2D: [sampleLength, 64] — биты каналов, распаковываются в Python (packed_inputs.py)
+        std::vector<ssize_t> packedShape{(ssize_t) sampleLength, (ssize_t) stateToChannels::MAIN_BYTES};
+        std::vector<ssize_t> packedStrides{(ssize_t) stateToChannels::MAIN_BYTES, (ssize_t) sizeof(uint8_t)};
+        return py::array_t<uint8_t>(packedShape, packedStrides, sampleMainChannels, cap);
+    }
     // 4D: [sampleLength, 9, 9, 6]
     std::vector<ssize_t> shape{
         (ssize_t) sampleLength, 9, 9, 6
@@ -86,12 +223,18 @@ py::array_t<uint8_t> SharedMemory::get_sample_main_channels() {
         1 * (ssize_t) sizeof(uint8_t)
     };
 
-    py::capsule cap(sampleMainChannels, [](void *) {
-    });
     return py::array_t<uint8_t>(shape, strides, sampleMainChannels, cap);
 }
 
 py::array_t<uint8_t> SharedMemory::get_sample_macro_chennels() {
+    py::capsule cap(sampleMacroChannels, [](void *) {
+    });
+    if constexpr (stateToChannels::PACKED) {
+        // 2D: [sampleLength, 3] — биты каналов
+        std::vector<ssize_t> packedShape{(ssize_t) sampleLength, (ssize_t) stateToChannels::MACRO_BYTES};
+        std::vector<ssize_t> packedStrides{(ssize_t) stateToChannels::MACRO_BYTES, (ssize_t) sizeof(uint8_t)};
+        return py::array_t<uint8_t>(packedShape, packedStrides, sampleMacroChannels, cap);
+    }
     // 4D: [sampleLength, 3, 3, 2]
     std::vector<ssize_t> shape{
         (ssize_t) sampleLength, 3, 3, 2
@@ -103,8 +246,6 @@ py::array_t<uint8_t> SharedMemory::get_sample_macro_chennels() {
         1 * (ssize_t) sizeof(uint8_t)
     };
 
-    py::capsule cap(sampleMacroChannels, [](void *) {
-    });
     return py::array_t<uint8_t>(shape, strides, sampleMacroChannels, cap);
 }
 
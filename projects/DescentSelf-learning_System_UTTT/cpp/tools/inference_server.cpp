@@ -0,0 +1,35 @@
+// inference_server.cpp
+//
+// Сервер оценки для нескольких self-play процессов Descent на одной машине (только Linux):
+//   InferenceServer [/descent_inference]
+// затем процессы Descent с params::INFERENCE_CLIENT = true. Модель (TensorFlow или ValueNet) загружается
+// один раз здесь; клиенты передают состояния через общую память и обучают ту же модель своими выборками.
+// Остановка — Ctrl+C / SIGTERM: клиенты переходят на собственную модель.
+
+#include <algorithm>
+#include <csignal>
+#include <iostream>
+#include <string>
+
+#include "inference_server/InferenceServer.h"
+#include "parameters.h"
+
+int main(int argc, char **argv) {
+    const std::string name = argc > 1 ? argv[1] : params::INFERENCE_SERVER_NAME;
+    SharedMemory sharedMemory(std::max(params::SAMPLE_SIZE, params::INFERENCE_SERVER_MAX_BATCH), 0,
+                              params::CONVERT_THREADS);
+    if constexpr (params::NATIVE_EVALUATOR) {
+        sharedMemory.useNativeEvaluator(params::NATIVE_WEIGHTS_PATH, params::NATIVE_INT8_CALIBRATION_STATES,
+                                        params::NATIVE_INT8_HELDOUT_STATES);
+    }
+
+    InferenceServer server(sharedMemory, params::INFERENCE_SERVER_MAX_BATCH, params::INFERENCE_SERVER_DEADLINE_US,
+                           params::INFERENCE_SERVER_REPORT_SECONDS);
+    if (!server.open(name, params::SAMPLE_SIZE)) {
+        return 1;
+    }
+    std::signal(SIGINT, [](int) { InferenceServer::requestStop(); });
+    std::signal(SIGTERM, [](int) { InferenceServer::requestStop(); });
+    server.run();
+    return 0;
+}
@@ -0,0 +1,45 @@
+// value_net_blob.cpp
+//
+// Файл весов native_export.py -> blob ValueNet (BatchNormalization свёрнута, веса разложены по панелям),
+// который DescentPlayer отображает в память вместо запуска TensorFlow:
+//   python native_export.py model_checkpoint.weights_7.h5 model_7.weights.bin
+//   ValueNetBlob model_7.weights.bin model_checkpoint.weights_7.vnet [model_checkpoint.weights_7.h5]
+// DescentPlayer ищет .vnet рядом с .h5 из LOAD_MODEL (то же имя, другое расширение) и берёт его, только если
+// отпечаток чекпоинта в blob (размер и хеш .h5) совпадает с этим .h5. Без третьего аргумента
+// чекпоинт — .h5 с именем blob-файла.
+
+#include <filesystem>
+#include <iostream>
+#include <string>
+
+#include "nn_inference/ValueNet.h"
+
+int main(int argc, char **argv) {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " <native weights .bin> <blob .vnet> [source checkpoint .h5]\n";
+        return 1;
+    }
+    const std::string checkpointPath = argc > 3 ? argv[3] : std::filesystem::path(argv[2]).replace_extension(".h5").string();
+    ValueNet::SourceStamp checkpoint;
+    if (!ValueNet::stampOf(checkpointPath, checkpoint)) {
+        std::cerr << "cannot read source checkpoint " << checkpointPath << std::endl;
+        return 1;
+    }
+    ValueNet net;
+    if (!net.load(argv[1])) {
+        return 1;
+    }
+    if (!net.saveBlob(argv[2], checkpoint)) {
+        std::cerr << "cannot write " << argv[2] << std::endl;
+        return 1;
+    }
+
+    // Отображённая копия должна быть той же сетью с тем же отпечатком чекпоинта
+    ValueNet mapped;
+    if (!mapped.mapBlob(argv[2]) || mapped.blobSource() != checkpoint) {
+        return 1;
+    }
+    std::cout << "blob written: " << argv[2] << " (checkpoint " << checkpointPath << ", " << checkpoint.bytes
+            << " bytes)" << std::endl;
+    return 0;
+}
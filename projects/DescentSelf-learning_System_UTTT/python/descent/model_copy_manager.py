@@ -2,6 +2,7 @@ import os
 import tensorflow as tf
 from tensorflow.keras.models import clone_model
 from checkpoint_manager import CheckpointManager
+from packed_inputs import is_packed, unpack_main_tf, unpack_macro_tf
 
 
 class ModelCopyManager:
@@ -85,12 +86,44 @@ class ModelCopyManager:
     def _predict_func_main(self, all_main_6, all_macro):
         return tf.reshape(self.main_model([all_main_6, all_macro], training=False), [-1])
 
+    def active_model(self):
+        """
+        Модель, на которой сейчас работает Evaluate(): expert_model или main_model.
+        """
+        return self.expert_model if self.use_expert_flag else self.main_model
+
+    # Упакованные входы (NN_INPUT_PACKED): uint8-биты из буферов C++ без копии, распаковка в графе
+    @tf.function(
+        input_signature=[
+            tf.TensorSpec(shape=(None, None), dtype=tf.uint8),
+            tf.TensorSpec(shape=(None, None), dtype=tf.uint8)
+        ]
+    )
+    def _predict_func_expert_packed(self, packed_main, packed_macro):
+        return self._predict_func_expert(unpack_main_tf(packed_main), unpack_macro_tf(packed_macro))
+
+    @tf.function(
+        input_signature=[
+            tf.TensorSpec(shape=(None, None), dtype=tf.uint8),
+            tf.TensorSpec(shape=(None, None), dtype=tf.uint8)
+        ]
+    )
+    def _predict_func_main_packed(self, packed_main, packed_macro):
+        return self._predict_func_main(unpack_main_tf(packed_main), unpack_macro_tf(packed_macro))
+
     def evaluate_states(self, arr_main_6, arr_macro):
         """
         Вызывается из Evaluate() в shared_memory_script.py
         Возвращает предсказания либо expert_model, либо main_model,
         в зависимости от use_expert_flag.
+        Принимает float32 [N, 9, 9, 6] / [N, 3, 3, 2] или упакованные uint8 [N, 64] / [N, 3].
         """
+        if is_packed(arr_main_6):
+            if self.use_expert_flag:
+                preds = self._predict_func_expert_packed(arr_main_6, arr_macro)
+            else:
+                preds = self._predict_func_main_packed(arr_main_6, arr_macro)
+            return preds.numpy()
         if self.use_expert_flag:
             preds = self._predict_func_expert(arr_main_6, arr_macro)
         else:
@@ -0,0 +1,85 @@
+import struct
+import sys
+
+import numpy as np
+
+# Выгрузка весов модели для ValueNet на C++ (cpp/include/nn_inference/ValueNet.h).
+# Формат (little-endian): b"UTTTNET1", uint32 число тензоров, затем для каждого тензора —
+#   uint32 длина имени, имя (utf-8), uint32 число измерений, uint32 размеры, float32 данные (порядок C).
+# Имя — "<слой>/<вес>"; у MultiHeadAttention — "<слой>/query|key|value|attention_output/kernel|bias".
+# Для DescentPlayer файл переводится в blob (cpp/tools/value_net_blob.cpp, цель ValueNetBlob) и кладётся
+# рядом с чекпоинтом: model_checkpoint.weights_N.h5 -> model_checkpoint.weights_N.vnet.
+# В blob записывается отпечаток .h5 (размер и хеш): DescentPlayer не возьмёт blob от другого чекпоинта.
+
+MAGIC = b"UTTTNET1"
+
+
+def _layer_tensors(layer):
+    """Пары (имя, массив) весов одного слоя в терминах ValueNet."""
+    kind = type(layer).__name__
+    name = layer.name
+    if kind == "MultiHeadAttention":
+        parts = {
+            "query": layer._query_dense,
+            "key": layer._key_dense,
+            "value": layer._value_dense,
+            "attention_output": layer._output_dense,
+        }
+        for part, dense in parts.items():
+            yield f"{name}/{part}/kernel", dense.kernel
+            if dense.bias is not None:
+                yield f"{name}/{part}/bias", dense.bias
+    elif kind == "BatchNormalization":
+        yield f"{name}/gamma", layer.gamma
+        yield f"{name}/beta", layer.beta
+        yield f"{name}/moving_mean", layer.moving_mean
+        yield f"{name}/moving_variance", layer.moving_variance
+        yield f"{name}/epsilon", np.array([layer.epsilon])
+    elif kind == "LayerNormalization":
+        yield f"{name}/gamma", layer.gamma
+        yield f"{name}/beta", layer.beta
+        yield f"{name}/epsilon", np.array([layer.epsilon])
+    elif kind in ("Conv2D", "Dense"):
+        yield f"{name}/kernel", layer.kernel
+        if layer.bias is not None:
+            yield f"{name}/bias", layer.bias
+
+
+def _all_layers(model):
+    # Sequential внутри модели (MLP блоков внимания) раскрывается до своих слоёв
+    for layer in model.layers:
+        if hasattr(layer, "layers"):
+            yield from _all_layers(layer)
+        else:
+            yield layer
+
+
+def export_weights(model, path):
+    tensors = []
+    for layer in _all_layers(model):
+        for name, value in _layer_tensors(layer):
+            tensors.append((name, np.ascontiguousarray(np.asarray(value), dtype="<f4")))
+
+    with open(path, "wb") as f:
+        f.write(MAGIC)
+        f.write(struct.pack("<I", len(tensors)))
+        for name, array in tensors:
+            encoded = name.encode("utf-8")
+            f.write(struct.pack("<I", len(encoded)))
+            f.write(encoded)
+            f.write(struct.pack("<I", array.ndim))
+            f.write(struct.pack(f"<{array.ndim}I", *array.shape))
+            f.write(array.tobytes())
+    print(f"[native_export] {len(tensors)} tensors written to {path}", flush=True)
+
+
+if __name__ == "__main__":
+    # python native_export.py [checkpoint.weights.h5] [out.bin] — для игроков без Python-модели
+    import config
+    import model_wrapper
+
+    if len(sys.argv) > 1:
+        config.CHECKPOINT_PATH = sys.argv[1]
+    out_path = sys.argv[2] if len(sys.argv) > 2 else "model_native.weights.bin"
+    model_wrapper.init_model_if_needed()
+    export_weights(model_wrapper.model, out_path)
@@ -0,0 +1,41 @@
+import numpy as np
+import tensorflow as tf
+
+# Упакованные входы сети (C++ собран с NN_INPUT_PACKED, см. cpp/include/state_to_nn_representation/channels_layout.h):
+#   main:  [N, 64] uint8 — 486 бит каналов (9, 9, 6) + нули до 64 байт
+#   macro: [N, 3]  uint8 — 18 бит каналов (3, 3, 2)
+# Значение с плоским номером k (порядок C: (h * 9 + w) * 6 + c) — бит k % 8 байта k / 8.
+
+MAIN_SHAPE = (9, 9, 6)
+MACRO_SHAPE = (3, 3, 2)
+MAIN_VALUES = 9 * 9 * 6
+MACRO_VALUES = 3 * 3 * 2
+
+
+def is_packed(arr_main):
+    """Упакованный формат узнаётся по форме массива: [N, байты] вместо [N, 9, 9, 6]."""
+    return arr_main.ndim == 2
+
+
+def _unpack_bits_tf(packed, values, shape):
+    # [N, B] -> [N, B, 8]: бит j каждого байта, затем плоский порядок 8 * байт + j
+    shifts = tf.range(8, dtype=tf.uint8)
+    bits = tf.bitwise.bitwise_and(tf.bitwise.right_shift(packed[:, :, None], shifts), 1)
+    flat = tf.reshape(bits, [tf.shape(packed)[0], -1])[:, :values]
+    return tf.cast(tf.reshape(flat, [-1, *shape]), tf.float32)
+
+
+def unpack_main_tf(packed):
+    """[N, 64] uint8 -> [N, 9, 9, 6] float32 внутри графа TF."""
+    return _unpack_bits_tf(packed, MAIN_VALUES, MAIN_SHAPE)
+
+
+def unpack_macro_tf(packed):
+    """[N, 3] uint8 -> [N, 3, 3, 2] float32 внутри графа TF."""
+    return _unpack_bits_tf(packed, MACRO_VALUES, MACRO_SHAPE)
+
+
+def unpack_np(packed, values, shape):
+    """NumPy-распаковка для обучения: аугментация (rot90/flip) работает с полными тензорами."""
+    flat = np.unpackbits(packed, axis=1, count=values, bitorder='little')
+    return flat.reshape(-1, *shape).astype(np.float32)
@@ -1,5 +1,7 @@
 import numpy as np
 import model_wrapper
+import native_export
+import packed_inputs
 from trainer import train_on_sample
 from model_copy_manager import ModelCopyManager
 
@@ -74,17 +76,35 @@ def load_specific_checkpoint_command():
         print(f"[shared_memory_script] Exception: {e}", flush=True)
 
 
+def export_native_weights(path):
+    """
+    Выгружает веса модели, которой сейчас оценивает Evaluate(), для ValueNet на C++
+    (SharedMemory::useNativeEvaluator; вызывается и после каждой смены весов).
+    """
+    native_export.export_weights(copy_manager.active_model(), path)
+
+
 def Evaluate():
     batch_size = int_vars_np[0]
     if batch_size <= 0:
         print("[shared_memory_script] Evaluate() called with batch_size <= 0.")
         return
 
-    arr_main = sample_main_channels_np[:batch_size].astype(np.float32)
-    arr_macro = sample_macro_channels_np[:batch_size].astype(np.float32)
+    # Смещение участка буфера: у каждого потока Descent на C++ стороне свой участок.
+    # Последний элемент int_vars (SharedMemory::evaluateOffsetVar): int_vars[1..] занимает путь модели из Do()
+    offset = int_vars_np[-1]
+    end = offset + batch_size
+
+    if packed_inputs.is_packed(sample_main_channels_np):
+        # Биты передаются в TF как есть: распаковка и приведение к float32 — внутри графа
+        arr_main = sample_main_channels_np[offset:end]
+        arr_macro = sample_macro_channels_np[offset:end]
+    else:
+        arr_main = sample_main_channels_np[offset:end].astype(np.float32)
+        arr_macro = sample_macro_channels_np[offset:end].astype(np.float32)
 
     preds = copy_manager.evaluate_states(arr_main, arr_macro)
-    sample_values_np[:batch_size] = preds
+    sample_values_np[offset:end] = preds
 
 
 def Learn():
@@ -95,8 +115,14 @@ def Learn():
         print("[shared_memory_script] Learn() called with sample_size <= 0.")
         return
 
-    arr_main = sample_main_channels_np[:sample_size].astype(np.float32)
-    arr_macro = sample_macro_channels_np[:sample_size].astype(np.float32)
+    if packed_inputs.is_packed(sample_main_channels_np):
+        arr_main = packed_inputs.unpack_np(sample_main_channels_np[:sample_size],
+                                           packed_inputs.MAIN_VALUES, packed_inputs.MAIN_SHAPE)
+        arr_macro = packed_inputs.unpack_np(sample_macro_channels_np[:sample_size],
+                                            packed_inputs.MACRO_VALUES, packed_inputs.MACRO_SHAPE)
+    else:
+        arr_main = sample_main_channels_np[:sample_size].astype(np.float32)
+        arr_macro = sample_macro_channels_np[:sample_size].astype(np.float32)
     arr_values = sample_values_np[:sample_size].astype(np.float32)
 
     # Обучаем основную модель
@@ -11,8 +11,6 @@ public:
 
     TournamentRunner();
 
-    ~TournamentRunner();
-
     void run();
 
 private:
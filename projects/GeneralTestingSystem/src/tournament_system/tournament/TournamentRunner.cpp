@@ -13,11 +13,6 @@ TournamentRunner::TournamentRunner(std::string cfgPath)
 // конструктор по умолчанию — просто делегируем
 TournamentRunner::TournamentRunner()
     : TournamentRunner("config/general_testing_system_params.txt") {
-    precalculateSmallBoardsArray();
-}
-
-TournamentRunner::~TournamentRunner() {
-    precalcBoardsFreeMem();
 }
 
 void TournamentRunner::run() {
@@ -0,0 +1,51 @@
+// zobrist_keys.h
+#pragma once
+
+#include <cstdint>
+
+/**
+ * @brief Ключи Zobrist для инкрементального хеша BigBoard.
+ *
+ * Хеш позиции = XOR ключей всех занятых клеток (малая доска, клетка, игрок)
+ * ^ ключ хода O ^ ключ активной доски. Состояния малых досок и большой доски
+ * однозначно следуют из расположения фигур, поэтому в хеш не входят.
+ *
+ * Ключи генерируются на этапе компиляции из фиксированного seed (splitmix64),
+ * поэтому одинаковы во всех копиях движка (DescentSelf-learning, DescentPlayer,
+ * MiniMaxPlayer, GeneralTestingSystem). Файл должен оставаться идентичным во всех копиях.
+ */
+namespace zobrist {
+    constexpr uint64_t SEED = 0x9E3779B97F4A7C15ULL;
+    constexpr int ANY_BOARD = 9; ///< Индекс ключа "ход на любую доску" (или конец игры)
+
+    struct Keys {
+        uint64_t cells[9][9][2]; ///< [boardIndex][cellIndex][player]
+        uint64_t playerO; ///< Ход делает O
+        uint64_t activeBoard[10]; ///< 0-8: единственная активная доска, ANY_BOARD: свободный выбор
+    };
+
+    constexpr uint64_t splitMix64(uint64_t &state) {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    constexpr Keys generateKeys() {
+        Keys keys{};
+        uint64_t state = SEED;
+        for (auto &board: keys.cells) {
+            for (auto &cell: board) {
+                cell[0] = splitMix64(state);
+                cell[1] = splitMix64(state);
+            }
+        }
+        keys.playerO = splitMix64(state);
+        for (uint64_t &key: keys.activeBoard) {
+            key = splitMix64(state);
+        }
+        return keys;
+    }
+
+    inline constexpr Keys keys = generateKeys();
+}
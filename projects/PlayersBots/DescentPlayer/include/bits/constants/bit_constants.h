@@ -62,6 +62,7 @@ namespace board {
 namespace bigBoardArrays {
     constexpr int size = 12;
     constexpr int movesSize = 81;
+    constexpr int movesBufferSize = movesSize + 16; ///< Tablica ruchów z zapasem na zapis blokami po 16 bajtów
     constexpr int bigState1Pos = 9;
     constexpr int bigState2Pos = 10;
     constexpr int hashKeyPos = 11;
@@ -1,13 +1,17 @@
 // ClientMain.h
 #pragma once
 
+#include <algorithm>
+#include <filesystem>
 #include <string>
 #include <winsock2.h>
 
 #include "communication/Communicator.h"
 #include "communication/TcpConnector.h"
+#include "parameters.h"
 #include "selfplay/Player.h"
 #include "shared_memory/SharedMemory.h"
+#include "structures/SearchTable.h"
 
 /**
  * @brief Класс основной логики клиента, который подключается к рефери-серверу
@@ -28,6 +32,21 @@ public:
      */
     SharedMemory sharedMemory;
 
+    /**
+     * @brief Таблица узлов Descent: выделяется один раз на сессию,
+     *        между партиями только очищается (память не растёт и не перевыделяется).
+     */
+    SearchTable searchTable;
+
+    /**
+     * @brief Бюджет таблицы узлов по времени на ход: узлов за ход тем больше, чем дольше поиск.
+     *        Страницы занимаются по мере заполнения, так что запас не стоит памяти заранее.
+     */
+    static std::size_t searchTableBytes(float timePerMove) {
+        const auto megabytes = static_cast<std::size_t>(timePerMove * params::SEARCH_TABLE_MB_PER_SECOND);
+        return std::max(megabytes, params::SEARCH_TABLE_MIN_MB) << 20;
+    }
+
 public:
     /**
      * @param port Порт, на который будем подключаться (сервер-рефери).
@@ -41,6 +60,7 @@ public:
           , timePerMove(timePerMove)
           , player(nullptr)
           , sharedMemory(1024, archPath) // (sampleLength=1024)
+          , searchTable(searchTableBytes(timePerMove))
     {
         // communicator.descriptor = INVALID_SOCKET по умолчанию
     }
@@ -147,10 +167,25 @@ private:
     }
 
     /**
-     * @brief Загружает модель, используя Python (через SharedMemory).
+     * @brief Загружает модель: blob-файл весов рядом с чекпоинтом (то же имя, расширение .vnet —
+     *        утилита ValueNetBlob), собранный именно из этого чекпоинта, отображается в память и считается на C++;
+     *        иначе (нет blob или он от другого чекпоинта) — Python (через SharedMemory).
      * @param modelPath Строковый путь к .h5-файлу или иной модели.
      */
     void loadModel(const std::string &modelPath) {
+        const std::string blobPath = std::filesystem::path(modelPath).replace_extension(".vnet").string();
+        if (sharedMemory.useNativeBlob(std::filesystem::exists(blobPath) ? blobPath : "", modelPath)) {
+            std::cout << "[ClientMain] Value net mapped from " << blobPath << "\n";
+            return;
+        }
+
+        // Путь не должен дойти до смещения оценки (SharedMemory::evaluateOffsetVar)
+        if (modelPath.size() > SharedMemory::maxModelPathLength) {
+            std::cerr << "[ClientMain] Model path is longer than " << SharedMemory::maxModelPathLength
+                    << " characters: " << modelPath << "\n";
+            return;
+        }
+
         // Ставим код команды (101) или любой другой
         sharedMemory.intVars[0] = 200;
 
@@ -168,14 +203,15 @@ private:
 
     /**
      * @brief Сброс игрового состояния:
-     *        удаляем старый Player и создаём новый.
+     *        удаляем старый Player и создаём новый, таблицу узлов очищаем.
      */
     void resetGame() {
         if (player != nullptr) {
             delete player;
             player = nullptr;
         }
-        player = new Player(sharedMemory, timePerMove);
+        searchTable.clear();
+        player = new Player(sharedMemory, searchTable, timePerMove);
     }
 
     /**
@@ -0,0 +1,133 @@
+// NetWeights.h
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Тензор весов: размеры и данные float32 в порядке C (последний индекс — самый быстрый).
+ */
+struct NetTensor {
+    std::vector<uint32_t> shape;
+    std::vector<float> data;
+
+    inline size_t dim(int axis) const {
+        return shape[axis < 0 ? shape.size() + axis : axis];
+    }
+};
+
+/**
+ * @brief Веса сети, выгруженные native_export.py: именованные тензоры float32.
+ *
+ * Файл (little-endian): "UTTTNET1", uint32 число тензоров, затем для каждого тензора —
+ * uint32 длина имени, имя, uint32 число измерений, uint32 размеры, float32 данные.
+ * Имя — "<слой Keras>/<вес>": "loc_init_conv/kernel", "loc_init_bn/moving_mean",
+ * "AttnBlock0_MHA/query/kernel"; у BatchNormalization и LayerNormalization есть и "<слой>/epsilon".
+ */
+class NetWeights {
+public:
+    static constexpr char MAGIC[8] = {'U', 'T', 'T', 'T', 'N', 'E', 'T', '1'};
+
+    /**
+     * @return false, если файл не открылся или повреждён (причина — в std::cerr)
+     */
+    bool load(const std::string &path) {
+        tensors.clear();
+        names.clear();
+        std::ifstream in(path, std::ios::binary);
+        if (!in) {
+            std::cerr << "[NetWeights] Cannot open " << path << std::endl;
+            return false;
+        }
+        char magic[sizeof(MAGIC)];
+        uint32_t count = 0;
+        if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0 || !readU32(in, count)) {
+            std::cerr << "[NetWeights] " << path << " is not a native weights file" << std::endl;
+            return false;
+        }
+        for (uint32_t t = 0; t < count; ++t) {
+            uint32_t nameLength = 0;
+            uint32_t rank = 0;
+            std::string name;
+            NetTensor tensor;
+            bool ok = readU32(in, nameLength);
+            if (ok) {
+                name.resize(nameLength);
+                ok = static_cast<bool>(in.read(name.data(), nameLength)) && readU32(in, rank);
+            }
+            size_t size = 1;
+            for (uint32_t axis = 0; ok && axis < rank; ++axis) {
+                uint32_t extent = 0;
+                ok = readU32(in, extent);
+                tensor.shape.push_back(extent);
+                size *= extent;
+            }
+            if (ok) {
+                tensor.data.resize(size);
+                ok = static_cast<bool>(in.read(reinterpret_cast<char *>(tensor.data.data()), size * sizeof(float)));
+            }
+            if (!ok) {
+                std::cerr << "[NetWeights] " << path << " is truncated at tensor " << t << std::endl;
+                tensors.clear();
+                names.clear();
+                return false;
+            }
+            add(name, std::move(tensor));
+        }
+        return true;
+    }
+
+    /// Запись в том же формате (порядок тензоров — порядок добавления)
+    bool save(const std::string &path) const {
+        std::ofstream out(path, std::ios::binary);
+        out.write(MAGIC, sizeof(MAGIC));
+        writeU32(out, static_cast<uint32_t>(names.size()));
+        for (const std::string &name: names) {
+            const NetTensor &tensor = tensors.at(name);
+            writeU32(out, static_cast<uint32_t>(name.size()));
+            out.write(name.data(), static_cast<std::streamsize>(name.size()));
+            writeU32(out, static_cast<uint32_t>(tensor.shape.size()));
+            for (uint32_t extent: tensor.shape) {
+                writeU32(out, extent);
+            }
+            out.write(reinterpret_cast<const char *>(tensor.data.data()),
+                      static_cast<std::streamsize>(tensor.data.size() * sizeof(float)));
+        }
+        return static_cast<bool>(out);
+    }
+
+    void add(const std::string &name, NetTensor tensor) {
+        if (tensors.find(name) == tensors.end()) {
+            names.push_back(name);
+        }
+        tensors[name] = std::move(tensor);
+    }
+
+    /// nullptr, если тензора нет (например, у слоя без SE или без третьего Dense)
+    const NetTensor *find(const std::string &name) const {
+        auto it = tensors.find(name);
+        return it == tensors.end() ? nullptr : &it->second;
+    }
+
+    inline bool contains(const std::string &name) const {
+        return tensors.find(name) != tensors.end();
+    }
+
+private:
+    std::unordered_map<std::string, NetTensor> tensors;
+    std::vector<std::string> names;
+
+    static bool readU32(std::istream &in, uint32_t &value) {
+        return static_cast<bool>(in.read(reinterpret_cast<char *>(&value), sizeof(value)));
+    }
+
+    static void writeU32(std::ostream &out, uint32_t value) {
+        out.write(reinterpret_cast<const char *>(&value), sizeof(value));
+    }
+};
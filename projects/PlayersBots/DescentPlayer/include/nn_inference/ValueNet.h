@@ -0,0 +1,886 @@
+// ValueNet.h
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "nn_inference/MappedFile.h"
+#include "nn_inference/NetWeights.h"
+#include "nn_inference/nn_kernels.h"
+#include "nn_inference/nn_quant.h"
+#include "state_to_nn_representation/channels_layout.h"
+
+/**
+ * @brief Сеть оценки из model_wrapper.init_model_if_needed — прямой проход на C++ без Python и TensorFlow.
+ *
+ * Локальная ветвь: свёртка 3×3 + ResNet-блоки (SE), 9 токенов малых досок, Dense-проекция и блоки
+ * внимания (MultiHeadAttention + MLP, LayerNormalization); макроветвь: свёртка 3×3 + ResNet-блоки;
+ * слияние и Dense-голова с tanh на выходе. Размеры, число блоков и голов берутся из файла весов
+ * (native_export.py), поэтому изменения config.py не требуют правок здесь.
+ *
+ * Вместо файла native_export.py сеть может взять веса из blob-файла (saveBlob() / mapBlob()):
+ * там они уже в рабочем виде и только отображаются в память — без разбора, свёртки BN и копий.
+ *
+ * BatchNormalization при загрузке сворачивается в предшествующие свёртки и Dense (режим inference),
+ * Dropout при inference не действует. После calibrate() крупные слои могут считаться в int8
+ * (Precision::INT8, nn_quant.h); мелкие (SE, первые свёртки, выход) всегда остаются в float.
+ * Буферы активаций — в Scratch: evaluate() без Scratch использует буферы объекта, а потоки со своими
+ * Scratch могут оценивать одновременно — веса при этом только читаются (потоки Descent в SharedMemory).
+ */
+class ValueNet {
+public:
+    static constexpr int CHUNK = 16; ///< Состояний за один проход: ограничивает буферы im2col (~6 МБ)
+    static constexpr int QUANT_MIN_INPUTS = 64; ///< Меньшие слои int8 не ускоряет — только добавляет ошибку
+    static constexpr int QUANT_MIN_OUTPUTS = 16;
+    static constexpr char BLOB_MAGIC[8] = {'U', 'T', 'T', 'T', 'V', 'N', 'B', '2'};
+    static constexpr size_t BLOB_ALIGN = 64; ///< Граница массивов blob-файла: строка кэша, загрузка AVX-512
+
+    enum class Precision {
+        FP32,
+        INT8
+    };
+
+    /// Буферы активаций одного прохода (растут до размера первого полного CHUNK)
+    struct Scratch {
+        std::vector<float> act, tmp, tmp2, col, tokens, qkv, ctx, hidden, merged, se, seHidden;
+        std::vector<uint8_t> quantized;
+    };
+
+    /// Отпечаток чекпоинта, из которого получен blob: размер и хеш содержимого (нули — источник неизвестен)
+    struct SourceStamp {
+        uint64_t bytes;
+        uint64_t hash;
+
+        bool operator==(const SourceStamp &) const = default;
+    };
+
+    /// Расхождение оценок int8 и FP32 на отложенных состояниях
+    struct QuantError {
+        float meanAbs = 0.0f;
+        float maxAbs = 0.0f;
+    };
+
+    ValueNet() = default;
+
+    ValueNet(const ValueNet &) = delete; // layers указывают на собственные слои
+
+    ValueNet &operator=(const ValueNet &) = delete;
+
+    /**
+     * @return false, если файла нет или в нём не хватает слоёв (причина — в std::cerr)
+     */
+    bool load(const std::string &path) {
+        NetWeights weights;
+        loaded = weights.load(path) && build(weights);
+        return loaded;
+    }
+
+    bool build(const NetWeights &weights) {
+        reset();
+        if (!loadLinear(weights, "loc_init_conv", locInit, "loc_init_bn") ||
+            !loadResBlocks(weights, "loc_res", locBlocks) ||
+            !loadLinear(weights, "loc_tokens_project", tokenProject) ||
+            !loadAttnBlocks(weights) ||
+            !loadLinear(weights, "mac_init_conv", macInit, "mac_init_bn") ||
+            !loadResBlocks(weights, "mac_res", macBlocks)) {
+            return false;
+        }
+        for (int i = 1; weights.contains("dense_" + std::to_string(i) + "/kernel"); ++i) {
+            dense.emplace_back();
+            std::string name = "dense_" + std::to_string(i);
+            if (!loadLinear(weights, name, dense.back(), name + "_bn")) {
+                return false;
+            }
+        }
+        if (!loadLinear(weights, "output", output)) {
+            return false;
+        }
+        loaded = finish();
+        return loaded;
+    }
+
+    /**
+     * @brief Сеть в рабочем виде: BatchNormalization свёрнута, q/k/v слиты, веса разложены по панелям.
+     *
+     * Файл: "UTTTVNB2", отпечаток чекпоинта (uint64 размер, uint64 хеш — см. stampOf()), uint32 число слов
+     * структуры, слова структуры (uint32; блоки, размеры слоёв, смещения массивов), нули до границы 64 байт,
+     * затем массивы float32 — каждый с границы 64 байт. Смещения — в float от начала массивов.
+     * Порядок байт — как у машины, записавшей файл.
+     * @param checkpoint - отпечаток чекпоинта, из которого получены веса: по нему DescentPlayer
+     *                     узнаёт устаревший blob рядом с новым чекпоинтом
+     */
+    bool saveBlob(const std::string &path, const SourceStamp &checkpoint = {}) const {
+        if (!loaded) {
+            return false;
+        }
+        constexpr size_t alignFloats = BLOB_ALIGN / sizeof(float);
+        std::vector<uint32_t> structure;
+        std::vector<float> arrays;
+        auto put = [&](const float *data, size_t count) {
+            structure.push_back(static_cast<uint32_t>(arrays.size()));
+            arrays.insert(arrays.end(), data, data + count);
+            arrays.resize((arrays.size() + alignFloats - 1) / alignFloats * alignFloats, 0.0f);
+        };
+        auto putBlocks = [&](const std::vector<ResBlock> &blocks) {
+            structure.push_back(static_cast<uint32_t>(blocks.size()));
+            for (const ResBlock &block: blocks) {
+                structure.push_back(block.hasShortcut);
+                structure.push_back(block.hasSE);
+            }
+        };
+        auto putNorm = [&](const Norm &norm) {
+            structure.push_back(static_cast<uint32_t>(norm.gamma.size()));
+            put(norm.gamma.data(), norm.gamma.size());
+            put(norm.beta.data(), norm.beta.size());
+            structure.push_back(std::bit_cast<uint32_t>(norm.epsilon));
+        };
+
+        putBlocks(locBlocks);
+        structure.push_back(static_cast<uint32_t>(attnBlocks.size()));
+        for (const AttnBlock &block: attnBlocks) {
+            structure.push_back(block.heads);
+            structure.push_back(block.keyDim);
+            putNorm(block.ln1);
+            putNorm(block.ln2);
+        }
+        putBlocks(macBlocks);
+        structure.push_back(static_cast<uint32_t>(dense.size()));
+        structure.push_back(static_cast<uint32_t>(layers.size()));
+        for (const Linear *layer: layers) {
+            structure.push_back(layer->in);
+            structure.push_back(layer->out);
+            put(layer->weightData(), layer->weightCount());
+            put(layer->biasData(), static_cast<size_t>(layer->panels) * nnKernels::PANEL);
+        }
+
+        const uint32_t words = static_cast<uint32_t>(structure.size());
+        const size_t header = sizeof(BLOB_MAGIC) + sizeof(SourceStamp) + sizeof(words) + words * sizeof(uint32_t);
+        const std::vector<char> padding(alignedHeader(words) - header, 0);
+        std::ofstream out(path, std::ios::binary);
+        out.write(BLOB_MAGIC, sizeof(BLOB_MAGIC));
+        out.write(reinterpret_cast<const char *>(&checkpoint.bytes), sizeof(checkpoint.bytes));
+        out.write(reinterpret_cast<const char *>(&checkpoint.hash), sizeof(checkpoint.hash));
+        out.write(reinterpret_cast<const char *>(&words), sizeof(words));
+        out.write(reinterpret_cast<const char *>(structure.data()), static_cast<std::streamsize>(words * sizeof(uint32_t)));
+        out.write(padding.data(), static_cast<std::streamsize>(padding.size()));
+        out.write(reinterpret_cast<const char *>(arrays.data()), static_cast<std::streamsize>(arrays.size() * sizeof(float)));
+        return static_cast<bool>(out);
+    }
+
+    /**
+     * @brief Веса из файла saveBlob(), отображённого только для чтения: слои указывают прямо в файл,
+     *        процессы с одним файлом делят одну физическую копию весов.
+     * @return false, если файла нет или он повреждён (причина — в std::cerr)
+     */
+    bool mapBlob(const std::string &path) {
+        reset();
+        if (!blob.open(path)) {
+            std::cerr << "[ValueNet] Cannot map " << path << std::endl;
+            return false;
+        }
+        loaded = parseBlob(path) && finish();
+        if (!loaded) {
+            reset();
+        }
+        return loaded;
+    }
+
+    /// Отпечаток чекпоинта из заголовка blob-файла после mapBlob()
+    inline const SourceStamp &blobSource() const {
+        return source;
+    }
+
+    /**
+     * @brief Отпечаток файла для saveBlob(): размер и FNV-1a по 8-байтовым словам содержимого.
+     * @return false, если файла нет или он пуст
+     */
+    static bool stampOf(const std::string &path, SourceStamp &stamp) {
+        MappedFile file;
+        if (!file.open(path)) {
+            return false;
+        }
+        constexpr uint64_t prime = 0x100000001b3;
+        uint64_t hash = 0xcbf29ce484222325;
+        const size_t words = file.size() / sizeof(uint64_t);
+        for (size_t i = 0; i < words; ++i) {
+            uint64_t word;
+            std::memcpy(&word, file.data() + i * sizeof(uint64_t), sizeof(word));
+            hash = (hash ^ word) * prime;
+        }
+        for (size_t i = words * sizeof(uint64_t); i < file.size(); ++i) {
+            hash = (hash ^ file.data()[i]) * prime;
+        }
+        stamp = {file.size(), hash};
+        return true;
+    }
+
+    inline bool isLoaded() const {
+        return loaded;
+    }
+
+    inline bool isMapped() const {
+        return blob.isOpen();
+    }
+
+    /// Сбрасывает сеть (и отображение blob-файла); isLoaded() — false
+    void reset() {
+        loaded = false;
+        calibrated = false;
+        precision = Precision::FP32;
+        layers.clear();
+        quant.clear();
+        locInit = Linear{};
+        tokenProject = Linear{};
+        macInit = Linear{};
+        output = Linear{};
+        locBlocks.clear();
+        macBlocks.clear();
+        attnBlocks.clear();
+        dense.clear();
+        blob.close();
+        source = {};
+    }
+
+    inline bool isCalibrated() const {
+        return calibrated;
+    }
+
+    inline Precision getPrecision() const {
+        return precision;
+    }
+
+    /// INT8 — только после calibrate()
+    inline void setPrecision(Precision value) {
+        precision = value == Precision::INT8 && !calibrated ? Precision::FP32 : value;
+    }
+
+    /**
+     * @brief Калибровка int8: прямой проход FP32 по count состояниям (например, выборке ReplayBuffer)
+     *        записывает диапазон входа каждого слоя, затем веса крупных слоёв квантуются.
+     *        Точность вычислений не меняется — см. setPrecision().
+     */
+    void calibrate(const uint8_t *mainChannels, const uint8_t *macroChannels, int count) {
+        rangeMin.assign(layers.size(), 0.0f);
+        rangeMax.assign(layers.size(), 0.0f);
+        const Precision saved = precision;
+        precision = Precision::FP32;
+        observing = true;
+        std::vector<float> values(count);
+        evaluate(mainChannels, macroChannels, count, values.data());
+        observing = false;
+        precision = saved;
+
+        quant.assign(layers.size(), nnQuant::QuantLinear{});
+        for (size_t id = 0; id < layers.size(); ++id) {
+            const Linear &layer = *layers[id];
+            if (layer.in >= QUANT_MIN_INPUTS && layer.out >= QUANT_MIN_OUTPUTS) {
+                quant[id].assign(layer, rangeMin[id], rangeMax[id]);
+            }
+        }
+        calibrated = count > 0;
+    }
+
+    /**
+     * @brief Оценки count состояний в FP32 и INT8 — расхождение для выбора между точностью и скоростью.
+     */
+    QuantError compareWithFloat(const uint8_t *mainChannels, const uint8_t *macroChannels, int count) {
+        QuantError error;
+        if (!calibrated || count <= 0) {
+            return error;
+        }
+        std::vector<float> reference(count), quantized(count);
+        const Precision saved = precision;
+        precision = Precision::FP32;
+        evaluate(mainChannels, macroChannels, count, reference.data());
+        precision = Precision::INT8;
+        evaluate(mainChannels, macroChannels, count, quantized.data());
+        precision = saved;
+        for (int i = 0; i < count; ++i) {
+            const float diff = std::abs(quantized[i] - reference[i]);
+            error.meanAbs += diff / static_cast<float>(count);
+            error.maxAbs = std::max(error.maxAbs, diff);
+        }
+        return error;
+    }
+
+    /**
+     * @brief Оценки count состояний, записанных stateToChannels::convert в буферы формата SharedMemory
+     *        (MAIN_BYTES / MACRO_BYTES на состояние, NN_INPUT_PACKED — биты).
+     */
+    void evaluate(const uint8_t *mainChannels, const uint8_t *macroChannels, int count, float *values) {
+        evaluate(mainChannels, macroChannels, count, values, scratch);
+    }
+
+    /**
+     * @brief То же на буферах вызывающего: вызовы с разными Scratch не мешают друг другу
+     *        (но не совпадают по времени с загрузкой весов, calibrate() и setPrecision()).
+     */
+    void evaluate(const uint8_t *mainChannels, const uint8_t *macroChannels, int count, float *values,
+                  Scratch &work) {
+        for (int first = 0; first < count; first += CHUNK) {
+            const int batch = std::min(CHUNK, count - first);
+            forward(mainChannels + first * stateToChannels::MAIN_BYTES,
+                    macroChannels + first * stateToChannels::MACRO_BYTES, batch, values + first, work);
+        }
+    }
+
+private:
+    using Linear = nnKernels::Linear;
+
+    struct ResBlock {
+        Linear conv1;
+        Linear conv2;
+        Linear shortcut; ///< Свёртка 1×1, если число каналов меняется
+        Linear seReduce; ///< Squeeze-and-Excitation: Dense(relu) и Dense(sigmoid)
+        Linear seExpand;
+        bool hasShortcut = false;
+        bool hasSE = false;
+    };
+
+    struct Norm {
+        std::vector<float> gamma;
+        std::vector<float> beta;
+        float epsilon = 1e-3f;
+    };
+
+    struct AttnBlock {
+        Linear qkv; ///< query, key, value одной матрицей: столбцы [q | k | v], в каждом — головы подряд
+        Linear attnOutput;
+        Linear mlp1;
+        Linear mlp2;
+        Norm ln1;
+        Norm ln2;
+        int heads = 0;
+        int keyDim = 0;
+    };
+
+    bool loaded = false;
+    bool calibrated = false;
+    bool observing = false; ///< calibrate(): запоминать диапазоны входов слоёв
+    Precision precision = Precision::FP32;
+    int localFilters = 0;
+    int macroFilters = 0;
+    int attnDim = 0;
+
+    Linear locInit;
+    std::vector<ResBlock> locBlocks;
+    Linear tokenProject;
+    std::vector<AttnBlock> attnBlocks;
+    Linear macInit;
+    std::vector<ResBlock> macBlocks;
+    std::vector<Linear> dense;
+    Linear output;
+
+    std::vector<Linear *> layers; ///< Все линейные слои по Linear::id
+    std::vector<nnQuant::QuantLinear> quant; ///< int8-копии слоёв по id (enabled = false — слой остаётся в float)
+    std::vector<float> rangeMin, rangeMax; ///< Диапазоны входов слоёв при калибровке
+
+    Scratch scratch; ///< Буферы evaluate() без Scratch вызывающего
+
+    MappedFile blob; ///< Отображённый blob-файл (mapBlob), на который указывают слои
+    SourceStamp source{}; ///< Отпечаток чекпоинта из заголовка blob-файла
+
+    /// Размеры слоёв после загрузки: сходятся ли они между собой и с форматом входов
+    bool finish() {
+        localFilters = locBlocks.empty() ? locInit.out : locBlocks.back().conv2.out;
+        macroFilters = macBlocks.empty() ? macInit.out : macBlocks.back().conv2.out;
+        attnDim = tokenProject.out;
+        const int merged = attnDim + 9 * macroFilters;
+        const int headInputs = dense.empty() ? output.in : dense.front().in;
+        if (locInit.in != 9 * static_cast<int>(stateToChannels::MAIN_VALUES / 81) ||
+            macInit.in != 9 * static_cast<int>(stateToChannels::MACRO_VALUES / 9) ||
+            tokenProject.in != 9 * localFilters || headInputs != merged || output.out != 1) {
+            std::cerr << "[ValueNet] Layer sizes do not match the model architecture" << std::endl;
+            return false;
+        }
+        collectLayers();
+        return true;
+    }
+
+    static size_t alignedHeader(uint32_t words) {
+        const size_t header = sizeof(BLOB_MAGIC) + sizeof(SourceStamp) + sizeof(uint32_t) + words * sizeof(uint32_t);
+        return (header + BLOB_ALIGN - 1) / BLOB_ALIGN * BLOB_ALIGN;
+    }
+
+    /// Структура сети из отображённого blob и слои поверх его массивов — в порядке saveBlob()
+    bool parseBlob(const std::string &path) {
+        const unsigned char *bytes = blob.data();
+        uint32_t words = 0;
+        const size_t wordsPos = sizeof(BLOB_MAGIC) + sizeof(SourceStamp);
+        if (blob.size() < wordsPos + sizeof(words) || std::memcmp(bytes, BLOB_MAGIC, sizeof(BLOB_MAGIC)) != 0) {
+            std::cerr << "[ValueNet] " << path << " is not a value net blob" << std::endl;
+            return false;
+        }
+        std::memcpy(&source.bytes, bytes + sizeof(BLOB_MAGIC), sizeof(source.bytes));
+        std::memcpy(&source.hash, bytes + sizeof(BLOB_MAGIC) + sizeof(source.bytes), sizeof(source.hash));
+        std::memcpy(&words, bytes + wordsPos, sizeof(words));
+        const size_t header = alignedHeader(words);
+        if (header > blob.size()) {
+            std::cerr << "[ValueNet] " << path << " is truncated" << std::endl;
+            return false;
+        }
+        const uint32_t *structure = reinterpret_cast<const uint32_t *>(bytes + wordsPos + sizeof(words));
+        const float *arrays = reinterpret_cast<const float *>(bytes + header);
+        const size_t floats = (blob.size() - header) / sizeof(float);
+        uint32_t next = 0;
+        bool ok = true;
+        auto word = [&]() -> uint32_t {
+            ok = ok && next < words;
+            return ok ? structure[next++] : 0;
+        };
+        auto array = [&](size_t count) -> const float * {
+            const size_t offset = word();
+            ok = ok && offset + count <= floats;
+            return ok ? arrays + offset : nullptr;
+        };
+        auto readBlocks = [&](std::vector<ResBlock> &blocks) {
+            const uint32_t count = word();
+            for (uint32_t i = 0; ok && i < count; ++i) {
+                ResBlock &block = blocks.emplace_back();
+                block.hasShortcut = word() != 0;
+                block.hasSE = word() != 0;
+            }
+        };
+        auto readNorm = [&](Norm &norm) {
+            const uint32_t features = word();
+            const float *gamma = array(features);
+            const float *beta = array(features);
+            norm.epsilon = std::bit_cast<float>(word());
+            if (ok) {
+                norm.gamma.assign(gamma, gamma + features);
+                norm.beta.assign(beta, beta + features);
+            }
+        };
+
+        readBlocks(locBlocks);
+        const uint32_t attnCount = word();
+        for (uint32_t i = 0; ok && i < attnCount; ++i) {
+            AttnBlock &block = attnBlocks.emplace_back();
+            block.heads = static_cast<int>(word());
+            block.keyDim = static_cast<int>(word());
+            readNorm(block.ln1);
+            readNorm(block.ln2);
+        }
+        readBlocks(macBlocks);
+        const uint32_t denseCount = word();
+        ok = ok && denseCount <= words;
+        if (ok) {
+            dense.resize(denseCount);
+            collectLayers();
+            ok = word() == layers.size();
+        }
+        for (size_t id = 0; ok && id < layers.size(); ++id) {
+            const int inputs = static_cast<int>(word());
+            const int outputs = static_cast<int>(word());
+            const size_t panels = (static_cast<size_t>(outputs) + nnKernels::PANEL - 1) / nnKernels::PANEL;
+            const float *panelWeights = array(panels * inputs * nnKernels::PANEL);
+            const float *panelBias = array(panels * nnKernels::PANEL);
+            if (ok) {
+                layers[id]->map(panelWeights, panelBias, inputs, outputs);
+            }
+        }
+        if (!ok || next != words) {
+            std::cerr << "[ValueNet] " << path << " is truncated or does not match this network" << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    void collectLayers() {
+        layers.clear();
+        auto addLayer = [this](Linear &layer) {
+            layer.id = static_cast<int>(layers.size());
+            layers.push_back(&layer);
+        };
+        auto addBlocks = [&](std::vector<ResBlock> &blocks) {
+            for (ResBlock &block: blocks) {
+                addLayer(block.conv1);
+                addLayer(block.conv2);
+                if (block.hasShortcut) {
+                    addLayer(block.shortcut);
+                }
+                if (block.hasSE) {
+                    addLayer(block.seReduce);
+                    addLayer(block.seExpand);
+                }
+            }
+        };
+        addLayer(locInit);
+        addBlocks(locBlocks);
+        addLayer(tokenProject);
+        for (AttnBlock &block: attnBlocks) {
+            addLayer(block.qkv);
+            addLayer(block.attnOutput);
+            addLayer(block.mlp1);
+            addLayer(block.mlp2);
+        }
+        addLayer(macInit);
+        addBlocks(macBlocks);
+        for (Linear &layer: dense) {
+            addLayer(layer);
+        }
+        addLayer(output);
+    }
+
+    /// Линейный слой в текущей точности; при калибровке — ещё и диапазон входа
+    void apply(const Linear &layer, const float *x, int rows, float *y, Scratch &work) {
+        if (observing) {
+            const size_t size = static_cast<size_t>(rows) * layer.in;
+            auto [low, high] = std::minmax_element(x, x + size);
+            rangeMin[layer.id] = std::min(rangeMin[layer.id], *low);
+            rangeMax[layer.id] = std::max(rangeMax[layer.id], *high);
+        }
+        if (precision == Precision::INT8 && quant[layer.id].enabled) {
+            nnQuant::linear(quant[layer.id], x, rows, y, work.quantized);
+        } else {
+            nnKernels::linear(layer, x, rows, y);
+        }
+    }
+
+    static bool missing(const std::string &name) {
+        std::cerr << "[ValueNet] Missing tensor " << name << std::endl;
+        return false;
+    }
+
+    static float epsilonOf(const NetWeights &weights, const std::string &layer) {
+        const NetTensor *epsilon = weights.find(layer + "/epsilon");
+        return epsilon == nullptr ? 1e-3f : epsilon->data[0];
+    }
+
+    static void ensure(std::vector<float> &buffer, size_t size) {
+        if (buffer.size() < size) {
+            buffer.resize(size);
+        }
+    }
+
+    /// kernel [..., out] и bias [out]; batchNorm — имя следующего за слоем BatchNormalization
+    static bool loadLinear(const NetWeights &weights, const std::string &layer, Linear &linear,
+                           const std::string &batchNorm = "") {
+        const NetTensor *kernel = weights.find(layer + "/kernel");
+        if (kernel == nullptr) {
+            return missing(layer + "/kernel");
+        }
+        const NetTensor *bias = weights.find(layer + "/bias");
+        const int outputs = static_cast<int>(kernel->dim(-1));
+        const int inputs = static_cast<int>(kernel->data.size() / outputs);
+        linear.assign(kernel->data.data(), bias == nullptr ? nullptr : bias->data.data(), inputs, outputs);
+        return batchNorm.empty() || foldBatchNorm(weights, batchNorm, linear);
+    }
+
+    /// BN(x) = (x - mean) / sqrt(var + eps) * gamma + beta — масштаб столбцов и новый bias
+    static bool foldBatchNorm(const NetWeights &weights, const std::string &layer, Linear &linear) {
+        const NetTensor *gamma = weights.find(layer + "/gamma");
+        const NetTensor *beta = weights.find(layer + "/beta");
+        const NetTensor *mean = weights.find(layer + "/moving_mean");
+        const NetTensor *variance = weights.find(layer + "/moving_variance");
+        if (gamma == nullptr || beta == nullptr || mean == nullptr || variance == nullptr) {
+            return missing(layer + "/{gamma,beta,moving_mean,moving_variance}");
+        }
+        const float epsilon = epsilonOf(weights, layer);
+        std::vector<float> scale(linear.out), shift(linear.out);
+        for (int o = 0; o < linear.out; ++o) {
+            scale[o] = gamma->data[o] / std::sqrt(variance->data[o] + epsilon);
+            shift[o] = beta->data[o] - mean->data[o] * scale[o];
+        }
+        linear.scaleOutputs(scale.data(), shift.data());
+        return true;
+    }
+
+    static bool loadNorm(const NetWeights &weights, const std::string &layer, Norm &norm) {
+        const NetTensor *gamma = weights.find(layer + "/gamma");
+        const NetTensor *beta = weights.find(layer + "/beta");
+        if (gamma == nullptr || beta == nullptr) {
+            return missing(layer + "/{gamma,beta}");
+        }
+        norm.gamma = gamma->data;
+        norm.beta = beta->data;
+        norm.epsilon = epsilonOf(weights, layer);
+        return true;
+    }
+
+    /// Блоки "<prefix><i>_conv1", ... (res_block в model_wrapper.py), пока они есть в файле
+    static bool loadResBlocks(const NetWeights &weights, const std::string &prefix, std::vector<ResBlock> &blocks) {
+        for (int i = 0; weights.contains(prefix + std::to_string(i) + "_conv1/kernel"); ++i) {
+            const std::string name = prefix + std::to_string(i);
+            ResBlock &block = blocks.emplace_back();
+            if (!loadLinear(weights, name + "_conv1", block.conv1, name + "_bn1") ||
+                !loadLinear(weights, name + "_conv2", block.conv2, name + "_bn2")) {
+                return false;
+            }
+            block.hasShortcut = weights.contains(name + "_sc_conv/kernel");
+            if (block.hasShortcut && !loadLinear(weights, name + "_sc_conv", block.shortcut, name + "_sc_bn")) {
+                return false;
+            }
+            block.hasSE = weights.contains(name + "_se_se_fc1/kernel");
+            if (block.hasSE && (!loadLinear(weights, name + "_se_se_fc1", block.seReduce) ||
+                                !loadLinear(weights, name + "_se_se_fc2", block.seExpand))) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool loadAttnBlocks(const NetWeights &weights) {
+        for (int i = 0; weights.contains("AttnBlock" + std::to_string(i) + "_MHA/query/kernel"); ++i) {
+            const std::string name = "AttnBlock" + std::to_string(i);
+            AttnBlock &block = attnBlocks.emplace_back();
+
+            // query/key/value: kernel [dim, heads, keyDim], bias [heads, keyDim]
+            const NetTensor *kernels[3];
+            const NetTensor *biases[3];
+            const char *parts[3] = {"query", "key", "value"};
+            for (int p = 0; p < 3; ++p) {
+                kernels[p] = weights.find(name + "_MHA/" + parts[p] + "/kernel");
+                biases[p] = weights.find(name + "_MHA/" + parts[p] + "/bias");
+                if (kernels[p] == nullptr || kernels[p]->shape.size() != 3) {
+                    return missing(name + "_MHA/" + parts[p] + "/kernel");
+                }
+            }
+            const int dim = static_cast<int>(kernels[0]->dim(0));
+            block.heads = static_cast<int>(kernels[0]->dim(1));
+            block.keyDim = static_cast<int>(kernels[0]->dim(2));
+            const int width = block.heads * block.keyDim;
+            std::vector<float> fused(static_cast<size_t>(dim) * 3 * width);
+            std::vector<float> fusedBias(3 * width, 0.0f);
+            for (int p = 0; p < 3; ++p) {
+                for (int k = 0; k < dim; ++k) {
+                    std::copy_n(&kernels[p]->data[static_cast<size_t>(k) * width], width,
+                                &fused[(static_cast<size_t>(k) * 3 + p) * width]);
+                }
+                if (biases[p] != nullptr) {
+                    std::copy_n(biases[p]->data.data(), width, &fusedBias[p * width]);
+                }
+            }
+            block.qkv.assign(fused.data(), fusedBias.data(), dim, 3 * width);
+
+            if (!loadLinear(weights, name + "_MHA/attention_output", block.attnOutput) ||
+                !loadLinear(weights, name + "_MLP_dense1", block.mlp1) ||
+                !loadLinear(weights, name + "_MLP_dense2", block.mlp2) ||
+                !loadNorm(weights, name + "_LN1", block.ln1) ||
+                !loadNorm(weights, name + "_LN2", block.ln2)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief res_block: relu(conv1) -> conv2 -> SE -> + shortcut -> relu. x [batch * cells][каналы] заменяется выходом.
+     */
+    void resBlock(const ResBlock &block, std::vector<float> &x, int batch, int side, Scratch &work) {
+        const int rows = batch * side * side;
+        ensure(work.col, static_cast<size_t>(rows) * 9 * std::max(block.conv1.in, block.conv2.in));
+        ensure(work.tmp, static_cast<size_t>(rows) * block.conv1.out);
+        ensure(work.tmp2, static_cast<size_t>(rows) * block.conv2.out);
+
+        nnKernels::im2col3x3(x.data(), batch, side, side, block.conv1.in / 9, work.col.data());
+        apply(block.conv1, work.col.data(), rows, work.tmp.data(), work);
+        nnKernels::relu(work.tmp.data(), static_cast<size_t>(rows) * block.conv1.out);
+        nnKernels::im2col3x3(work.tmp.data(), batch, side, side, block.conv2.in / 9, work.col.data());
+        apply(block.conv2, work.col.data(), rows, work.tmp2.data(), work);
+
+        const int channels = block.conv2.out;
+        const int cells = side * side;
+        if (block.hasSE) {
+            ensure(work.se, static_cast<size_t>(batch) * channels);
+            ensure(work.seHidden, static_cast<size_t>(batch) * block.seReduce.out);
+            for (int b = 0; b < batch; ++b) {
+                float *mean = &work.se[static_cast<size_t>(b) * channels];
+                std::fill(mean, mean + channels, 0.0f);
+                for (int cell = 0; cell < cells; ++cell) {
+                    nnKernels::add(mean, &work.tmp2[(static_cast<size_t>(b) * cells + cell) * channels], channels);
+                }
+                for (int c = 0; c < channels; ++c) {
+                    mean[c] /= static_cast<float>(cells);
+                }
+            }
+            apply(block.seReduce, work.se.data(), batch, work.seHidden.data(), work);
+            nnKernels::relu(work.seHidden.data(), static_cast<size_t>(batch) * block.seReduce.out);
+            apply(block.seExpand, work.seHidden.data(), batch, work.se.data(), work);
+            nnKernels::sigmoid(work.se.data(), static_cast<size_t>(batch) * channels);
+            for (int b = 0; b < batch; ++b) {
+                const float *scale = &work.se[static_cast<size_t>(b) * channels];
+                for (int cell = 0; cell < cells; ++cell) {
+                    float *y = &work.tmp2[(static_cast<size_t>(b) * cells + cell) * channels];
+                    for (int c = 0; c < channels; ++c) {
+                        y[c] *= scale[c];
+                    }
+                }
+            }
+        }
+
+        if (block.hasShortcut) {
+            ensure(work.tmp, static_cast<size_t>(rows) * channels);
+            apply(block.shortcut, x.data(), rows, work.tmp.data(), work);
+            nnKernels::add(work.tmp2.data(), work.tmp.data(), static_cast<size_t>(rows) * channels);
+        } else {
+            nnKernels::add(work.tmp2.data(), x.data(), static_cast<size_t>(rows) * channels);
+        }
+        nnKernels::relu(work.tmp2.data(), static_cast<size_t>(rows) * channels);
+        std::swap(x, work.tmp2);
+    }
+
+    /**
+     * @brief transformer_encoder_block: x = LN1(x + MHA(x)), x = LN2(x + MLP(x)); x [batch * 9][attnDim].
+     */
+    void attnBlock(const AttnBlock &block, std::vector<float> &x, int batch, Scratch &work) {
+        const int rows = batch * 9;
+        const int width = block.heads * block.keyDim;
+        ensure(work.qkv, static_cast<size_t>(rows) * 3 * width);
+        ensure(work.ctx, static_cast<size_t>(rows) * width);
+        ensure(work.tmp, static_cast<size_t>(rows) * attnDim);
+        ensure(work.hidden, static_cast<size_t>(rows) * block.mlp1.out);
+
+        apply(block.qkv, x.data(), rows, work.qkv.data(), work);
+        const float scale = 1.0f / std::sqrt(static_cast<float>(block.keyDim));
+        const size_t stride = 3 * width;
+        for (int b = 0; b < batch; ++b) {
+            const float *tokenQkv = &work.qkv[static_cast<size_t>(b) * 9 * stride];
+            for (int h = 0; h < block.heads; ++h) {
+                const int head = h * block.keyDim;
+                for (int i = 0; i < 9; ++i) {
+                    const float *q = tokenQkv + i * stride + head;
+                    float scores[9];
+                    for (int j = 0; j < 9; ++j) {
+                        const float *k = tokenQkv + j * stride + width + head;
+                        float dot = 0.0f;
+                        for (int d = 0; d < block.keyDim; ++d) {
+                            dot += q[d] * k[d];
+                        }
+                        scores[j] = dot * scale;
+                    }
+                    nnKernels::softmax(scores, 9);
+                    float *context = &work.ctx[(static_cast<size_t>(b) * 9 + i) * width + head];
+                    std::fill(context, context + block.keyDim, 0.0f);
+                    for (int j = 0; j < 9; ++j) {
+                        const float *v = tokenQkv + j * stride + 2 * width + head;
+                        for (int d = 0; d < block.keyDim; ++d) {
+                            context[d] += scores[j] * v[d];
+                        }
+                    }
+                }
+            }
+        }
+        apply(block.attnOutput, work.ctx.data(), rows, work.tmp.data(), work);
+        nnKernels::add(x.data(), work.tmp.data(), static_cast<size_t>(rows) * attnDim);
+        nnKernels::layerNorm(x.data(), rows, attnDim, block.ln1.gamma.data(), block.ln1.beta.data(), block.ln1.epsilon);
+
+        apply(block.mlp1, x.data(), rows, work.hidden.data(), work);
+        nnKernels::relu(work.hidden.data(), static_cast<size_t>(rows) * block.mlp1.out);
+        apply(block.mlp2, work.hidden.data(), rows, work.tmp.data(), work);
+        nnKernels::add(x.data(), work.tmp.data(), static_cast<size_t>(rows) * attnDim);
+        nnKernels::layerNorm(x.data(), rows, attnDim, block.ln2.gamma.data(), block.ln2.beta.data(), block.ln2.epsilon);
+    }
+
+    /// Значение номер k записи состояния: байт или бит (NN_INPUT_PACKED)
+    static inline float channelValue(const uint8_t *state, int k) {
+        if constexpr (stateToChannels::PACKED) {
+            return static_cast<float>((state[k >> 3] >> (k & 7)) & 1);
+        } else {
+            return static_cast<float>(state[k]);
+        }
+    }
+
+    void forward(const uint8_t *mainChannels, const uint8_t *macroChannels, int batch, float *values, Scratch &work) {
+        const int mainValues = static_cast<int>(stateToChannels::MAIN_VALUES);
+        const int macroValues = static_cast<int>(stateToChannels::MACRO_VALUES);
+        const int mergedWidth = attnDim + 9 * macroFilters;
+
+        // (1) Входы: [batch * 81][6] и [batch * 9][2]
+        ensure(work.tmp, static_cast<size_t>(batch) * mainValues);
+        for (int b = 0; b < batch; ++b) {
+            const uint8_t *state = mainChannels + b * stateToChannels::MAIN_BYTES;
+            for (int k = 0; k < mainValues; ++k) {
+                work.tmp[static_cast<size_t>(b) * mainValues + k] = channelValue(state, k);
+            }
+        }
+
+        // (2) Локальная ветвь: свёртка + ResNet
+        const int localRows = batch * 81;
+        ensure(work.col, static_cast<size_t>(localRows) * locInit.in);
+        ensure(work.act, static_cast<size_t>(localRows) * locInit.out);
+        nnKernels::im2col3x3(work.tmp.data(), batch, 9, 9, locInit.in / 9, work.col.data());
+        apply(locInit, work.col.data(), localRows, work.act.data(), work);
+        nnKernels::relu(work.act.data(), static_cast<size_t>(localRows) * locInit.out);
+        for (const ResBlock &block: locBlocks) {
+            resBlock(block, work.act, batch, 9, work);
+        }
+
+        // (3) extract_9_tokens: токен — малая доска (bh * 3 + bw), признаки — клетки доски (r * 3 + c) по localFilters
+        ensure(work.tokens, static_cast<size_t>(batch) * 9 * 9 * localFilters);
+        for (int b = 0; b < batch; ++b) {
+            for (int h = 0; h < 9; ++h) {
+                for (int w = 0; w < 9; ++w) {
+                    const int token = (h / 3) * 3 + w / 3;
+                    const int cell = (h % 3) * 3 + w % 3;
+                    std::copy_n(&work.act[(static_cast<size_t>(b) * 81 + h * 9 + w) * localFilters], localFilters,
+                                &work.tokens[((static_cast<size_t>(b) * 9 + token) * 9 + cell) * localFilters]);
+                }
+            }
+        }
+        ensure(work.act, static_cast<size_t>(batch) * 9 * attnDim);
+        apply(tokenProject, work.tokens.data(), batch * 9, work.act.data(), work);
+        nnKernels::relu(work.act.data(), static_cast<size_t>(batch) * 9 * attnDim);
+        for (const AttnBlock &block: attnBlocks) {
+            attnBlock(block, work.act, batch, work);
+        }
+
+        // (4) GlobalAveragePooling1D по 9 токенам -> merged[b][0 .. attnDim)
+        ensure(work.merged, static_cast<size_t>(batch) * mergedWidth);
+        for (int b = 0; b < batch; ++b) {
+            float *pooled = &work.merged[static_cast<size_t>(b) * mergedWidth];
+            std::fill(pooled, pooled + attnDim, 0.0f);
+            for (int token = 0; token < 9; ++token) {
+                nnKernels::add(pooled, &work.act[(static_cast<size_t>(b) * 9 + token) * attnDim], attnDim);
+            }
+            for (int i = 0; i < attnDim; ++i) {
+                pooled[i] /= 9.0f;
+            }
+        }
+
+        // (5) Макроветвь: свёртка + ResNet, Flatten (h, w, c) -> merged[b][attnDim ..)
+        const int macroRows = batch * 9;
+        ensure(work.tmp, static_cast<size_t>(batch) * macroValues);
+        for (int b = 0; b < batch; ++b) {
+            const uint8_t *state = macroChannels + b * stateToChannels::MACRO_BYTES;
+            for (int k = 0; k < macroValues; ++k) {
+                work.tmp[static_cast<size_t>(b) * macroValues + k] = channelValue(state, k);
+            }
+        }
+        ensure(work.col, static_cast<size_t>(macroRows) * macInit.in);
+        ensure(work.act, static_cast<size_t>(macroRows) * macInit.out);
+        nnKernels::im2col3x3(work.tmp.data(), batch, 3, 3, macInit.in / 9, work.col.data());
+        apply(macInit, work.col.data(), macroRows, work.act.data(), work);
+        nnKernels::relu(work.act.data(), static_cast<size_t>(macroRows) * macInit.out);
+        for (const ResBlock &block: macBlocks) {
+            resBlock(block, work.act, batch, 3, work);
+        }
+        for (int b = 0; b < batch; ++b) {
+            std::copy_n(&work.act[static_cast<size_t>(b) * 9 * macroFilters], 9 * macroFilters,
+                        &work.merged[static_cast<size_t>(b) * mergedWidth + attnDim]);
+        }
+
+        // (6) Dense-голова (BN свёрнута) и tanh
+        const float *x = work.merged.data();
+        std::vector<float> *buffers[2] = {&work.act, &work.tmp};
+        for (size_t i = 0; i < dense.size(); ++i) {
+            std::vector<float> &y = *buffers[i % 2];
+            ensure(y, static_cast<size_t>(batch) * dense[i].out);
+            apply(dense[i], x, batch, y.data(), work);
+            nnKernels::relu(y.data(), static_cast<size_t>(batch) * dense[i].out);
+            x = y.data();
+        }
+        apply(output, x, batch, values, work);
+        for (int b = 0; b < batch; ++b) {
+            values[b] = std::tanh(values[b]);
+        }
+    }
+};
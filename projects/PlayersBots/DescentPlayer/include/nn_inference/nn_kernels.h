@@ -0,0 +1,251 @@
+// nn_kernels.h
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+/**
+ * @brief Вычислительные ядра ValueNet: линейный слой (Dense и свёртка через im2col) и поэлементные операции.
+ *
+ * Все активации — построчные матрицы float [строки][признаки]; для свёрток строка — клетка (NHWC).
+ */
+namespace nnKernels {
+    constexpr int PANEL = 16; ///< Столбцов выхода в одной панели весов (2 регистра AVX2)
+    constexpr int ROW_BLOCK = 4; ///< Строк входа на один проход по панели
+
+    /**
+     * @brief Линейный слой y = x · W + b с весами, переложенными по панелям при загрузке.
+     *
+     * weights[panel][k][0..15] — столбцы panel * 16 .. panel * 16 + 15 строки k матрицы W [in][out];
+     * последняя панель и bias дополнены нулями. Проход по панели читает веса подряд.
+     * Веса в том же порядке могут лежать и вне объекта — в отображённом файле (ValueNet::mapBlob).
+     */
+    struct Linear {
+        int in = 0;
+        int out = 0;
+        int panels = 0;
+        int id = -1; ///< Номер слоя в сети (ValueNet: калибровка и int8-копия слоя)
+        std::vector<float> weights;
+        std::vector<float> bias;
+        const float *mappedWeights = nullptr; ///< Не nullptr — веса и bias берутся отсюда, weights и bias пусты
+        const float *mappedBias = nullptr;
+
+        inline const float *weightData() const {
+            return mappedWeights != nullptr ? mappedWeights : weights.data();
+        }
+
+        inline const float *biasData() const {
+            return mappedBias != nullptr ? mappedBias : bias.data();
+        }
+
+        inline size_t weightCount() const {
+            return static_cast<size_t>(panels) * in * PANEL;
+        }
+
+        /// Слой поверх уже разложенных по панелям весов (weightCount() и panels * 16 чисел)
+        void map(const float *panelWeights, const float *panelBias, int inputs, int outputs) {
+            in = inputs;
+            out = outputs;
+            panels = (outputs + PANEL - 1) / PANEL;
+            weights.clear();
+            bias.clear();
+            mappedWeights = panelWeights;
+            mappedBias = panelBias;
+        }
+
+        /// W — [in][out] построчно (kernel Keras, свёрточный — как [kh * kw * in][out])
+        void assign(const float *W, const float *b, int inputs, int outputs) {
+            mappedWeights = nullptr;
+            mappedBias = nullptr;
+            in = inputs;
+            out = outputs;
+            panels = (outputs + PANEL - 1) / PANEL;
+            weights.assign(static_cast<size_t>(panels) * in * PANEL, 0.0f);
+            bias.assign(static_cast<size_t>(panels) * PANEL, 0.0f);
+            for (int k = 0; k < in; ++k) {
+                for (int o = 0; o < out; ++o) {
+                    weights[(static_cast<size_t>(o / PANEL) * in + k) * PANEL + o % PANEL] = W[static_cast<size_t>(k) * out + o];
+                }
+            }
+            if (b != nullptr) {
+                std::copy(b, b + out, bias.begin());
+            }
+        }
+
+        /// Умножает столбец o на scale[o] и заменяет bias: для свёртки BatchNormalization в слой
+        void scaleOutputs(const float *scale, const float *shift) {
+            for (int o = 0; o < out; ++o) {
+                float *column = &weights[static_cast<size_t>(o / PANEL) * in * PANEL + o % PANEL];
+                for (int k = 0; k < in; ++k) {
+                    column[static_cast<size_t>(k) * PANEL] *= scale[o];
+                }
+                bias[o] = bias[o] * scale[o] + shift[o];
+            }
+        }
+    };
+
+    /// rows строк x [rows][in] -> acc [rows][16] по одной панели
+    template<int rows>
+    inline void panelBlock(const float *x, int in, const float *panel, const float *bias, float *acc) {
+#if defined(__AVX2__)
+        __m256 sum[rows][2];
+        const __m256 bias0 = _mm256_loadu_ps(bias);
+        const __m256 bias1 = _mm256_loadu_ps(bias + 8);
+        for (int r = 0; r < rows; ++r) {
+            sum[r][0] = bias0;
+            sum[r][1] = bias1;
+        }
+        for (int k = 0; k < in; ++k) {
+            const __m256 w0 = _mm256_loadu_ps(panel + k * PANEL);
+            const __m256 w1 = _mm256_loadu_ps(panel + k * PANEL + 8);
+            for (int r = 0; r < rows; ++r) {
+                const __m256 a = _mm256_broadcast_ss(x + static_cast<size_t>(r) * in + k);
+#if defined(__FMA__)
+                sum[r][0] = _mm256_fmadd_ps(a, w0, sum[r][0]);
+                sum[r][1] = _mm256_fmadd_ps(a, w1, sum[r][1]);
+#else
+                sum[r][0] = _mm256_add_ps(sum[r][0], _mm256_mul_ps(a, w0));
+                sum[r][1] = _mm256_add_ps(sum[r][1], _mm256_mul_ps(a, w1));
+#endif
+            }
+        }
+        for (int r = 0; r < rows; ++r) {
+            _mm256_storeu_ps(acc + r * PANEL, sum[r][0]);
+            _mm256_storeu_ps(acc + r * PANEL + 8, sum[r][1]);
+        }
+#else
+        for (int r = 0; r < rows; ++r) {
+            std::memcpy(acc + r * PANEL, bias, PANEL * sizeof(float));
+        }
+        for (int k = 0; k < in; ++k) {
+            const float *w = panel + k * PANEL;
+            for (int r = 0; r < rows; ++r) {
+                const float a = x[static_cast<size_t>(r) * in + k];
+                for (int j = 0; j < PANEL; ++j) {
+                    acc[r * PANEL + j] += a * w[j];
+                }
+            }
+        }
+#endif
+    }
+
+    /**
+     * @brief y [rows][out] = x [rows][in] · W + b
+     */
+    inline void linear(const Linear &layer, const float *x, int rows, float *y) {
+        alignas(32) float acc[ROW_BLOCK * PANEL];
+        for (int p = 0; p < layer.panels; ++p) {
+            const float *panel = layer.weightData() + static_cast<size_t>(p) * layer.in * PANEL;
+            const float *bias = layer.biasData() + p * PANEL;
+            const int columns = std::min(PANEL, layer.out - p * PANEL);
+            for (int r = 0; r < rows; r += ROW_BLOCK) {
+                const int block = std::min(ROW_BLOCK, rows - r);
+                const float *xr = x + static_cast<size_t>(r) * layer.in;
+                switch (block) {
+                    case 4: panelBlock<4>(xr, layer.in, panel, bias, acc);
+                        break;
+                    case 3: panelBlock<3>(xr, layer.in, panel, bias, acc);
+                        break;
+                    case 2: panelBlock<2>(xr, layer.in, panel, bias, acc);
+                        break;
+                    default: panelBlock<1>(xr, layer.in, panel, bias, acc);
+                }
+                for (int i = 0; i < block; ++i) {
+                    std::memcpy(y + static_cast<size_t>(r + i) * layer.out + p * PANEL, acc + i * PANEL,
+                                columns * sizeof(float));
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Столбцы свёртки 3×3 (padding 'same'): col[клетка][(dy * 3 + dx) * channels + c].
+     * @param x  [batch][height][width][channels]
+     */
+    inline void im2col3x3(const float *x, int batch, int height, int width, int channels, float *col) {
+        const size_t rowSize = static_cast<size_t>(9) * channels;
+        for (int b = 0; b < batch; ++b) {
+            for (int h = 0; h < height; ++h) {
+                for (int w = 0; w < width; ++w) {
+                    float *row = col + (static_cast<size_t>(b * height + h) * width + w) * rowSize;
+                    for (int dy = 0; dy < 3; ++dy) {
+                        for (int dx = 0; dx < 3; ++dx) {
+                            float *dst = row + (dy * 3 + dx) * channels;
+                            const int sh = h + dy - 1;
+                            const int sw = w + dx - 1;
+                            if (sh < 0 || sh >= height || sw < 0 || sw >= width) {
+                                std::memset(dst, 0, channels * sizeof(float));
+                            } else {
+                                std::memcpy(dst, x + (static_cast<size_t>(b * height + sh) * width + sw) * channels,
+                                            channels * sizeof(float));
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    inline void relu(float *x, size_t n) {
+        for (size_t i = 0; i < n; ++i) {
+            x[i] = std::max(x[i], 0.0f);
+        }
+    }
+
+    inline void sigmoid(float *x, size_t n) {
+        for (size_t i = 0; i < n; ++i) {
+            x[i] = 1.0f / (1.0f + std::exp(-x[i]));
+        }
+    }
+
+    /// x += y
+    inline void add(float *x, const float *y, size_t n) {
+        for (size_t i = 0; i < n; ++i) {
+            x[i] += y[i];
+        }
+    }
+
+    /// Нормализация каждой строки x [rows][features] (LayerNormalization по последней оси)
+    inline void layerNorm(float *x, int rows, int features, const float *gamma, const float *beta, float epsilon) {
+        for (int r = 0; r < rows; ++r) {
+            float *row = x + static_cast<size_t>(r) * features;
+            float mean = 0.0f;
+            for (int i = 0; i < features; ++i) {
+                mean += row[i];
+            }
+            mean /= static_cast<float>(features);
+            float variance = 0.0f;
+            for (int i = 0; i < features; ++i) {
+                variance += (row[i] - mean) * (row[i] - mean);
+            }
+            variance /= static_cast<float>(features);
+            const float inv = 1.0f / std::sqrt(variance + epsilon);
+            for (int i = 0; i < features; ++i) {
+                row[i] = (row[i] - mean) * inv * gamma[i] + beta[i];
+            }
+        }
+    }
+
+    /// Softmax строки длины n на месте
+    inline void softmax(float *x, int n) {
+        float maxValue = x[0];
+        for (int i = 1; i < n; ++i) {
+            maxValue = std::max(maxValue, x[i]);
+        }
+        float sum = 0.0f;
+        for (int i = 0; i < n; ++i) {
+            x[i] = std::exp(x[i] - maxValue);
+            sum += x[i];
+        }
+        for (int i = 0; i < n; ++i) {
+            x[i] /= sum;
+        }
+    }
+}
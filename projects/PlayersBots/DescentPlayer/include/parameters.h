@@ -1,6 +1,7 @@
 // parameters.h
 #pragma once
 #include <bits/random.h>
+#include <cstddef>
 
 namespace params {
     constexpr int SAMPLE_SIZE = 5000;
@@ -9,4 +10,8 @@ namespace params {
     constexpr float MOVE_TIME_LIMIT = 1.0f; //sec
     //----------------------
     constexpr int DESCENT_ITERATION_COUNT = 100; //сколько раз повторять descentIteration
+    //бюджет таблицы узлов Descent на секунду хода: сеть оценивает до ~10 тыс. состояний/с, раскрытие — ~8 потомков,
+    //узел ~100 Б, т.е. ~0.1 MB узлов за секунду; 16 MB вмещают узлы целой партии с запасом
+    constexpr std::size_t SEARCH_TABLE_MB_PER_SECOND = 16;
+    constexpr std::size_t SEARCH_TABLE_MIN_MB = 8;
 }
@@ -5,7 +5,6 @@
 #include "big_board/BigBoard.h"       // BigBoard
 #include "shared_memory/SharedMemory.h"
 #include "state_to_nn_representation/state_to_channels.h"
-#include "structures/Map_T.h"         // Map_T
 
 /**
  * @brief Класс для пакетной оценки нетерминальных состояний одним вызовом нейросети.
@@ -16,25 +15,22 @@ public:
 
 private:
     SharedMemory &sharedMem; ///< Ссылка на общий буфер (sampleMainChannels, sampleValues, и т.д.)
-    Map_T &V; ///< Ссылка на карту v(s) и v'(s,a)
     int movesCount; ///< Текущее число записей в батче
 
     /**
-     * Массив ходов (move), по которым будем потом
-     * присваивать значения v'(parentState, move).
+     * Ячейки v'(parentState, a) в узле родителя,
+     * куда будем потом присваивать оценки.
      * Индекс i соответствует i-му добавленному состоянию.
      */
-    uint8_t moves[MAX_SIZE];
+    float *targets[MAX_SIZE];
 
 public:
     /**
      * @brief Конструктор
      * @param shm   - ссылка на уже созданный SharedMemory (глобальный на всё приложение)
-     * @param mapV  - ссылка на Map_T (хранит v(s), v'(s,a))
      */
-    BatchEvaluator(SharedMemory &shm, Map_T &mapV)
+    explicit BatchEvaluator(SharedMemory &shm)
         : sharedMem(shm)
-          , V(mapV)
           , movesCount(0) {
     }
 
@@ -49,8 +45,9 @@ public:
 
     /**
      * @brief Добавляем нетерминальное состояние (child) в общий буфер.
+     * @param target - ячейка v'(parentState, a) для оценки child = a(parentState)
      */
-    inline void addNonTerminalState(const BigBoard &childBoard, uint8_t move) {
+    inline void addNonTerminalState(const BigBoard &childBoard, float *target) {
         // (1) Найдём адрес, куда писать каналы для i-го child
         const int i = movesCount;
         uint8_t *dstMain = sharedMem.sampleMainChannels + (std::size_t) i * (9 * 9 * 6);
@@ -59,8 +56,8 @@ public:
         // (2) Конвертируем состояние BigBoard -> каналы
         stateToChannels::convert(&childBoard, dstMain, dstMacro);
 
-        // (3) Запоминаем ход
-        moves[i] = move;
+        // (3) Запоминаем ячейку v'(s,a)
+        targets[i] = target;
 
         // (4) Увеличиваем счётчик
         movesCount++;
@@ -68,15 +65,16 @@ public:
 
     /**
      * @brief Запустить нейросеть на всём батче добавленных состояний
-     *        и записать результаты в V(parentState, move).
+     *        и записать результаты в v'(parentState, a).
      */
     inline void evaluateAllNonTerminalChildStates(BigBoard *parentState) {
         if (movesCount == 0) [[unlikely]] {
             return; // Нечего оценивать
         }
 
-        // (1) Сообщаем Python, сколько реально child-состояний
+        // (1) Сообщаем Python, сколько реально child-состояний и где они лежат (с начала буферов)
         sharedMem.intVars[0] = movesCount;
+        sharedMem.intVars[SharedMemory::evaluateOffsetVar] = 0;
 
         // (2) Запуск Evaluate() (один вызов)
         sharedMem.Evaluate();
@@ -89,7 +87,7 @@ public:
             for (int i = 0; i < movesCount; i++) {
                 float netVal = sharedMem.sampleValues[i];
                 // v'(s, a) = netVal
-                V(parentState, moves[i]) = netVal;
+                *targets[i] = netVal;
             }
         } else {
             // Если реальный ход O, то каналы со свапом,
@@ -97,7 +95,7 @@ public:
             // => нужно инвертировать знак, чтобы оставалось + = X в глобальных координатах
             for (int i = 0; i < movesCount; i++) {
                 float netVal = sharedMem.sampleValues[i];
-                V(parentState, moves[i]) = -netVal;
+                *targets[i] = -netVal;
             }
         }
 
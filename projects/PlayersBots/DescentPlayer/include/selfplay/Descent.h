@@ -5,8 +5,7 @@
 
 #include "BatchEvaluator.h"
 #include "parameters.h"
-#include "structures/Set_S.h"
-#include "structures/Map_T.h"
+#include "structures/SearchTable.h"
 #include "big_board/BigBoard.h"
 #include "utils/Counter.h"
 
@@ -17,11 +16,10 @@ private:
 
 public:
     /**
-     * @param s - ссылка на множество состояний (Set_S), в котором храним посещённые BigBoard
-     * @param v - ссылка на Map_T, где храним v(s) и v'(s,a)
+     * @param table - таблица узлов (s ∈ S вместе с v(s) и v'(s,a)) с фиксированным бюджетом памяти
      */
-    Descent(Set_S &s, Map_T &v, SharedMemory &shm)
-        : S(s), V(v), counter(params::DESCENT_ITERATION_COUNT), batchEvaluator(shm, v) {
+    Descent(SearchTable &table, SharedMemory &shm)
+        : T(table), counter(params::DESCENT_ITERATION_COUNT), batchEvaluator(shm) {
     }
 
     /**
@@ -37,19 +35,24 @@ public:
     //     }
     // }
 
-    void descent(BigBoard *board, float moveTimeLimit) {
+    /**
+     * @param ply - сколько ходов сделано в партии до board (для вытеснения узлов из SearchTable)
+     */
+    void descent(BigBoard *board, int ply, float moveTimeLimit) {
         // while (!counter.isCountExceeded()) {
         //     descentIteration(board);
         // }
+        T.beginSearch(ply);
         resetTimer();
         int iterCount = 0;
         evaluatedStateCount = 0;
         while (!isTimeExceeded(moveTimeLimit)) {
-            descentIteration(board);
+            descentIteration(board, ply);
             ++iterCount;
         }
         std::cout << "\niterations count = " << iterCount << std::endl;
         std::cout << "States NN evaluated = " << evaluatedStateCount << std::endl;
+        T.printOccupancy();
     }
 
     /**
@@ -73,53 +76,61 @@ public:
     *        v(s) ← v′(s, ab)
     *    return v(s)
      */
-    float descentIteration(BigBoard *state) {
+    float descentIteration(BigBoard *state, int ply) {
         // 1) Проверка на терминальность
+        //    (терминальные состояния не хранятся: игроку v(s) нужно только как возвращаемое значение)
         if (state->isGameOver()) {
-            float score = state->getTerminalScore();
-            if (!S.contains(state))
-                S.add(state); // S ← S ∪ {s}
-            V(state) = score; // v(s) ← ft(s)
-            return score;
+            return state->getTerminalScore(); // v(s) ← ft(s)
         }
 
-        // 2) Если s не в S, инициализируем v'(s,a)
-        if (!S.contains(state)) {
-            S.add(state);
-
-            uint8_t *moves = state->getValidMoves(); // все действия
+        uint8_t *moves = state->getValidMoves(); // все действия
+        const int movesCount = moves[0];
 
-            int movesCount = moves[0];
-            for (int i = 1; i <= movesCount; ++i) {
-                uint8_t move = moves[i]; //foreach a ∈ actions(s)
+        // 2) Если s не в S, инициализируем v'(s,a).
+        //    Узел мог быть вытеснен из таблицы — тогда s раскрывается заново.
+        SearchNode *node = T.find(state, movesCount);
+        float localValues[bigBoardArrays::movesSize]; // если весь набор таблицы занят путём итерации
+        float *childValues;
+        if (node != nullptr) {
+            childValues = node->childValues();
+        } else {
+            node = T.insert(state, movesCount, ply); // S ← S ∪ {s}
+            childValues = node != nullptr ? node->childValues() : localValues;
 
+            for (int i = 0; i < movesCount; ++i) { //foreach a ∈ actions(s)
                 BigBoard stateAfterMove = *state; // child = a(s)
-                stateAfterMove.applyMove(move);
+                stateAfterMove.applyMove(moves[i + 1]);
 
                 if (stateAfterMove.isGameOver()) {
-                    S.add(&stateAfterMove); // S ← S ∪ {a(s)}
-                    float termVal = stateAfterMove.getTerminalScore();
-                    V(state, move) = termVal; // v′(s,a) ← ft(a(s))
-                    V(&stateAfterMove) = termVal; // v(a(s)) ← v′(s,a)
+                    childValues[i] = stateAfterMove.getTerminalScore(); // v′(s,a) ← ft(a(s))
                 } else {
-                    batchEvaluator.addNonTerminalState(stateAfterMove, move); //v′(s, a) ← fθ(a(s))
+                    batchEvaluator.addNonTerminalState(stateAfterMove, &childValues[i]); //v′(s, a) ← fθ(a(s))
                     evaluatedStateCount++;
                 }
             }
             batchEvaluator.evaluateAllNonTerminalChildStates(state);
         }
 
-        uint8_t bestMove = bestActionOf(state); // ab ← best_action(s)
+        int best = bestActionOf(state, childValues, movesCount); // ab ← best_action(s)
         {
             BigBoard stateAfterBestMove = *state;
-            stateAfterBestMove.applyMove(bestMove);
+            stateAfterBestMove.applyMove(moves[best + 1]);
+            // Узел на пути итерации не должен быть вытеснен, пока спускаемся под ним
+            if (node != nullptr) {
+                node->pinned = 1;
+            }
             // v′(s, ab) ← descent_iteration(ab(s))
-            V(state, bestMove) = descentIteration(&stateAfterBestMove);
+            childValues[best] = descentIteration(&stateAfterBestMove, ply + 1);
+            if (node != nullptr) {
+                node->pinned = 0;
+            }
         }
 
-        uint8_t finalAction = bestActionOf(state); // ab ← best_action(s) (повторный вызов)
-        float finalVal = V(state, finalAction); // v(s) ← v′(s, ab)
-        V(state) = finalVal;
+        best = bestActionOf(state, childValues, movesCount); // ab ← best_action(s) (повторный вызов)
+        float finalVal = childValues[best]; // v(s) ← v′(s, ab)
+        if (node != nullptr) {
+            node->value = finalVal;
+        }
 
         return finalVal; // return v(s)
     }
@@ -128,51 +139,45 @@ public:
      * Поиск лучшего действия (best_action) в зависимости от игрока.
      * Если текущий игрок X=0, то берём argmax,
      * если O=1, то argmin.
+     *
+     * @param childValues - v'(s,a) в порядке getValidMoves()
+     * @return индекс лучшего хода (ход — moves[index + 1])
      */
-    inline uint8_t bestActionOf(BigBoard *state) {
+    inline int bestActionOf(const BigBoard *state, const float *childValues, int movesCount) {
         // Сразу определим, кто игрок (X=0 => maximize, O=1 => minimize)
         const bool isFirstPlayer = (state->getCurrentPlayer() == cell::X);
 
-        const uint8_t *moves = state->getValidMoves();
-        const int movesCount = moves[0];
-
-        // Адрес массива действий (пропускаем moves[0], где хранится movesCount)
-        const uint8_t *actions = moves + 1;
-
         if (isFirstPlayer) {
             // Максимизируем v'(s,a)
             float bestVal = -1e9f;
-            uint8_t bestAction = actions[0];
+            int best = 0;
 
             for (int i = 0; i < movesCount; ++i) {
-                uint8_t action = actions[i];
-                float val = V(state, action); // v'(s,a)
+                float val = childValues[i]; // v'(s,a)
                 if (val > bestVal) {
                     bestVal = val;
-                    bestAction = action;
+                    best = i;
                 }
             }
-            return bestAction;
+            return best;
         } else {
             // Минимизируем v'(s,a)
             float bestVal = 1e9f;
-            uint8_t bestAction = actions[0];
+            int best = 0;
 
             for (int i = 0; i < movesCount; ++i) {
-                uint8_t a = actions[i];
-                float val = V(state, a); // v'(s,a)
+                float val = childValues[i]; // v'(s,a)
                 if (val < bestVal) {
                     bestVal = val;
-                    bestAction = a;
+                    best = i;
                 }
             }
-            return bestAction;
+            return best;
         }
     }
 
 private:
-    Set_S &S; ///< Хранилище уникальных состояний
-    Map_T &V; ///< Карта оценок: v(s) и v'(s,a)
+    SearchTable &T; ///< Узлы: s ∈ S, v(s) и v'(s,a)
     Counter counter;
     std::chrono::time_point<std::chrono::high_resolution_clock> startTime;
     /**
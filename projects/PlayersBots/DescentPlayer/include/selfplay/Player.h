@@ -7,21 +7,24 @@
 #include "Descent.h"
 #include "parameters.h"
 #include "big_board/BigBoard.h"
-#include "structures/Map_T.h"
-#include "structures/Set_S.h"
+#include "structures/SearchTable.h"
 
 class Player {
 private:
     BigBoard bigBoard;
-    Set_S setS;
-    Map_T mapV;
+    SearchTable &searchTable;
     Descent descent;
     SharedMemory &sharedMemory;
     float timePerMove;
+    int ply = 0; ///< Сколько ходов сделано в партии
 
 public:
-    Player(SharedMemory &shm, float timePerMove)
-        : descent(setS, mapV, shm)
+    /**
+     * @param table - таблица узлов Descent; живёт дольше игрока (выделяется один раз на сессию)
+     */
+    Player(SharedMemory &shm, SearchTable &table, float timePerMove)
+        : searchTable(table)
+          , descent(table, shm)
           , sharedMemory(shm)
           , timePerMove(timePerMove) {
         bigBoard.stateInit();
@@ -29,17 +32,19 @@ public:
 
     void applyLocalMove(uint8_t moveByte) {
         bigBoard.applyMove(moveByte);
+        ply++;
     }
 
     uint8_t makeNextMove() {
         // (1) Запускаем Descent, чтобы заполнить оценки
-        descent.descent(&bigBoard, timePerMove);
+        descent.descent(&bigBoard, ply, timePerMove);
 
         // (2) Выбираем ход (selectMoveOrdinal будет вставлен вами)
         uint8_t chosenMove = selectMoveOrdinal(&bigBoard, params::ORDINAL_ACTION_RATIO);
 
         // (3) Применяем ход локально
         bigBoard.applyMove(chosenMove);
+        ply++;
 
         // (4) Возвращаем сделанный ход
         return chosenMove;
@@ -66,10 +71,10 @@ private:
 
         MoveVal mv[81];
 
+        SearchNode *node = searchTable.find(board, movesCount); // nullptr, если Descent не успел раскрыть корень
         for (int i = 0; i < movesCount; ++i) {
-            uint8_t m = moves[i + 1];
-            mv[i].move = m;
-            mv[i].val = mapV(board, m);
+            mv[i].move = moves[i + 1];
+            mv[i].val = node != nullptr ? node->childValues()[i] : 0.0f;
         }
 
         // Сортируем массив с использованием оптимизированных компараторов
@@ -3,9 +3,12 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <string>
 #include <pybind11/pybind11.h>
 #include <pybind11/numpy.h>
 
+#include "nn_inference/ValueNet.h"
+
 namespace py = pybind11;
 
 class SharedMemory {
@@ -19,13 +22,21 @@ public:
     uint8_t *sampleMainChannels;    // размер: sampleLength * 9 * 9 * 6
     uint8_t *sampleMacroChannels;   // размер: sampleLength * 3 * 3 * 2
     float *sampleValues;          // размер: sampleLength
-    int *intVars;               // размер: 11
+    int *intVars;               // размер: intVarsCount
     float *floatVars;             // размер: 8
 
-private:
     // Числа элементов в intVars / floatVars
     static constexpr std::size_t intVarsCount = 1024;
     static constexpr std::size_t floatVarsCount = 10;
+    // Смещение участка буферов для Evaluate() (intVars[0] — число состояний) — последний элемент intVars:
+    // путь модели (Do(), intVars[1..] с нулём в конце) до него не доходит
+    static constexpr std::size_t evaluateOffsetVar = intVarsCount - 1;
+    static constexpr std::size_t maxModelPathLength = evaluateOffsetVar - 2;
+
+private:
+
+    // Путь к shared_memory_script: Python запускается при первом обращении к нему (ensureScript)
+    std::string pythonScriptsPath;
 
     // Python-модуль (shared_memory_script)
     py::object shared_memory_script_;
@@ -35,6 +46,9 @@ private:
     py::object evaluate_func_;
     py::object learn_func_;
 
+    // Сеть оценки на C++ из blob-файла (useNativeBlob): пока загружена, Evaluate() обходится без Python
+    ValueNet nativeNet;
+
 public:
     // -------------------------------------------------------
     // КОНСТРУКТОР / ДЕСТРУКТОР
@@ -47,17 +61,46 @@ public:
     // Методы, вызывающие Python-функции
     // -------------------------------------------------------
     inline void Do() {
+        ensureScript();
         do_func_();
     }
 
     inline void Evaluate() {
+        if (nativeNet.isLoaded()) {
+            nativeNet.evaluate(sampleMainChannels, sampleMacroChannels, intVars[0], sampleValues);
+            return;
+        }
+        ensureScript();
         evaluate_func_();
     }
 
     inline void Learn() {
+        ensureScript();
         learn_func_();
     }
 
+    /**
+     * @brief Оценка на C++ по blob-файлу весов (ValueNet::mapBlob, утилита ValueNetBlob):
+     *        файл отображается в память, Python и TensorFlow для оценки не запускаются.
+     * @param path            Пустой — снова оценка в Python
+     * @param checkpointPath  Чекпоинт, который должен был стать этим blob: отпечаток в blob обязан совпасть
+     *                        с его размером и хешем (иначе blob устарел — оценка в Python)
+     * @return false — blob не загружен, Evaluate() идёт в Python
+     */
+    inline bool useNativeBlob(const std::string &path, const std::string &checkpointPath) {
+        ValueNet::SourceStamp checkpoint;
+        if (path.empty() || !ValueNet::stampOf(checkpointPath, checkpoint) || !nativeNet.mapBlob(path)) {
+            nativeNet.reset();
+            return false;
+        }
+        if (nativeNet.blobSource() != checkpoint) {
+            std::cerr << "[SharedMemory] " << path << " was not built from " << checkpointPath << std::endl;
+            nativeNet.reset();
+            return false;
+        }
+        return true;
+    }
+
     // -------------------------------------------------------
     // Геттеры массивов (возвращают NumPy-массивы без копий)
     // -------------------------------------------------------
@@ -84,4 +127,7 @@ private:
 
     // Регистрация класса SharedMemory (однократно)
     static void ensureClassRegistered();
+
+    // Запуск Python и импорт shared_memory_script при первом вызове Do / Evaluate / Learn
+    void ensureScript();
 };
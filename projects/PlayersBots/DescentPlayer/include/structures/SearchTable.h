@@ -0,0 +1,268 @@
+// SearchTable.h
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <type_traits>
+
+#include "big_board/BigBoard.h"
+#include "structures/ZeroedPages.h"
+
+/**
+ * @brief Узел Descent: раскрытое нетерминальное состояние.
+ *
+ * Сразу за заголовком лежат v'(s,a) для всех ходов s в порядке getValidMoves().
+ */
+struct SearchNode {
+    uint64_t key; ///< hashKey состояния (0 — пустая ячейка)
+    float value; ///< v(s)
+    uint16_t generation; ///< Номер поиска, в котором узел использовался последним
+    uint8_t ply; ///< Сколько ходов сделано в партии до этой позиции
+    uint8_t pinned; ///< Узел на пути текущей итерации — не вытесняется
+
+    inline float *childValues() {
+        return reinterpret_cast<float *>(this + 1);
+    }
+};
+
+/**
+ * @brief Таблица узлов Descent с фиксированным бюджетом памяти.
+ *
+ * Вся память выделяется в конструкторе: во время партии нет ни роста, ни rehash,
+ * а RSS не зависит от длины сессии. Ячейки лежат в обнулённых страницах системы (ключ 0 — пустая ячейка),
+ * поэтому резидентной становится только занятая поиском часть бюджета, а не весь он при запуске. Узлы хранятся в двух пулах по числу ходов:
+ * до SMALL_CHILDREN (ход в конкретную малую доску — ячейка 64 байта) и до 81 (свободный выбор доски).
+ * Каждый пул разбит на наборы по WAYS ячеек; ячейка ищется только в наборе своего ключа.
+ *
+ * Вытеснение внутри набора (depth/age-aware):
+ *  1) пустая ячейка;
+ *  2) позиция раньше текущего корня (ply < rootPly) — в этой партии уже недостижима;
+ *  3) узел, дольше всех не использованный поиском (generation), при равенстве — самый глубокий (больший ply):
+ *     узлы ближе к корню обобщают большие поддеревья и дороже для повторного раскрытия.
+ * Закреплённые узлы (путь текущей итерации) не вытесняются; если закреплён весь набор, insert() вернёт nullptr.
+ */
+class SearchTable {
+public:
+    static constexpr int WAYS = 4;
+    static constexpr int SMALL_CHILDREN = 12;
+    static constexpr int LARGE_CHILDREN = 81;
+
+    /**
+     * @param memoryBytes - бюджет памяти на оба пула
+     * @param largeShare  - доля бюджета под узлы со свободным выбором доски
+     *                      (в партиях ~10% позиций, но ячейка в 6 раз больше)
+     */
+    explicit SearchTable(std::size_t memoryBytes, float largeShare = 0.4f)
+        : smallPool(static_cast<std::size_t>(memoryBytes * (1.0f - largeShare))),
+          largePool(static_cast<std::size_t>(memoryBytes * largeShare)),
+          currentGeneration(0),
+          rootPly(0) {
+    }
+
+    SearchTable(const SearchTable &) = delete;
+
+    SearchTable &operator=(const SearchTable &) = delete;
+
+    /**
+     * @brief Начало поиска из корня с rootPly сделанными ходами: новое поколение,
+     *        все позиции раньше корня становятся кандидатами на вытеснение.
+     */
+    void beginSearch(int rootPlyCount) {
+        currentGeneration++;
+        rootPly = static_cast<uint8_t>(rootPlyCount);
+        smallPool.resetSearchStats();
+        largePool.resetSearchStats();
+    }
+
+    /**
+     * @brief Узел состояния s с movesCount ходами или nullptr. Найденный узел помечается текущим поиском.
+     */
+    inline SearchNode *find(const BigBoard *s, int movesCount) {
+        return movesCount <= SMALL_CHILDREN
+                   ? smallPool.find(s->hashKey, currentGeneration)
+                   : largePool.find(s->hashKey, currentGeneration);
+    }
+
+    /**
+     * @brief Создаёт узел s (v(s) и v'(s,a) не инициализированы — их заполняет раскрытие).
+     * @return nullptr, если весь набор закреплён текущей итерацией
+     */
+    inline SearchNode *insert(const BigBoard *s, int movesCount, int ply) {
+        return movesCount <= SMALL_CHILDREN
+                   ? smallPool.insert(s->hashKey, static_cast<uint8_t>(ply), currentGeneration, rootPly)
+                   : largePool.insert(s->hashKey, static_cast<uint8_t>(ply), currentGeneration, rootPly);
+    }
+
+    /**
+     * @brief Все узлы удаляются (новая партия): страницы возвращаются системе, бюджет прежний.
+     */
+    void clear() {
+        smallPool.clear();
+        largePool.clear();
+    }
+
+    inline std::size_t memoryBytes() const {
+        return smallPool.memoryBytes() + largePool.memoryBytes();
+    }
+
+    /**
+     * @brief Заполненность и вытеснения за последний поиск — для подбора params::SEARCH_TABLE_MB_PER_SECOND.
+     *        Если заметная часть вытеснений приходится на узлы текущего поиска, таблица мала.
+     */
+    void printOccupancy() const {
+        std::cout << "Search table (" << memoryBytes() / (1 << 20) << " MB):" << std::endl;
+        smallPool.printOccupancy("small");
+        largePool.printOccupancy("large");
+    }
+
+private:
+    template<int CHILDREN>
+    struct alignas(64) NodeSlot {
+        SearchNode node;
+        float childValues[CHILDREN];
+    };
+
+    static_assert(sizeof(NodeSlot<SMALL_CHILDREN>) == 64, "Small node must fill exactly one cache line");
+    static_assert(offsetof(NodeSlot<SMALL_CHILDREN>, childValues) == sizeof(SearchNode),
+                  "SearchNode::childValues() expects v'(s,a) right after the header");
+    static_assert(std::is_trivial_v<NodeSlot<LARGE_CHILDREN>>, "Slots live in zeroed pages without constructors");
+
+    /**
+     * @brief Пул ячеек одного размера: наборы по WAYS ячеек, номер набора — младшие биты ключа.
+     */
+    template<int CHILDREN>
+    class NodePool {
+    public:
+        explicit NodePool(std::size_t memoryBytes) : setsCount(1), nodesCount(0) {
+            while (setsCount * 2 * WAYS * sizeof(NodeSlot<CHILDREN>) <= memoryBytes) {
+                setsCount *= 2;
+            }
+            pages.allocate(setsCount * WAYS * sizeof(NodeSlot<CHILDREN>));
+            slots = static_cast<NodeSlot<CHILDREN> *>(pages.data());
+            resetSearchStats();
+        }
+
+        inline SearchNode *find(uint64_t key, uint16_t generation) {
+            key = nonZero(key);
+            NodeSlot<CHILDREN> *set = setOf(key);
+            for (int w = 0; w < WAYS; ++w) {
+                SearchNode &node = set[w].node;
+                if (node.key == key) {
+                    if (node.generation != generation) {
+                        node.generation = generation;
+                        reusedNodes++;
+                    }
+                    return &node;
+                }
+            }
+            return nullptr;
+        }
+
+        inline SearchNode *insert(uint64_t key, uint8_t ply, uint16_t generation, uint8_t rootPly) {
+            key = nonZero(key);
+            NodeSlot<CHILDREN> *set = setOf(key);
+            SearchNode *victim = nullptr;
+            int victimScore = -1;
+            for (int w = 0; w < WAYS; ++w) {
+                SearchNode &node = set[w].node;
+                if (node.pinned) {
+                    continue;
+                }
+                int score = evictionScore(node, generation, rootPly);
+                if (score > victimScore) {
+                    victimScore = score;
+                    victim = &node;
+                }
+            }
+            if (victim == nullptr) [[unlikely]] {
+                insertFailures++;
+                return nullptr;
+            }
+
+            if (victim->key == 0) {
+                nodesCount++;
+            } else if (victim->ply < rootPly) {
+                evictedUnreachable++;
+            } else if (victim->generation != generation) {
+                evictedStale++;
+            } else {
+                evictedCurrent++;
+            }
+            victim->key = key;
+            victim->value = 0.0f;
+            victim->generation = generation;
+            victim->ply = ply;
+            victim->pinned = 0;
+            insertedNodes++;
+            return victim;
+        }
+
+        void clear() {
+            pages.zero();
+            slots = static_cast<NodeSlot<CHILDREN> *>(pages.data());
+            nodesCount = 0;
+        }
+
+        void resetSearchStats() {
+            insertedNodes = 0;
+            reusedNodes = 0;
+            evictedUnreachable = 0;
+            evictedStale = 0;
+            evictedCurrent = 0;
+            insertFailures = 0;
+        }
+
+        inline std::size_t memoryBytes() const {
+            return setsCount * WAYS * sizeof(NodeSlot<CHILDREN>);
+        }
+
+        void printOccupancy(const char *name) const {
+            const std::size_t capacity = setsCount * WAYS;
+            std::cout << "  " << name << ": " << nodesCount << " / " << capacity << " nodes ("
+                    << 100.0 * static_cast<double>(nodesCount) / static_cast<double>(capacity) << "%)"
+                    << ", search: inserted " << insertedNodes << ", reused " << reusedNodes
+                    << ", evicted unreachable/stale/current " << evictedUnreachable << "/" << evictedStale
+                    << "/" << evictedCurrent << ", insert failures " << insertFailures << std::endl;
+        }
+
+    private:
+        std::size_t setsCount;
+        ZeroedPages pages;
+        NodeSlot<CHILDREN> *slots; ///< Ячейки в pages; нулевые байты — пустая ячейка
+        std::size_t nodesCount;
+        long insertedNodes;
+        long reusedNodes; ///< Узлы прошлых поисков, снова понадобившиеся в этом
+        long evictedUnreachable;
+        long evictedStale;
+        long evictedCurrent;
+        long insertFailures;
+
+        static inline uint64_t nonZero(uint64_t key) {
+            return key + (key == 0);
+        }
+
+        inline NodeSlot<CHILDREN> *setOf(uint64_t key) {
+            return &slots[(key & (setsCount - 1)) * WAYS];
+        }
+
+        /**
+         * Чем больше, тем охотнее вытесняем: пустая > недостижимая > давно не использованная > глубже.
+         */
+        static inline int evictionScore(const SearchNode &node, uint16_t generation, uint8_t rootPly) {
+            if (node.key == 0) {
+                return 3 << 24;
+            }
+            if (node.ply < rootPly) {
+                return 2 << 24;
+            }
+            int age = static_cast<uint16_t>(generation - node.generation);
+            return (age << 8) + node.ply;
+        }
+    };
+
+    NodePool<SMALL_CHILDREN> smallPool;
+    NodePool<LARGE_CHILDREN> largePool;
+    uint16_t currentGeneration;
+    uint8_t rootPly;
+};
@@ -0,0 +1,94 @@
+// ZeroedPages.h
+#pragma once
+
+#include <cstddef>
+#include <new>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN // без winsock.h: иначе конфликт с winsock2.h клиента DescentPlayer
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+/**
+ * @brief Обнулённая память под большие таблицы: анонимные страницы системы.
+ *
+ * Система отдаёт нулевые страницы при первом обращении, поэтому выделение не трогает память,
+ * а резидентной становится только то, куда таблица действительно писала.
+ * Начало выровнено по странице (а значит, и по кэш-линии).
+ */
+class ZeroedPages {
+public:
+    ZeroedPages() = default;
+
+    ZeroedPages(const ZeroedPages &) = delete;
+
+    ZeroedPages &operator=(const ZeroedPages &) = delete;
+
+    ~ZeroedPages() {
+        release();
+    }
+
+    /**
+     * @brief Выделяет bytes обнулённых байт (прежняя память освобождается).
+     * @throws std::bad_alloc, если система не дала память
+     */
+    void allocate(std::size_t bytes) {
+        release();
+#if defined(_WIN32)
+        void *pages = VirtualAlloc(nullptr, bytes, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+        if (pages == nullptr) {
+            throw std::bad_alloc();
+        }
+#else
+        void *pages = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (pages == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+#endif
+        memory = pages;
+        length = bytes;
+    }
+
+    /**
+     * @brief Снова все нули: страницы возвращаются системе и выделяются заново
+     *        (дешевле, чем записывать нули, и RSS падает до нуля).
+     */
+    void zero() {
+        if (memory != nullptr) {
+            const std::size_t bytes = length;
+            allocate(bytes);
+        }
+    }
+
+    void release() {
+        if (memory == nullptr) {
+            return;
+        }
+#if defined(_WIN32)
+        VirtualFree(memory, 0, MEM_RELEASE);
+#else
+        munmap(memory, length);
+#endif
+        memory = nullptr;
+        length = 0;
+    }
+
+    inline void *data() const {
+        return memory;
+    }
+
+    inline std::size_t size() const {
+        return length;
+    }
+
+private:
+    void *memory = nullptr;
+    std::size_t length = 0;
+};
@@ -1,6 +1,5 @@
 #include <iostream>
 #include "parameters.h"
-#include "boards/precalculated/precalculated_small_boards.h"
 #include "client/ClientMain.h"
 
 /**
@@ -21,13 +20,11 @@ std::tuple<int, std::string, float> parseArguments(int argc, char *argv[]) {
 
 int main(int argc, char *argv[]) {
     srand(params::SEED);
-    precalculateSmallBoardsArray();
 
     auto [port, archPath, timePerMove] = parseArguments(argc, argv);
     if (port == -1) return 1;
 
     ClientMain client(port, archPath, timePerMove);
     client.mainLoop();
-    precalcBoardsFreeMem();
     return 0;
 }
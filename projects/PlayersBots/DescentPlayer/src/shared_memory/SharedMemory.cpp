@@ -4,6 +4,7 @@
 #include <pybind11/embed.h>  // для py::scoped_interpreter
 #include <cstring>           // memset
 #include <iostream>
+#include <utility>
 
 
 // -----------------------------------------------------
@@ -17,41 +18,52 @@ py::module_ SharedMemory::moduleCppBindings_;
 // Конструктор
 // -----------------------------------------------------
 SharedMemory::SharedMemory(std::size_t paramSampleLength, std::string python_scripts_path)
-    : sampleLength(paramSampleLength) {
-    // 1) Инициализируем Python (однократно)
-    ensurePythonInitialized();
-
-    // 2) Регистрируем класс SharedMemory (однократно)
-    ensureClassRegistered();
+    : sampleLength(paramSampleLength)
+      , pythonScriptsPath(std::move(python_scripts_path)) {
+    // Python здесь не запускается: с blob-файлом весов (useNativeBlob) он не нужен вовсе — см. ensureScript()
 
-    // 3) Выделяем память под наши массивы
+    // 1) Выделяем память под наши массивы
     sampleMainChannels = new uint8_t[sampleLength * 9 * 9 * 6];
     sampleMacroChannels = new uint8_t[sampleLength * 3 * 3 * 2];
     sampleValues = new float[sampleLength];
     intVars = new int[intVarsCount];
     floatVars = new float[floatVarsCount];
 
-    // 4) Обнулим всё для наглядности
+    // 2) Обнулим всё для наглядности
     std::memset(sampleMainChannels, 0, sampleLength * 9 * 9 * 6 * sizeof(uint8_t));
     std::memset(sampleMacroChannels, 0, sampleLength * 3 * 3 * 2 * sizeof(uint8_t));
     std::memset(sampleValues, 0, sampleLength * sizeof(float));
     std::memset(intVars, 0, intVarsCount * sizeof(int));
     std::memset(floatVars, 0, floatVarsCount * sizeof(float));
+}
+
+// -----------------------------------------------------
+// ensureScript(): Python, класс и shared_memory_script — при первом обращении
+// -----------------------------------------------------
+void SharedMemory::ensureScript() {
+    if (shared_memory_script_) {
+        return;
+    }
+    // 1) Инициализируем Python (однократно)
+    ensurePythonInitialized();
+
+    // 2) Регистрируем класс SharedMemory (однократно)
+    ensureClassRegistered();
 
-    // 5) Импортируем Python-скрипт
+    // 3) Импортируем Python-скрипт
     {
         py::module_ sys = py::module_::import("sys");
         // Пример для Windows: подставьте нужные пути
         sys.attr("path").attr("append")(std::string(python_config::PYTHON_PATH) + ".venv\\Lib\\site-packages");
-        sys.attr("path").attr("append")(std::string(python_scripts_path));
+        sys.attr("path").attr("append")(pythonScriptsPath);
 
         shared_memory_script_ = py::module_::import("shared_memory_script");
     }
 
-    // 6) Вызываем init_arrays(self), чтобы Python сохранил ссылки на массивы
+    // 4) Вызываем init_arrays(self), чтобы Python сохранил ссылки на массивы
     shared_memory_script_.attr("init_arrays")(py::cast(this));
 
-    // 7) Сохраняем ссылки на функции Do, Evaluate, Learn
+    // 5) Сохраняем ссылки на функции Do, Evaluate, Learn
     do_func_ = shared_memory_script_.attr("Do");
     evaluate_func_ = shared_memory_script_.attr("Evaluate");
     learn_func_ = shared_memory_script_.attr("Learn");
@@ -0,0 +1,238 @@
+// negamax_benchmark.cpp
+//
+// Замер алгоритма NegamaxAgent на фиксированной глубине: узлы в секунду при копировании доски на каждый узел
+// (как в агенте) против ходов на месте с откатом (applyMove + undoMove ниже, список ходов узла в его массиве).
+//
+// Оба варианта — один шаблон с тем же итеративно-углубляемым αβ-негамаксом и сортировкой корневых ходов,
+// поэтому число узлов, лучший ход и оценка обязаны совпасть с самим агентом.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include "big_board/BigBoard.h"
+#include "boards/precalculated/precalculated_small_boards.h"
+#include "selfplay/NegamaxAgent.h"
+#include "selfplay/evaluate/BigBoardsEvaluator.h"
+
+namespace {
+    constexpr int POSITIONS = 40;
+    constexpr int DEPTH = 9;
+    constexpr int ROUNDS = 5;
+    constexpr long INF = 1'000'000'000L;
+
+    /**
+     * Различие состояния, которое меняет ход: слово малой доски хода, bigState1, bigState2 и hashKey.
+     * Откат только для замера — у BigBoard его нет, агент копирует доску на каждый узел.
+     */
+    struct MoveUndo {
+        uint64_t board;
+        uint64_t bigState1;
+        uint64_t bigState2;
+        uint64_t hashKey;
+        uint8_t boardIndex;
+    };
+
+    inline void applyMove(BigBoard *board, uint8_t move, MoveUndo &undo) {
+        undo.boardIndex = (move >> move::pos::boardIndex) & move::mask::boardIndex;
+        undo.board = board->boardsArray[undo.boardIndex];
+        undo.bigState1 = board->bigState1;
+        undo.bigState2 = board->bigState2;
+        undo.hashKey = board->hashKey;
+        board->applyMove(move);
+    }
+
+    /// Кеш getValidMoves() доски остаётся сброшенным после applyMove — список построится заново
+    inline void undoMove(BigBoard *board, const MoveUndo &undo) {
+        board->boardsArray[undo.boardIndex] = undo.board;
+        board->bigState1 = undo.bigState1;
+        board->bigState2 = undo.bigState2;
+        board->hashKey = undo.hashKey;
+    }
+
+    /**
+     * Алгоритм NegamaxAgent (проверка таймаута — как в агенте); IN_PLACE — ходы на месте
+     * (applyMove/undoMove выше, список ходов узла в его массиве), иначе копия доски на каждый узел.
+     * Оба варианта — один шаблон, чтобы разница в замере шла только от способа хода.
+     */
+    template<bool IN_PLACE>
+    struct BenchNegamax {
+        long nodes = 0;
+        long bestScore = 0;
+        int nodesSinceLastTimeCheck = 0;
+        bool timeout = false;
+        std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now() + std::chrono::hours(1);
+
+        bool checkTimeout() {
+            if (timeout) return true;
+            if (++nodesSinceLastTimeCheck >= 128) {
+                nodesSinceLastTimeCheck = 0;
+                timeout = std::chrono::steady_clock::now() >= end;
+            }
+            return timeout;
+        }
+
+        uint8_t search(BigBoard *board, int maxDepth) {
+            struct MoveScore {
+                uint8_t move;
+                long score;
+            };
+            uint8_t *rootMovesArr = board->getValidMoves();
+            std::vector<MoveScore> rootMoves;
+            for (int i = 0; i < rootMovesArr[0]; ++i)
+                rootMoves.push_back({rootMovesArr[i + 1], 0L});
+
+            nodes = 0;
+            uint8_t bestOverall = 0;
+            for (int depth = 1; depth <= maxDepth; ++depth) {
+                if (depth > 1)
+                    std::sort(rootMoves.begin(), rootMoves.end(),
+                              [](auto &a, auto &b) {
+                                  return a.score > b.score;
+                              });
+                long alpha = -INF, beta = INF;
+                long bestScoreDepth = -INF;
+                uint8_t bestMoveDepth = 0;
+                for (auto &ms: rootMoves) {
+                    long score = -child(board, ms.move, depth - 1, -beta, -alpha);
+                    ms.score = score;
+                    if (score > bestScoreDepth) {
+                        bestScoreDepth = score;
+                        bestMoveDepth = ms.move;
+                    }
+                    alpha = std::max(alpha, score);
+                }
+                bestScore = bestScoreDepth;
+                bestOverall = bestMoveDepth;
+            }
+            return bestOverall;
+        }
+
+        inline long child(BigBoard *board, uint8_t move, int depth, long alpha, long beta) {
+            if constexpr (IN_PLACE) {
+                MoveUndo undo;
+                applyMove(board, move, undo);
+                long score = alphaBeta(board, depth, alpha, beta);
+                undoMove(board, undo);
+                return score;
+            } else {
+                BigBoard childBoard = *board;
+                childBoard.applyMove(move);
+                return alphaBeta(&childBoard, depth, alpha, beta);
+            }
+        }
+
+        long alphaBeta(BigBoard *board, int depth, long alpha, long beta) {
+            if (checkTimeout())
+                return 0;
+            ++nodes;
+            if (depth == 0 || board->isGameOver()) {
+                long v = BigBoardsEvaluator::evaluate(*board);
+                return (board->getCurrentPlayer() == cell::X) ? v : -v;
+            }
+            // На месте список ходов копируется в свой массив: потомки ходят на той же доске и затирают movesArray
+            uint8_t ownMoves[IN_PLACE ? bigBoardArrays::movesSize + 1 : 1];
+            uint8_t *movesArr = board->getValidMoves();
+            if constexpr (IN_PLACE) {
+                std::memcpy(ownMoves, movesArr, movesArr[0] + 1);
+                movesArr = ownMoves;
+            }
+            int movesCount = movesArr[0];
+            for (int i = 1; i <= movesCount; ++i) {
+                long score = -child(board, movesArr[i], depth - 1, -beta, -alpha);
+                if (timeout) return 0;
+                if (score >= beta)
+                    return score;
+                alpha = std::max(alpha, score);
+            }
+            return alpha;
+        }
+    };
+
+    /// Результат NegamaxAgent на позиции — эталон для обоих вариантов
+    struct AgentResult {
+        uint8_t move;
+        long score;
+        long nodes;
+    };
+
+    /// Секунды на все позиции; mismatches — расхождения с NegamaxAgent (ход, оценка, узлы, доска после поиска)
+    template<bool IN_PLACE>
+    double timeSearches(std::vector<BigBoard> &positions, const std::vector<AgentResult> &expected, long &mismatches) {
+        double seconds = 0;
+        for (size_t i = 0; i < positions.size(); ++i) {
+            BigBoard &position = positions[i];
+            BenchNegamax<IN_PLACE> search;
+            const uint64_t keyBefore = position.hashKey;
+            auto start = std::chrono::steady_clock::now();
+            uint8_t move = search.search(&position, DEPTH);
+            seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            long score = (position.getCurrentPlayer() == cell::X) ? -search.bestScore : search.bestScore;
+            mismatches += move != expected[i].move || search.nodes != expected[i].nodes ||
+                    score != expected[i].score || position.hashKey != keyBefore;
+        }
+        return seconds;
+    }
+
+    /// Позиции после случайного числа случайных ходов (дебют и середина партии)
+    std::vector<BigBoard> collectPositions() {
+        std::vector<BigBoard> positions;
+        srand(12345);
+        while (positions.size() < POSITIONS) {
+            BigBoard board;
+            int plies = rand() % 30;
+            for (int i = 0; i < plies && !board.isGameOver(); ++i) {
+                uint8_t *moves = board.getValidMoves();
+                board.applyMove(moves[1 + rand() % moves[0]]);
+            }
+            if (!board.isGameOver()) {
+                positions.push_back(board);
+            }
+        }
+        return positions;
+    }
+}
+
+int main() {
+    std::vector<BigBoard> positions = collectPositions();
+
+    // Эталон — сам агент (копия доски на узел)
+    std::vector<AgentResult> expected;
+    long nodesPerRound = 0;
+    for (BigBoard &position: positions) {
+        NegamaxAgent agent;
+        uint8_t move = agent.search(&position, 1e9, DEPTH);
+        expected.push_back({move, agent.bestScore(&position), agent.nodesSearched()});
+        nodesPerRound += agent.nodesSearched();
+    }
+
+    // Несколько раундов, порядок вариантов чередуется; берётся медиана раундов каждого (меньше шума)
+    long mismatches = 0;
+    std::vector<double> copySec, inPlaceSec;
+    for (int round = 0; round < ROUNDS; ++round) {
+        if (round % 2 == 0) {
+            copySec.push_back(timeSearches<false>(positions, expected, mismatches));
+            inPlaceSec.push_back(timeSearches<true>(positions, expected, mismatches));
+        } else {
+            inPlaceSec.push_back(timeSearches<true>(positions, expected, mismatches));
+            copySec.push_back(timeSearches<false>(positions, expected, mismatches));
+        }
+    }
+    std::sort(copySec.begin(), copySec.end());
+    std::sort(inPlaceSec.begin(), inPlaceSec.end());
+    const double copyMedian = copySec[ROUNDS / 2];
+    const double inPlaceMedian = inPlaceSec[ROUNDS / 2];
+
+    std::cout << "positions: " << positions.size() << ", depth " << DEPTH << ", mismatches: " << mismatches << std::endl;
+    std::cout << "nodes per round: " << nodesPerRound << std::endl;
+    std::cout << "copy per node : " << nodesPerRound / copyMedian / 1e6 << " M nodes/s" << std::endl;
+    std::cout << "apply/undo    : " << nodesPerRound / inPlaceMedian / 1e6 << " M nodes/s" << std::endl;
+    std::cout << "apply/undo vs copy: " << copyMedian / inPlaceMedian << "x (median of " << ROUNDS << " rounds)"
+            << std::endl;
+
+    return mismatches == 0 ? 0 : 1;
+}
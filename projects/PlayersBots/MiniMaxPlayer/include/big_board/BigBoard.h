@@ -4,6 +4,7 @@
 #include <cstring>
 #include "bits/constants/bit_constants.h"
 #include "big_board/big_board_get_set_do.h"
+#include "big_board/zobrist_keys.h"
 #include "boards/precalculated/precalculated_small_boards.h"
 
 class BigBoard {
@@ -14,18 +15,22 @@ public:
     uint64_t &bigState2;
 
 private:
-    alignas(64) uint8_t movesArray[bigBoardArrays::movesSize + 1];
+    alignas(64) uint8_t movesArray[bigBoardArrays::movesBufferSize];
+    bool movesValid; ///< movesArray odpowiada bieżącej pozycji (zerowane przy każdej zmianie planszy)
 
-    inline void updateHashKey() {
-        uint64_t hash = 0xcbf29ce484222325;
-        constexpr uint64_t prime = 0x100000001b3;
-
-        for (int i = 0; i < bigBoardArrays::size - 1; ++i) {
-            hash ^= boardsArray[i];
-            hash *= prime;
-        }
+    /**
+     * @brief Klucz Zobrist aktywnej planszy: jedna wskazana plansza albo swobodny wybór (lub koniec gry).
+     */
+    inline uint64_t activeBoardKey() const {
+        return activeBoardKey(BigBoardGet::validBoards(bigState2) & move::mask::boardIndex);
+    }
 
-        hashKey = hash;
+    /**
+     * @param singleBoardIndex Indeks planszy, jeśli wiadomo, że to ona byłaby jedyną aktywną.
+     */
+    inline uint64_t activeBoardKey(uint64_t singleBoardIndex) const {
+        bool single = BigBoardGet::validBoardsCount(bigState2) == 1;
+        return zobrist::keys.activeBoard[single ? singleBoardIndex : zobrist::ANY_BOARD];
     }
 
     /**
@@ -161,19 +166,22 @@ private:
         uint8_t *bytePos = movesArray + 1; // na pozycji 0 będzie liczba akcji
 
         for (int i = 0; i < validBoardsCount; ++i) {
-            int boardIndex = (validBoardsEncoded >> (i << 2)) & move::mask::boardIndex;
-
+            uint64_t boardIndex = (validBoardsEncoded >> (i << 2)) & move::mask::boardIndex;
             uint64_t board = boardsArray[boardIndex];
-            int freeCount = boardGet::freeCount(board);
-            uint64_t freeCells = boardGet::freeCells(board);
-
-            for (int j = 0; j < freeCount; ++j) {
-                int cellIndex = (freeCells >> (j << 2)) & move::mask::cellIndex;
-                uint8_t move = (boardIndex << move::pos::boardIndex) |
-                               (cellIndex << move::pos::cellIndex);
 
-                *(bytePos++) = move;
-            }
+            // Indeksy wolnych komórek z tablicy (16 bajtów naraz) + indeks planszy w każdym bajcie.
+            // Zapis wychodzi poza ostatni ruch planszy - stąd zapas w movesBufferSize.
+            const uint8_t *cells = freeCellsByMask[~boardGet::OXpartsMeged(board) & rights::_9_BITS];
+            const uint64_t boardBytes = (boardIndex << move::pos::boardIndex) * 0x0101010101010101ULL;
+            uint64_t low, high;
+            std::memcpy(&low, cells, sizeof(low));
+            std::memcpy(&high, cells + sizeof(low), sizeof(high));
+            low |= boardBytes;
+            high |= boardBytes;
+            std::memcpy(bytePos, &low, sizeof(low));
+            std::memcpy(bytePos + sizeof(low), &high, sizeof(high));
+
+            bytePos += boardGet::freeCount(board);
         }
         int movesCount = (bytePos - (movesArray + 1));
         movesArray[0] = movesCount;
@@ -205,6 +213,7 @@ public:
           bigState2(boardsArray[bigBoardArrays::bigState2Pos]),
           hashKey(boardsArray[bigBoardArrays::hashKeyPos]) {
         std::memcpy(this->boardsArray, other.boardsArray, sizeof(this->boardsArray));
+        movesValid = false; // movesArray nie jest kopiowana
     }
 
     BigBoard &operator=(const BigBoard &) = delete;
@@ -271,11 +280,36 @@ public:
      * Zeruje tablicę stanów małych plansz i aktualizuje ich informacje.
      */
     void stateInit() {
+        movesValid = false;
         std::memset(boardsArray, 0, sizeof(boardsArray));
         updateAllBoardsInfo();
         BigBoardSet::validBoardsCount(bigState2, 9);
         BigBoardSet::validBoards(bigState2, 0x876543210);
-        updateHashKey();
+        hashKey = computeHashKey();
+    }
+
+    /**
+     * @brief Oblicza klucz Zobrist od zera (przy inicjalizacji i do weryfikacji).
+     *
+     * W applyMove klucz jest aktualizowany przyrostowo i zawsze równa się wynikowi tej metody.
+     */
+    uint64_t computeHashKey() const {
+        uint64_t hash = 0;
+        for (int boardIndex = 0; boardIndex < 9; ++boardIndex) {
+            uint64_t board = boardsArray[boardIndex];
+            for (int cellIndex = 0; cellIndex < 9; ++cellIndex) {
+                if ((board >> (board::pos::X_part + cellIndex)) & rights::_1_BIT) {
+                    hash ^= zobrist::keys.cells[boardIndex][cellIndex][cell::X];
+                }
+                if ((board >> (board::pos::O_part + cellIndex)) & rights::_1_BIT) {
+                    hash ^= zobrist::keys.cells[boardIndex][cellIndex][cell::O];
+                }
+            }
+        }
+        if (getCurrentPlayer() == cell::O) {
+            hash ^= zobrist::keys.playerO;
+        }
+        return hash ^ activeBoardKey();
     }
 
     /**
@@ -287,18 +321,24 @@ public:
      * @param move Zakodowany ruch: 4 bity na indeks komórki, 4 bita na indeks planszy.
      */
     inline void applyMove(uint8_t move) {
+        movesValid = false;
         int moveBoardIndex = (move >> move::pos::boardIndex) & move::mask::boardIndex;
         int moveCellIndex = (move >> move::pos::cellIndex) & move::mask::cellIndex;
 
+        uint64_t player = BigBoardGet::player(bigState2);
         uint64_t &targetBoard = boardsArray[moveBoardIndex];
-        uint64_t cellMask = rights::_1_BIT << (moveCellIndex + BigBoardGet::player(bigState2) * board::pos::O_part);
+        uint64_t cellMask = rights::_1_BIT << (moveCellIndex + player * board::pos::O_part);
         targetBoard |= cellMask; // apply the move
 
+        // jeśli przed ruchem aktywna była jedna plansza, to właśnie plansza tego ruchu
+        uint64_t oldActiveBoardKey = activeBoardKey(moveBoardIndex);
         updateBoardInfo(moveBoardIndex);
         settingValidBoards(moveCellIndex);
 
         BigBoardDo::invertPlayer(bigState2);
-        updateHashKey();
+        // przyrostowa aktualizacja klucza Zobrist: figura, strona do ruchu, aktywna plansza
+        hashKey ^= zobrist::keys.cells[moveBoardIndex][moveCellIndex][player] ^ zobrist::keys.playerO ^
+                oldActiveBoardKey ^ activeBoardKey();
     }
 
     /**
@@ -325,12 +365,16 @@ public:
      * - Na pozycji 0 znajduje się liczba dostępnych ruchów.
      * - Na kolejnych pozycjach znajdują się kody ruchów.
      *
-     * Dane pozostają ważne do następnej zmiany stanu planszy.
+     * Dane pozostają ważne do następnej zmiany stanu planszy; do tego czasu kolejne wywołania
+     * zwracają gotową tablicę bez ponownego generowania.
      *
      * @return Wskaźnik na tablicę z dostępnymi ruchami.
      */
     inline uint8_t *getValidMoves() {
-        fillMovesArray();
+        if (!movesValid) {
+            fillMovesArray();
+            movesValid = true;
+        }
         return movesArray;
     }
 };
@@ -1,17 +1,151 @@
 // precalculated_small_boards.h
 #pragma once
 
+#include <bit>
 #include <cstdint>
 #include "boards/fields_functions/small_board_access.h"
 
 
+/**
+ * Информация о малых досках (состояние, свободные клетки) для каждой расстановки X|O.
+ *
+ * По умолчанию индекс — сырой 18-битный код X|O: 2^18 слов = 2 МБ, из которых легальных
+ * расстановок только 3^9. С SMALL_BOARDS_COMPACT индекс — номер расстановки в троичной записи
+ * (клетка: 0 — пусто, 1 — X, 2 — O): 3^9 слов = 154 КБ, помещается в L2.
+ * В компактном варианте слово не хранит X|O (getBoardInfo подставляет их из запроса),
+ * а биты BOARD_INFO_PAYLOAD свободны под данные пользователя (оценка доски в MiniMaxPlayer).
+ *
+ * Все таблицы строятся на этапе компиляции (как ключи Zobrist) и лежат в секции только для чтения:
+ * запуск процесса их не заполняет, а страницы исполняемого файла общие для всех запущенных копий.
+ */
+#ifdef SMALL_BOARDS_COMPACT
+constexpr int TOTAL_BOARDS = 19683; // 3^9
+constexpr uint64_t BOARD_INFO_PAYLOAD = board::mask::OX_parts;
+#else
 constexpr int TOTAL_BOARDS = 262144;
-alignas(64) inline uint64_t *boardsInfoArray = new uint64_t[TOTAL_BOARDS];
-alignas(64) inline int *zerosCountedArray = new int[512];
+#endif
+
+namespace smallBoards {
+    constexpr uint16_t WIN_MASKS[8] = {
+            0b000000111, // Horizontal 1
+            0b000111000, // Horizontal 2
+            0b111000000, // Horizontal 3
+            0b001001001, // Vertical 1
+            0b010010010, // Vertical 2
+            0b100100100, // Vertical 3
+            0b100010001, // Diagonal 1
+            0b001010100  // Diagonal 2
+    };
+
+    /// Таблицы по 9-битной маске клеток — маленькие, поэтому видны компилятору в каждой единице трансляции
+    struct MaskTables {
+        int zerosCount[512]; ///< Число пустых клеток при маске занятых
+        /**
+         * Индексы свободных клеток для каждой маски свободных клеток (по возрастанию),
+         * дополненные нулями до 16 байт — BigBoard::fillMovesArray копирует их одним блоком.
+         */
+        uint8_t freeCells[512][16];
+        uint16_t binaryToTernary[512]; ///< Значение маски в троичной записи: сумма 3^i по установленным битам i
+    };
+
+    constexpr MaskTables generateMaskTables() {
+        MaskTables tables{};
+        for (uint16_t mask = 0; mask < 512; ++mask) {
+            tables.zerosCount[mask] = 9 - std::popcount(mask);
+            int count = 0;
+            uint16_t ternary = 0;
+            uint16_t power = 1;
+            for (uint8_t cellIndex = 0; cellIndex < 9; ++cellIndex) {
+                if (mask & (1 << cellIndex)) {
+                    tables.freeCells[mask][count++] = cellIndex;
+                    ternary += power;
+                }
+                power *= 3;
+            }
+            tables.binaryToTernary[mask] = ternary;
+        }
+        return tables;
+    }
+
+    alignas(64) inline constexpr MaskTables maskTables = generateMaskTables();
+
+    /**
+     * @return слово малой доски с расстановкой code (X|O, состояние, свободные клетки),
+     *         0 — для невозможных расстановок (общие клетки или выигрыш обоих игроков)
+     */
+    constexpr uint64_t computeBoardInfo(uint64_t code) {
+        uint64_t X_mask = boardGet::Xpart(code);
+        uint64_t O_mask = boardGet::Opart(code);
+        if (X_mask & O_mask) {
+            return 0;
+        }
+        bool x_wins = false;
+        bool o_wins = false;
+        for (uint16_t mask: WIN_MASKS) {
+            x_wins |= (X_mask & mask) == mask;
+            o_wins |= (O_mask & mask) == mask;
+        }
+        if (x_wins && o_wins) {
+            return 0;
+        }
+
+        uint64_t combined_mask = X_mask | O_mask;
+        uint64_t boardState;
+        if (x_wins) {
+            boardState = stateCode::X_WINS;
+        } else if (o_wins) {
+            boardState = stateCode::O_WINS;
+        } else if (combined_mask == rights::_9_BITS) {
+            boardState = stateCode::DRAW;
+        } else {
+            boardState = stateCode::ONGOING;
+        }
+
+        uint64_t free_cells = 0;
+        uint64_t free_count = 0;
+        if (boardState == stateCode::ONGOING) {
+            for (uint64_t pos = 0; pos < 9; ++pos) {
+                if ((combined_mask & (rights::_1_BIT << pos)) == 0) {
+                    free_cells |= (pos << (free_count * 4));
+                    ++free_count;
+                }
+            }
+        }
+        return (X_mask << board::pos::X_part) | (O_mask << board::pos::O_part) |
+               (boardState << board::pos::STATE) | (free_count << board::pos::FREE_COUNT) |
+               (free_cells << board::pos::FREE_CELLS);
+    }
+
+    struct alignas(64) BoardsInfoTable {
+        uint64_t info[TOTAL_BOARDS];
+    };
+
+    /// Строится один раз на программу — в precalculated_small_boards.cpp
+    extern const BoardsInfoTable boardsInfoTable;
+}
+
+inline constexpr const uint64_t (&boardsInfoArray)[TOTAL_BOARDS] = smallBoards::boardsInfoTable.info;
+inline constexpr const int (&zerosCountedArray)[512] = smallBoards::maskTables.zerosCount;
+inline constexpr const uint8_t (&freeCellsByMask)[512][16] = smallBoards::maskTables.freeCells;
+#ifdef SMALL_BOARDS_COMPACT
+inline constexpr const uint16_t (&binaryToTernary)[512] = smallBoards::maskTables.binaryToTernary;
+#endif
+
+/**
+ * @return индекс расстановки X|O доски board в boardsInfoArray
+ */
+constexpr uint32_t boardsInfoIndex(uint64_t board) noexcept {
+#ifdef SMALL_BOARDS_COMPACT
+    return binaryToTernary[boardGet::Xpart(board)] + 2 * binaryToTernary[boardGet::Opart(board)];
+#else
+    return static_cast<uint32_t>(boardGet::code(board));
+#endif
+}
 
 inline uint64_t getBoardInfo(uint64_t board) noexcept {
+#ifdef SMALL_BOARDS_COMPACT
+    return (boardsInfoArray[boardsInfoIndex(board)] & ~BOARD_INFO_PAYLOAD) | boardGet::code(board);
+#else
     return boardsInfoArray[boardGet::code(board)];
+#endif
 }
-
-void precalculateSmallBoardsArray(); // Функция инициализации массива
-void precalcBoardsFreeMem();
@@ -19,8 +19,13 @@ public:
           bestOverall_(0) {
     }
 
-    /** Поиск лучшего хода за не более timeLimitSec секунд. */
-    uint8_t search(BigBoard *board, double timeLimitSec) {
+    /**
+     * Поиск лучшего хода за не более timeLimitSec секунд.
+     * Каждый узел — своя копия доски: ходы на месте с откатом на глубине 9 выигрыша не дали
+     * (0.84–1.01x, benchmarks/negamax_benchmark.cpp).
+     * maxDepth — ограничение глубины итеративного углубления (для замеров на фиксированной глубине).
+     */
+    uint8_t search(BigBoard *board, double timeLimitSec, int maxDepth = MAX_DEPTH) {
         if (board->isGameOver())
             return 0;
 
@@ -42,12 +47,13 @@ public:
         bestOverall_ = 0;
         timeout_ = false;
         nodesSinceLastTimeCheck_ = 0;
+        nodesSearched_ = 0;
         end_ = std::chrono::steady_clock::now()
                + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
                    std::chrono::duration<double>(timeLimitSec)
                );
         /* ---- итеративное углубление ---- */
-        for (int depth = 1; depth <= MAX_DEPTH; ++depth) {
+        for (int depth = 1; depth <= maxDepth; ++depth) {
             if (depth > 1)
                 std::sort(rootMoves.begin(), rootMoves.end(),
                           [](auto &a, auto &b) {
@@ -92,11 +98,17 @@ public:
         return (board->getCurrentPlayer() == cell::X) ? -bestScore_ : bestScore_;
     }
 
+    /** Число узлов alphaBeta за последний search(). */
+    long nodesSearched() const {
+        return nodesSearched_;
+    }
+
 private:
     /* ---------- рекурсивный αβ-негамакс ---------- */
     long alphaBeta(BigBoard *board, int depth, long alpha, long beta) {
         if (checkTimeout())
             return 0;
+        ++nodesSearched_;
 
         if (depth == 0 || board->isGameOver())
             return evaluate(board);
@@ -149,5 +161,6 @@ private:
     bool timeout_;
     std::chrono::steady_clock::time_point end_;
     int nodesSinceLastTimeCheck_ = 0;
+    long nodesSearched_ = 0;
     static constexpr int CHECK_PERIOD = 128;
 };
@@ -1,25 +1,117 @@
 // SmallBoardsEvaluator.h
 // ───────────────────────────────────────────────────── SmallBoardsEvaluator.h
 #pragma once
+#include <bit>
 #include <cstdint>
 #include "boards/precalculated/precalculated_small_boards.h" // boardsInfoArray, boardGet
 
 class SmallBoardsEvaluator {
 public:
-    /// Вызывается один раз после precalculateSmallBoardsArray()
-    static void precalculate();
-
     /// O(1) доступ к оценке (X-перспектива, >0 лучше X)
     static inline int getBoardEvaluation(uint64_t boardBits) {
-        return evalArray[ boardGet::code(boardBits) ];
+#ifdef SMALL_BOARDS_COMPACT
+        return static_cast<int16_t>(boardsInfoArray[boardsInfoIndex(boardBits)] & EVAL_MASK);
+#else
+        return evalTable.values[ boardGet::code(boardBits) ];
+#endif
     }
 
-    /// Освободить память (опционально)
-    static void freeMemory();
+    /**
+     * Оценка расстановки X|O по слову доски (smallBoards::computeBoardInfo).
+     * Вызывается только на этапе компиляции — при построении таблицы оценок.
+     */
+    static constexpr int16_t evaluateBoard(uint64_t info) {
+        uint64_t Xmask = (info >> board::pos::X_part) & board::mask::X_part;
+        uint64_t Omask = (info >> board::pos::O_part) & board::mask::O_part;
+        uint64_t state = (info >> board::pos::STATE) & board::mask::STATE;
+
+        // --- 0) нелегальные позиции ---
+        if (state == 0) {
+            return 0;
+        }
+
+        // --- 1) терминальные позиции ---
+        if (state == stateCode::X_WINS) {
+            return WIN_VAL;
+        }
+        if (state == stateCode::O_WINS) {
+            return -WIN_VAL;
+        }
+        if (state == stateCode::DRAW) {
+            return 0;
+        }
+
+        // --- 2) open-линиии ---
+        int open2X = 0, open1X = 0, open2O = 0, open1O = 0;
+        for (uint16_t m: LINES) {
+            int nX = std::popcount(static_cast<uint16_t>(Xmask & m));
+            int nO = std::popcount(static_cast<uint16_t>(Omask & m));
+            if (nO == 0) {
+                if (nX == 2) ++open2X;
+                else if (nX == 1) ++open1X;
+            }
+            if (nX == 0) {
+                if (nO == 2) ++open2O;
+                else if (nO == 1) ++open1O;
+            }
+        }
+
+        // --- 3) forks (ячейка в ≥2 open2-линии) ---
+        int forksX = 0, forksO = 0;
+        uint16_t empty = static_cast<uint16_t>(~(Xmask | Omask)) & rights::_9_BITS;
+        for (int c = 0; c < 9; ++c) {
+            if ((empty & (1u << c)) == 0) continue;
+            int cntX = 0, cntO = 0;
+            for (int li = 0; li < 5 && CELL_LINES[c][li] != 0xFF; ++li) {
+                uint16_t m = LINES[CELL_LINES[c][li]];
+                if ((m & Omask) == 0 && std::popcount(Xmask & m) == 2) ++cntX;
+                if ((m & Xmask) == 0 && std::popcount(Omask & m) == 2) ++cntO;
+            }
+            if (cntX >= 2) ++forksX;
+            if (cntO >= 2) ++forksO;
+        }
+
+        // --- 4) позиционные фичи ---
+        int centerX = (Xmask >> 4) & 1;
+        int centerO = (Omask >> 4) & 1;
+        int cornersX = std::popcount(static_cast<uint16_t>(Xmask & 0b100010001));
+        int cornersO = std::popcount(static_cast<uint16_t>(Omask & 0b100010001));
+        int edgesX = std::popcount(static_cast<uint16_t>(Xmask & 0b010101010));
+        int edgesO = std::popcount(static_cast<uint16_t>(Omask & 0b010101010));
+
+        // --- 5) тактический и позиционный дифференциалы ---
+        int tactDiff = W_FORKS * (forksX - forksO)
+                       + W_OPEN2 * (open2X - open2O)
+                       + W_OPEN1 * (open1X - open1O);
+
+        int posDiff = W_CENTER * (centerX - centerO)
+                      + W_CORNER * (cornersX - cornersO)
+                      + W_EDGE * (edgesX - edgesO);
+
+        // --- 6) фазовый коэффициент для позиционной части ---
+        double freeCount = double((info >> board::pos::FREE_COUNT) & board::mask::FREE_COUNT);
+        double stage = freeCount / 9.0; // 1.0…0.0
+        double posK = stage * stage;
+
+        double score = tactDiff + posK * posDiff;
+        return static_cast<int16_t>(score < 0 ? score - 0.5 : score + 0.5); // std::round (не constexpr в C++20)
+    }
 
 private:
-    static constexpr int TOTAL = TOTAL_BOARDS;    // 262 144
-    static inline int16_t* evalArray = nullptr;    // 2 B × TOTAL = 512 KB
+#ifdef SMALL_BOARDS_COMPACT
+    // оценка лежит в младших 16 битах слова boardsInfoArray (BOARD_INFO_PAYLOAD) — отдельной таблицы нет,
+    // её записывает туда генератор таблицы в precalculated_small_boards.cpp
+    static constexpr uint64_t EVAL_MASK = rights::_16_BITS;
+    static_assert((EVAL_MASK & ~BOARD_INFO_PAYLOAD) == 0, "Evaluation must fit into the board info payload bits");
+#else
+    struct alignas(64) EvalTable {
+        int16_t values[TOTAL_BOARDS]; // 2 B × 262 144 = 512 KB
+    };
+
+    static constexpr EvalTable generateEvalTable();
+
+    static const EvalTable evalTable; // строится на этапе компиляции в SmallBoardsEvaluator.cpp
+#endif
 
     // ----- веса из Python-эталона -----
     static constexpr int WIN_VAL  = 1000;
@@ -2,9 +2,7 @@
 #include <iostream>
 #include <random>
 
-#include "boards/precalculated/precalculated_small_boards.h"
 #include "client/ClientMain.h"
-#include "selfplay/evaluate/SmallBoardsEvaluator.h"
 
 /**
  * @brief Парсит аргументы командной строки и возвращает пару (port, timePerMove).
@@ -23,8 +21,6 @@ static std::pair<int, float> parseArguments(int argc, char *argv[]) {
 int main(int argc, char *argv[]) {
     std::srand(std::random_device{}());
 
-    precalculateSmallBoardsArray();
-    SmallBoardsEvaluator::precalculate();
     // парсим порт и лимит времени
     auto [port, timePerMove] = parseArguments(argc, argv);
     if (port < 0 || timePerMove <= 0.0f) {
@@ -33,8 +29,5 @@ int main(int argc, char *argv[]) {
 
     ClientMain client(port, timePerMove);
     client.mainLoop();
-
-    precalcBoardsFreeMem();
-    SmallBoardsEvaluator::freeMemory();
     return 0;
 }